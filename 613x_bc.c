@@ -39,15 +39,11 @@
 #include "613x_initialization.h"
 #include "613x_regs.h"
 #include "613x_bc.h"
+#include "613x_irq.h"
 #include "board_613x.h"
 #include "board_6131.h"
 #include "device_6131.h"
 
-// HI-6131 SPI slave select pin
-static const Pin pinNss[]  = {BOARD_6131_NPCS_PIN};
-
-
-
 //------------------------------------------------------------------------------
 //         Functions
 //------------------------------------------------------------------------------
@@ -55,38 +51,43 @@ static const Pin pinNss[]  = {BOARD_6131_NPCS_PIN};
 // instead, they demonstrate alternative addressing methods...
 
 
+// BC Instruction List, one row per instruction: label, instruction. Op code 
+// words are built with validation field and parity by the compiler.
+#define BC_SCHEDULE(ROW) \
+    ROW(TOP,   BC_WTG(ALWAYS))                         /* wait for ext trigger, addr = BC_ILIST_BASE_ADDR */ \
+    ROW(MSG1,  BC_XEQ(ALWAYS, MSG_BLK1_ADDR))          /* 1 */                     \
+    ROW(WAIT2, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(MSG2,  BC_XEQ(ALWAYS, MSG_BLK2_ADDR))          /* 2 */                     \
+    ROW(WAIT3, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(MSG3,  BC_XEQ(ALWAYS, MSG_BLK3_ADDR))          /* 3 */                     \
+    ROW(WAIT4, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(MSG4,  BC_XEQ(ALWAYS, MSG_BLK4_ADDR))          /* 4 */                     \
+    ROW(WAIT5, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(MSG5,  BC_XEQ(ALWAYS, MSG_BLK5_ADDR))          /* 5 */                     \
+    ROW(WAIT6, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(MSG6,  BC_XEQ(ALWAYS, MSG_BLK6_ADDR))          /* 6 */                     \
+    ROW(WAIT7, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(MSG7,  BC_XEQ(ALWAYS, MSG_BLK7_ADDR))          /* 7 */                     \
+    ROW(WAIT8, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(MSG8,  BC_XEQ(ALWAYS, MSG_BLK8_ADDR))          /* 8 */                     \
+    ROW(WAIT9, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(RTRT1, BC_XEQ(ALWAYS, RTRT_MSG_BLK1_ADDR))     /* RT-RT 1 */               \
+    ROW(WAITA, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(RTRT2, BC_XEQ(ALWAYS, RTRT_MSG_BLK2_ADDR))     /* RT-RT 2 */               \
+    ROW(WAITB, BC_WTG(ALWAYS))                         /* wait for ext trigger */  \
+    ROW(MSG2B, BC_XEQ(ALWAYS, MSG_BLK2_ADDR))          /* 2 */                     \
+    ROW(LOOP,  BC_JMP(ALWAYS, TOP))                    /* loop to top */
+
+
 void initialize_bc_instruction_list(void) {
   
-	unsigned short i, j, len;
-        AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-        unsigned short dummy, k;
-        volatile unsigned char bufferTX[4];
-
-	unsigned short inst_list[46] = {
-	// test op codes WTG,XEQ,JMP, verify various msg block setups
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger, addr = BC_ILIST_BASE_ADDR = 0x1B70 
-	XEQ|ALWAYS, MSG_BLK1_ADDR,		// 1
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, MSG_BLK2_ADDR,		// 2
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, MSG_BLK3_ADDR,		// 3
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, MSG_BLK4_ADDR,		// 4
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, MSG_BLK5_ADDR,		// 5
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, MSG_BLK6_ADDR,		// 6
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, MSG_BLK7_ADDR,		// 7
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, MSG_BLK8_ADDR,		// 8 
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, RTRT_MSG_BLK1_ADDR,		// RT-RT 1
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, RTRT_MSG_BLK2_ADDR,		// RT-RT 2
-	WTG|ALWAYS, 0x0000,			// wait for ext trigger
-	XEQ|ALWAYS, MSG_BLK2_ADDR,		// 2
-	JMP|ALWAYS, BC_ILIST_BASE_ADDR };	// loop to top 
+	// instruction numbers for branch targets, then the list itself in flash
+	enum { BC_SCHEDULE(BC_ILIST_LABEL) BC_ILIST_INSTS };
+	static const unsigned short inst_list[] = { BC_SCHEDULE(BC_ILIST_WORDS) };
+
+	// instruction list array size, 16-bit words. Must fit the allocated space
+	unsigned short len = sizeof(inst_list) / sizeof(short int);
+	(void)BC_CHECK(sizeof(inst_list) / sizeof(short int) <= BC_ILIST_SIZE);
 
         
         // copy BC Instruction List (above) to RAM...
@@ -96,75 +97,11 @@ void initialize_bc_instruction_list(void) {
             Write_6131LowReg(BC_INST_LIST_BASE_ADDR_REG, BC_ILIST_BASE_ADDR, 1);
             
             // copy the BC Instruction List (declared above) into the HI-6130 RAM,
-            // starting at the address just written into the base address register
-            
-            // enable Memory Address Pointer 1
-            enaMAP(1);
-               
-            //  initialize the list start address into MAP1
-            Write_6131LowReg(MAP_1, BC_ILIST_BASE_ADDR, 1);
-    
-            // instruction list array size, 16-bit words
-            len = sizeof(inst_list) / sizeof(short int);
-    
-            __disable_interrupt();
-            // Assert SPI chip select
-            PIO_Clear(pinNss); 
-            // Wait for TDR and shifter = empty
-            while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-            // Send SPI write op code 0xC0 
-            spi->SPI_TDR = 0xC0 | SPI_PCS(BOARD_6131_NPCS);
-            // Wait for TDRE flag (Tx Data Register Empty)
-            while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-            // Wait for RDRF flag (Rx Data Register Full)
-            while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-            // Read and discard received data char in Rx buffer
-            dummy = spi->SPI_RDR & 0xFFFF;
-            // prevent warning: variable dummy was set but never used
-            dummy = dummy;
-            
-            // write instruction list
-            for ( i = 0; i < len; i += 2) {
-    
-                // add the validation field and odd parity bit,
-                // and write the adjusted op code word. 
-                j = inst_list[i];
-                // the next 4 lines determine odd parity 			
-                j ^= j>>8;
-                j ^= j>>4;
-                j &= 0xF;
-                if (!((0x6996 >> j) & 1))  { 
-                    // add validation field and parity bit 15 = 1
-                    j = inst_list[i] + VP1;
-                }
-                else {
-                    // add validation field and parity bit 15 = 0
-                    j = inst_list[i] + VP0;
-                }
-                // upper and lower op code word bytes
-                bufferTX[0] = (char)(j >> 8);          
-                bufferTX[1] = (char)j;               
-                // upper and lower parameter word bytes
-                bufferTX[2] = (char)(inst_list[i+1] >> 8);          
-                bufferTX[3] = (char)(inst_list[i+1]); 
-    
-                // transmit the 4 bytes
-                for (k = 0; k < 4; k++) {
-                    // Wait for TDR and shifter = empty
-                    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-                    // transmit next byte
-                    spi->SPI_TDR = bufferTX[k] | SPI_PCS(BOARD_6131_NPCS);
-                    // Wait for TDRE flag (Tx Data Register Empty)
-                    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-                    // Wait for RDRF flag (Rx Data Register Full)
-                    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-                    // Read and discard received data char in Rx buffer
-                    dummy = spi->SPI_RDR & 0xFFFF;
-                }  
-            }
-            // negate slave chip select
-            PIO_Set(pinNss);
-            __enable_interrupt();	        
+            // starting at the address just written into the base address register,
+            // as one block: validation fields and parity bits are already in place
+            Write_6131_Block(BC_ILIST_BASE_ADDR, inst_list, len, 0, 1);
+            // keep its CRCs for the read-back check after initialization
+            Record_6131_Image(BC_ILIST_BASE_ADDR, inst_list, len, 0);
         
 }	// end initialize_bc_instruction_list()
 
@@ -193,6 +130,7 @@ void initialize_bc_msg_blocks(void) {
 			      0x1717,0x1818,0x1919,0x2020,0x2121,0x2222,0x2323,0x2424,
 			      0x2525,0x2626,0x2727,0x2828,0x2929,0x3030,0x3131,0x3232};
 	//unsigned short data[32] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+	unsigned short rev_data[32];
 
 
         // ********************************************************************************
@@ -388,87 +326,53 @@ void initialize_bc_msg_blocks(void) {
 
 	// ********************************************************************************
 
-		// copy the BC Message Control / Status Blocks (declared above) into HI-6131 RAM
-                
-                // enable Memory Address Pointer 1
-                enaMAP(1);
-           
-        	//  initialize the list start address into MAP1
-	        Write_6131LowReg(MAP_1, MSG_BLK1_ADDR, 1);	
-
+		// copy the BC Message Control / Status Blocks (declared above) into HI-6131 RAM.
 		// these message blocks are contiguous, stored back-to-back.
-		// take advantage of Mem Addr Pointer auto-increment after each write 
-
 
 		// these non-RT-RT blocks need 8 words, must start with low nibble = 0x0 or 0x8 
-		for ( i = 0; i < 8; i++) {
-			Write_6131_1word(msg_block1[i],0); // starts at 0x3E00
-		}
-
-		for ( i = 0; i < 8; i++) {
-			Write_6131_1word(msg_block2[i],0); // starts at 0x3E08
-		}
-
-		for ( i = 0; i < 8; i++) {
-			Write_6131_1word(msg_block3[i],0); // starts at 0x3E10
-		}
-
-		for ( i = 0; i < 8; i++) {
-			Write_6131_1word(msg_block4[i],0); // starts at 0x3E18
-		}
-
-		for ( i = 0; i < 8; i++) {
-			Write_6131_1word(msg_block5[i],0); // starts at 0x3E20
-		}
-
-		for ( i = 0; i < 8; i++) {
-			Write_6131_1word(msg_block6[i],0); // starts at 0x3E28
-		}
-
-		for ( i = 0; i < 8; i++) {
-			Write_6131_1word(msg_block7[i],0); // starts at 0x3E30
-		}
-
-		for ( i = 0; i < 8; i++) {
-			Write_6131_1word(msg_block8[i],0); // starts at 0x3E38
-		}
+		Write_6131_Block(MSG_BLK1_ADDR,      msg_block1, 8, 0, 1); // starts at 0x3E00
+		Write_6131_Block(MSG_BLK2_ADDR,      msg_block2, 8, 0, 1); // starts at 0x3E08
+		Write_6131_Block(MSG_BLK3_ADDR,      msg_block3, 8, 0, 1); // starts at 0x3E10
+		Write_6131_Block(MSG_BLK4_ADDR,      msg_block4, 8, 0, 1); // starts at 0x3E18
+		Write_6131_Block(MSG_BLK5_ADDR,      msg_block5, 8, 0, 1); // starts at 0x3E20
+		Write_6131_Block(MSG_BLK6_ADDR,      msg_block6, 8, 0, 1); // starts at 0x3E28
+		Write_6131_Block(MSG_BLK7_ADDR,      msg_block7, 8, 0, 1); // starts at 0x3E30
+		Write_6131_Block(MSG_BLK8_ADDR,      msg_block8, 8, 0, 1); // starts at 0x3E38
 
 		// these RT-RT blocks need 16 words, must start with low nibble = 0x0 
-		for ( i = 0; i < 16; i++) {
-			Write_6131_1word(rtrt_msg_block1[i],0); // starts at 0x3E40
-		}
-
-		for ( i = 0; i < 16; i++) {
-			Write_6131_1word(rtrt_msg_block2[i],0); // starts at 0x3E50
-		}
+		Write_6131_Block(RTRT_MSG_BLK1_ADDR, rtrt_msg_block1, 16, 0, 1); // starts at 0x3E40
+		Write_6131_Block(RTRT_MSG_BLK2_ADDR, rtrt_msg_block2, 16, 0, 1); // starts at 0x3E50
+
+		// keep their CRCs for the read-back check after initialization
+		Record_6131_Image(MSG_BLK1_ADDR,      msg_block1, 8, 0);
+		Record_6131_Image(MSG_BLK2_ADDR,      msg_block2, 8, 0);
+		Record_6131_Image(MSG_BLK3_ADDR,      msg_block3, 8, 0);
+		Record_6131_Image(MSG_BLK4_ADDR,      msg_block4, 8, 0);
+		Record_6131_Image(MSG_BLK5_ADDR,      msg_block5, 8, 0);
+		Record_6131_Image(MSG_BLK6_ADDR,      msg_block6, 8, 0);
+		Record_6131_Image(MSG_BLK7_ADDR,      msg_block7, 8, 0);
+		Record_6131_Image(MSG_BLK8_ADDR,      msg_block8, 8, 0);
+		Record_6131_Image(RTRT_MSG_BLK1_ADDR, rtrt_msg_block1, 16, 0);
+		Record_6131_Image(RTRT_MSG_BLK2_ADDR, rtrt_msg_block2, 16, 0);
 
 		// write dummy data into the transmit data buffers for the 3 receive subaddress commands 
                 // REMEMBER: For Receive commands (that is RT receives), the BC IS TRANSMITTING...
 
 		// a 32-word buffer for rx msg block 3
-		Write_6131LowReg(MAP_1, msg_block3[2], 0);	
-		for ( i = 0; i < 32; i++) {	
-			Write_6131_1word(data[i], 1);
-		}
+		Write_6131_Block(msg_block3[2], data, 32, 0, 1);
 
 		// a 32-word buffer for rx msg block 4 
-		Write_6131LowReg(MAP_1, msg_block4[2], 0);	
-		for ( i = 0; i < 32; i++) {	
-			Write_6131_1word(data[i], 1);
-		}
+		Write_6131_Block(msg_block4[2], data, 32, 0, 1);
 
-		// a 32-word buffer for rx msg block 5
-		Write_6131LowReg(MAP_1, msg_block5[2], 0);	
+		// a 32-word buffer for rx msg block 5, data in reverse order
 		for ( i = 0; i < 32; i++) {	
-			Write_6131_1word(data[31-i], 1);
+			rev_data[i] = data[31-i];
 		}
+		Write_6131_Block(msg_block5[2], rev_data, 32, 0, 1);
 
-		// 16 mode data words for Rx MC16-MC31 starting at offset = 0x1B50 
-		Write_6131LowReg(MAP_1, 0x1B50, 1);	
-		for ( i = 1; i < 17; i++) {	
-			// writes 0x1616 for Rx MC16 thru 0x3131 for Rx MC31
-			Write_6131_1word(data[i+15],1);
-		}
+		// 16 mode data words for Rx MC16-MC31 starting at offset = 0x1B50,
+		// writes 0x1616 for Rx MC16 thru 0x3131 for Rx MC31
+		Write_6131_Block(0x1B50, &data[16], 16, 0, 1);
                 
 	///#endif	// end SPI 
 
@@ -484,7 +388,7 @@ void bc_disable(void) {
 	
         // read-modify-write Master Config register
 
-        unsigned short j = Read_6131LowReg(MASTER_CONFIG_REG, 1) & ~BCENA;
+        unsigned short j = Read_6131_MasterConfig(1) & ~BCENA;
         Write_6131LowReg(MASTER_CONFIG_REG, j, 1);
 
 }
@@ -503,7 +407,7 @@ void bc_enable(void) {
 	if(PIO_Get(&pinBCENA)) {
           
             // read-modify-write Master Config register
-            unsigned short j = Read_6131LowReg(MASTER_CONFIG_REG, 1) | BCENA;
+            unsigned short j = Read_6131_MasterConfig(1) | BCENA;
             Write_6131LowReg(MASTER_CONFIG_REG, j, 1);
 	}
 }	// return enabled but not started 
@@ -522,7 +426,7 @@ void bc_start(void) {
           
             // read-modify-write Master Config register
 
-            unsigned short j = Read_6131LowReg(MASTER_CONFIG_REG, 1) | BCENA | BCSTRT ;
+            unsigned short j = Read_6131_MasterConfig(1) | BCENA | BCSTRT ;
             Write_6131LowReg(MASTER_CONFIG_REG, j, 1);
 	}
 }	// return enabled and started 
@@ -658,6 +562,634 @@ void initialize_613x_BC(void) {
 
 
 
+//================================================================================================
+//	BC Rate Group Scheduler
+//================================================================================================
+
+// message blocks, then the instruction list, are built here and written in one block each
+static unsigned short sched_buf[BC_SCHED_BUF_WORDS];
+
+
+// Local function returns the bus time booked for one message, microseconds: 20us
+// per command, status and data word, one RT response time per status word, plus
+// the intermessage gap.
+//
+static unsigned short bc_msg_us(const BC_SCHED_MSG *msg) {
+
+	unsigned short n, words, resp;
+
+	// data words: word count field, 0 = 32. Mode codes 16-31 have one data word
+	n = msg->command & 0x001F;
+	if(msg->control & MCODE) n = (n & 0x0010) ? 1 : 0;
+	else if(n == 0) n = 32;
+
+	if(msg->control & RT_RT) {
+		// two commands, transmit RT status, data, receive RT status
+		words = n + 4;
+		resp = 2;
+	}
+	else {
+		// command, data, status
+		words = n + 2;
+		resp = 1;
+	}
+	// no receive RT status for broadcast
+	if(msg->control & BCST) {
+		words--;
+		resp--;
+	}
+	return (words * BC_WORD_US) + (resp * BC_SCHED_RESP_US) + BC_SCHED_GAP_US;
+}
+
+
+// This function builds a rate group schedule: every message gets a block at 
+// sched->msg_addr (8 words, 16 for RT-to-RT), its Time to Next Message word set 
+// to its bus time, and the instruction list at sched->ilist_addr runs them from 
+// the frame timer. Messages with phase BC_SCHED_AUTO go in the phase whose minor
+// frames carry the least load so far, after all fixed-phase messages. 
+//
+// The BC Instruction List Base Address register is written; the BC runs the
+// schedule once enabled and started, see bc_start( ). Both RAM areas are 
+// recorded for Verify_6131_Images( ). Must be called before the BC is enabled.
+//
+// Returns 'F' without writing RAM for a bad parameter, a list or message area
+// larger than BC_SCHED_BUF_WORDS, or a minor frame booked beyond minor_us. 
+// The load fields are filled in either way, except for a bad parameter.
+//
+unsigned char Build_BC_Schedule(BC_SCHED *sched) {
+
+	const BC_SCHED_MSG *msg;
+	unsigned short addr[BC_SCHED_MAX_MSGS];
+	unsigned short us[BC_SCHED_MAX_MSGS];
+	unsigned short n, i, load, best_load;
+	unsigned char m, f, p, best, pass;
+	unsigned char result = 'P';
+
+	if((sched == 0) || (sched->msgs == 0)) return ('F');
+	if((sched->num_msgs == 0) || (sched->num_msgs > BC_SCHED_MAX_MSGS)) return ('F');
+	if((sched->minor_frames == 0) || (sched->minor_frames > BC_SCHED_MAX_FRAMES)) return ('F');
+	if((sched->minor_us < BC_FRAME_TICK_US) || (sched->minor_us % BC_FRAME_TICK_US)) return ('F');
+	if((sched->ilist_addr & 0x0001) || (sched->msg_addr & 0x000F)) return ('F');
+	for(m = 0; m < sched->num_msgs; m++) {
+		msg = &sched->msgs[m];
+		if((msg->period == 0) || (sched->minor_frames % msg->period)) return ('F');
+		if((msg->phase >= msg->period) && (msg->phase != BC_SCHED_AUTO)) return ('F');
+	}
+
+	// book each message's bus time in its minor frames, fixed phases first
+	for(f = 0; f < sched->minor_frames; f++) sched->frame_us[f] = 0;
+	for(pass = 0; pass < 2; pass++) {
+		for(m = 0; m < sched->num_msgs; m++) {
+			msg = &sched->msgs[m];
+			if((msg->phase == BC_SCHED_AUTO) != (pass == 1)) continue;
+			us[m] = bc_msg_us(msg);
+
+			best = msg->phase;
+			if(best == BC_SCHED_AUTO) {
+				// least loaded phase, ties go to the earliest
+				best_load = 0xFFFF;
+				for(p = 0; p < msg->period; p++) {
+					for(load = 0, f = p; f < sched->minor_frames; f += msg->period) {
+						if(sched->frame_us[f] > load) load = sched->frame_us[f];
+					}
+					if(load < best_load) {
+						best_load = load;
+						best = p;
+					}
+				}
+			}
+			sched->phase[m] = best;
+			for(f = best; f < sched->minor_frames; f += msg->period) sched->frame_us[f] += us[m];
+		}
+	}
+	sched->peak_us = 0;
+	for(f = 0; f < sched->minor_frames; f++) {
+		if(sched->frame_us[f] > sched->peak_us) sched->peak_us = sched->frame_us[f];
+	}
+	if(sched->peak_us > sched->minor_us) result = 'F';
+
+	// message blocks: RT-to-RT blocks are 16 words on a 16-word boundary
+	for(n = 0, m = 0; m < sched->num_msgs; m++) {
+		if(sched->msgs[m].control & RT_RT) n = (n + 15) & ~15;
+		addr[m] = n;
+		n += (sched->msgs[m].control & RT_RT) ? 16 : 8;
+	}
+	sched->msg_words = n;
+
+	// instruction list: LFT, then per minor frame SFT, XEQ's, WFT, then JMP
+	n = 2 + (4 * sched->minor_frames) + 2;
+	for(m = 0; m < sched->num_msgs; m++) n += 2 * (sched->minor_frames / sched->msgs[m].period);
+	sched->ilist_words = n;
+
+	if((sched->msg_words > BC_SCHED_BUF_WORDS) || (sched->ilist_words > BC_SCHED_BUF_WORDS)) result = 'F';
+	if(((unsigned long)sched->msg_addr + sched->msg_words > 0x8000) ||
+	   ((unsigned long)sched->ilist_addr + sched->ilist_words > 0x8000)) result = 'F';
+	if(result != 'P') return result;
+
+	for(i = 0; i < sched->msg_words; i++) sched_buf[i] = 0;
+	for(m = 0; m < sched->num_msgs; m++) {
+		msg = &sched->msgs[m];
+		i = addr[m];
+		addr[m] += sched->msg_addr;
+		sched_buf[i + 0] = msg->control;
+		sched_buf[i + 1] = msg->command;
+		sched_buf[i + 2] = msg->data_addr;
+		sched_buf[i + 3] = (us[m] + BC_TTNM_TICK_US - 1) / BC_TTNM_TICK_US;
+		if(msg->control & RT_RT) sched_buf[i + 8] = msg->tx_command;
+	}
+	Write_6131_Block(sched->msg_addr, sched_buf, sched->msg_words, 0, 1);
+	Record_6131_Image(sched->msg_addr, sched_buf, sched->msg_words, 0);
+
+	i = 0;
+	sched_buf[i++] = BC_OPWORD(LFT, ALWAYS);
+	sched_buf[i++] = sched->minor_us / BC_FRAME_TICK_US;
+	for(f = 0; f < sched->minor_frames; f++) {
+		sched_buf[i++] = BC_OPWORD(SFT, ALWAYS);
+		sched_buf[i++] = 0x0000;
+		for(m = 0; m < sched->num_msgs; m++) {
+			if((f % sched->msgs[m].period) != sched->phase[m]) continue;
+			sched_buf[i++] = BC_OPWORD(XEQ, ALWAYS);
+			sched_buf[i++] = addr[m];
+		}
+		sched_buf[i++] = BC_OPWORD(WFT, ALWAYS);
+		sched_buf[i++] = 0x0000;
+	}
+	// back to the first minor frame's SFT
+	sched_buf[i++] = BC_OPWORD(JMP, ALWAYS);
+	sched_buf[i++] = sched->ilist_addr + 2;
+
+	Write_6131LowReg(BC_INST_LIST_BASE_ADDR_REG, sched->ilist_addr, 1);
+	Write_6131_Block(sched->ilist_addr, sched_buf, sched->ilist_words, 0, 1);
+	Record_6131_Image(sched->ilist_addr, sched_buf, sched->ilist_words, 0);
+
+	return ('P');
+}
+
+
+
+// Demo rate group schedule: 20ms minor frame, 80ms major frame. Data buffers are
+// the ones initialize_bc_msg_blocks( ) fills. Returns Build_BC_Schedule( ) result.
+//
+//	50Hz    Subaddress Tx  Command 03-1-30-00 (loopback subaddress) Bus A
+//	50Hz    Subaddress Rx  Command 03-0-30-00 (loopback subaddress) Bus A
+//	25Hz    Subaddress Tx  Command 03-1-30-00                       Bus B
+//	12.5Hz  Mode Code  Tx  Command 03-1-31-02 (tx mode code 2)      Bus B
+//	12.5Hz  RT-RT msg Commands 04-0-30-02 03-1-01-02                Bus A
+//
+unsigned char initialize_bc_schedule(void) {
+
+	static const BC_SCHED_MSG msgs[5] = {
+	//  Control Word               Command Word            RT-RT Tx Command      Data    Period Phase
+	{ RTRYENA|MEMASK|USEBUSA,      3<<11 | TX | 30<<5 | 0,  0,                    0x5308, 1, 0 },
+	{ MEMASK|MSKBCR|USEBUSA,       3<<11 | RX | 30<<5 | 0,  0,                    0x5328, 1, 0 },
+	{ RTRYENA|MEMASK|USEBUSB,      3<<11 | TX | 30<<5 | 0,  0,                    0x5308, 2, BC_SCHED_AUTO },
+	{ MEMASK|MSKBCR|MCODE|USEBUSB, 3<<11 | TX | 31<<5 | 2,  0,                    0x0000, 4, BC_SCHED_AUTO },
+	{ MEMASK|MSKBCR|RT_RT|USEBUSA, 4<<11 | RX | 30<<5 | 2,  3<<11 | TX | 1<<5 | 2, 0x5388, 4, BC_SCHED_AUTO }};
+	static BC_SCHED sched;
+
+	sched.msgs = msgs;
+	sched.num_msgs = 5;
+	sched.minor_frames = 4;
+	sched.minor_us = 20000;
+	sched.ilist_addr = BC_SCHED_ILIST_ADDR;
+	sched.msg_addr = BC_SCHED_MSG_ADDR;
+
+	return Build_BC_Schedule(&sched);
+}
+
+
+
+//================================================================================================
+//	BC Data Double Buffering
+//================================================================================================
+
+// Local function waits until the BC is not processing the message block at
+// msg_addr. Returns 'F' after BC_DBUF_WAIT polls.
+//
+static unsigned char bc_dbuf_wait(unsigned short msg_addr) {
+
+	unsigned short n;
+
+	for(n = 0; n < BC_DBUF_WAIT; n++) {
+		if(!(READ_6131_REG(STATUS_AND_RESET_REG, 1) & BCMIP)) return ('P');
+		if(READ_6131_REG(BC_LAST_MSG_BLOCK_ADDR_REG, 1) != msg_addr) return ('P');
+	}
+	return ('F');
+}
+
+
+// This function sets up double buffering for the BC message block at msg_addr.
+// The buffer its Data Addr word points to now becomes buffer 0, the active one,
+// and its data is copied to alt_buffer so both buffers start out the same.
+// May be called while the BC runs.
+//
+//	param	dbuf        caller structure, kept for Update_BC_Data_Buffer( )
+//	param	msg_addr    BC message block address
+//	param	alt_buffer  second data buffer address, not overlapping the first
+//	param	words       data words per buffer, 1 to 32
+//
+// Returns 'P', or 'F' for a bad parameter.
+//
+unsigned char Init_BC_Data_Buffer(BC_DBUF *dbuf, unsigned short msg_addr, unsigned short alt_buffer, unsigned short words) {
+
+	unsigned short data[32];
+	unsigned short first;
+
+	if((dbuf == 0) || (words == 0) || (words > 32)) return ('F');
+	if(((unsigned long)msg_addr + 8 > 0x8000) || ((unsigned long)alt_buffer + words > 0x8000)) return ('F');
+
+	first = Read_6131_Reg(msg_addr + 2, 1);
+	if(((unsigned long)first + words > 0x8000) ||
+	   ((first < alt_buffer + words) && (alt_buffer < first + words))) return ('F');
+
+	dbuf->msg_addr = msg_addr;
+	dbuf->buffer[0] = first;
+	dbuf->buffer[1] = alt_buffer;
+	dbuf->words = words;
+	dbuf->active = 0;
+
+	if(Read_6131_Burst(first, data, words, 0, 1) != 'P') return ('F');
+	return Write_6131_Burst(alt_buffer, data, words, 0, 1);
+}
+
+
+// This function replaces the data a double-buffered BC message sends, without
+// stopping the BC. The words are written to the inactive buffer in one DMA
+// burst, then a single write of the message block's Data Addr word makes it
+// the active buffer. Call once per frame or less, e.g. from the BC end of
+// message callback, so the wait for a message in progress is short.
+//
+//	param	dbuf    set up by Init_BC_Data_Buffer( )
+//	param	data    dbuf->words new data words
+//
+// Returns 'P', or 'F' if the BC stayed busy on the message or the burst
+// failed. On 'F' the active buffer is unchanged.
+//
+unsigned char Update_BC_Data_Buffer(BC_DBUF *dbuf, unsigned short *data) {
+
+	unsigned char next;
+
+	if((dbuf == 0) || (data == 0)) return ('F');
+	next = dbuf->active ^ 1;
+
+	// a message started before the last flip may still be sending from buffer[next]
+	if(bc_dbuf_wait(dbuf->msg_addr) != 'P') return ('F');
+	if(Write_6131_Burst(dbuf->buffer[next], data, dbuf->words, 0, 1) != 'P') return ('F');
+
+	// the BC reads Data Addr once, at message start
+	Write_6131_Reg(dbuf->msg_addr + 2, dbuf->buffer[next], 1);
+	dbuf->active = next;
+
+	return ('P');
+}
+
+
+
+//================================================================================================
+//	BC Result Harvesting
+//================================================================================================
+
+// harvest list and latest results, in Start_BC_Harvest( ) order
+static BC_RESULT harvest[BC_HARVEST_MAX];
+// control-status block words read per message, 8, or 10 for RT-to-RT
+static unsigned char harvest_len[BC_HARVEST_MAX];
+// non-zero when the message was logged since it was last harvested
+static unsigned char harvest_due[BC_HARVEST_MAX];
+static unsigned char harvest_count;
+// BC Pending Interrupt bits 8-5 that end a frame, 0 to harvest every message
+static unsigned short harvest_irq;
+// non-zero between Start_BC_Harvest( ) and Stop_BC_Harvest( )
+static unsigned char harvest_on;
+
+// IRQ_BC interrupt log handler shared with the GP queue consumer, see below
+static unsigned char bc_ilog_update(void);
+
+
+// Local function returns the data words a message receives from the bus:
+// transmit commands, RT-to-RT, and transmit mode codes 16-31. Receive
+// command data was written by the host and is not harvested.
+//
+static unsigned short bc_rx_words(unsigned short control, unsigned short command) {
+
+	unsigned short n = command & 0x001F;
+	unsigned short sa = command & 0x03E0;
+
+	if((sa == 0) || (sa == 0x03E0)) {
+		// mode code
+		return ((command & (TX)) && (n & 0x0010)) ? 1 : 0;
+	}
+	if(!(control & RT_RT) && !(command & (TX))) return 0;
+	return n ? n : 32;
+}
+
+
+// Local function called by the IRQ_BC interrupt log handler while harvesting:
+// end of message entries mark their block, the frame end IRQ op code
+// harvests the marked blocks.
+//
+static void harvest_ilog(unsigned short iiw, unsigned short iaw) {
+
+	unsigned char i;
+
+	if(iiw & ((BCEOM) | (SELMSG))) {
+		for(i = 0; i < harvest_count; i++) {
+			if(harvest[i].msg_addr == iaw) harvest_due[i] = 1;
+		}
+	}
+	if((harvest_irq == 0) || (iiw & harvest_irq)) Harvest_BC_Results(0);
+}
+
+
+// This function starts harvesting BC message results into MCU RAM. Each block's
+// Control Word is read now to size its control-status block, so write the
+// message blocks first. Results are cleared. The IRQ_BC interrupt log handler
+// is replaced; Configure_6131_IRQ( ) must have been called.
+//
+//	param	msg_addr    message block addresses
+//	param	count       number of blocks, 1 to BC_HARVEST_MAX
+//	param	irq_bits    BC Pending Interrupt bits 8-5 set by the frame end IRQ
+//	                    op code, or 0 to harvest each message when logged
+//
+// Returns 'P', or 'F' for a bad parameter.
+//
+unsigned char Start_BC_Harvest(const unsigned short *msg_addr, unsigned char count, unsigned short irq_bits) {
+
+	static const BC_RESULT empty = { 0 };
+	unsigned char i;
+
+	if((msg_addr == 0) || (count == 0) || (count > BC_HARVEST_MAX)) return ('F');
+	if(irq_bits & ~(BCIRQMASK)) return ('F');
+
+	harvest_on = 0;
+	for(i = 0; i < count; i++) {
+		harvest[i] = empty;
+		harvest[i].msg_addr = msg_addr[i];
+		harvest_len[i] = (Read_6131_Reg(msg_addr[i], 1) & RT_RT) ? 10 : 8;
+		harvest_due[i] = 0;
+	}
+	harvest_count = count;
+	harvest_irq = irq_bits;
+	harvest_on = 1;
+
+	return bc_ilog_update();
+}
+
+
+// This function stops harvesting. The IRQ_BC interrupt log handler is removed
+// unless the GP queue consumer runs. Results already harvested stay readable.
+//
+void Stop_BC_Harvest(void) {
+
+	unsigned char i;
+
+	harvest_on = 0;
+	bc_ilog_update();
+	for(i = 0; i < harvest_count; i++) harvest_due[i] = 0;
+}
+
+
+// This function reads message results now: the control-status block, then the
+// received data, one DMA burst each. Called by the log handler at frame end;
+// call directly to harvest without an IRQ op code, e.g. after a WFT-timed
+// frame or with the BC stopped. Must not be called from an interrupt.
+//
+//	param	all   non-zero reads every block in the list, zero only the blocks
+//	              logged since they were last harvested
+//
+// Returns the number of blocks harvested. A block whose burst could not start
+// stays due for the next call.
+//
+unsigned char Harvest_BC_Results(unsigned char all) {
+
+	unsigned short blk[10];
+	unsigned short n_words;
+	unsigned char i, n = 0;
+	BC_RESULT *r;
+
+	for(i = 0; i < harvest_count; i++) {
+		if(!all && !harvest_due[i]) continue;
+		r = &harvest[i];
+		if(Read_6131_Burst(r->msg_addr, blk, harvest_len[i], 0, 1) != 'P') continue;
+		n_words = bc_rx_words(blk[0], blk[1]);
+		// status and data are updated together, or not at all
+		if(n_words && (Read_6131_Burst(blk[2], r->data, n_words, 0, 1) != 'P')) continue;
+
+		r->control = blk[0];
+		r->command = blk[1];
+		r->time_tag = blk[4];
+		r->block_status = blk[5];
+		r->loopback = blk[6];
+		r->rt_status = blk[7];
+		r->tx_command = (harvest_len[i] > 8) ? blk[8] : 0;
+		r->rx_status = (harvest_len[i] > 8) ? blk[9] : 0;
+		r->words = n_words;
+		r->count++;
+		harvest_due[i] = 0;
+		n++;
+	}
+	return n;
+}
+
+
+// This function returns the latest harvested results for the message block at
+// msg_addr, or null if the block is not in the harvest list. count is 0 until
+// the block is first harvested.
+//
+const BC_RESULT *Get_BC_Result(unsigned short msg_addr) {
+
+	unsigned char i;
+
+	for(i = 0; i < harvest_count; i++) {
+		if(harvest[i].msg_addr == msg_addr) return &harvest[i];
+	}
+	return 0;
+}
+
+
+
+//================================================================================================
+//	BC General Purpose Queue Consumer
+//================================================================================================
+
+// push pattern, and the position of the next word read in it
+static unsigned short gpq_pattern[BC_GPQ_MAX_PATTERN];
+static unsigned char gpq_count;
+static unsigned char gpq_phase;
+// queue address of the next word to read, 0 until Start_BC_GPQ( )
+static unsigned short gpq_next;
+// latest PTT and PTH words
+static unsigned short gpq_time, gpq_time_high;
+// decoded records. gpq_head is written by Drain_BC_GPQ( ), gpq_tail by
+// Read_BC_GPQ_Record( ); empty when equal, one slot is left unused when full.
+static BC_GPQ_RECORD gpq_ring[BC_GPQ_RECORDS];
+static unsigned short gpq_head, gpq_tail;
+// queue words overwritten before they were read, and records dropped because
+// the ring was full
+static unsigned short gpq_lost;
+static unsigned short gpq_buf[BC_GPQ_WORDS];
+// BCGPQ rollovers logged, less the queue wraps Drain_BC_GPQ( ) has seen. Below
+// zero while the log entry of a wrap already seen is still to be handled.
+static signed short gpq_rolls;
+
+
+// Local interrupt log handler for IRQ_BC, installed while results are
+// harvested or the GP queue consumer runs. A BCGPQ rollover drains the queue
+// before the BC overwrites the words just pushed.
+//
+static void bc_ilog(unsigned short iiw, unsigned short iaw) {
+
+	if(gpq_next && (iiw & (BCGPQ))) {
+		gpq_rolls++;
+		Drain_BC_GPQ();
+	}
+	if(harvest_on) harvest_ilog(iiw, iaw);
+}
+
+
+// Local function installs bc_ilog( ) as the IRQ_BC interrupt log handler while
+// it has work, or removes it. Returns 'P', or 'F' if Set_6131_ILog_Handler( ) did.
+//
+static unsigned char bc_ilog_update(void) {
+
+	return Set_6131_ILog_Handler(IRQ_BC, (harvest_on || gpq_next) ? bc_ilog : 0);
+}
+
+
+// This function starts consuming the BC General Purpose Queue. Words already
+// in the queue are skipped and decoding starts at the first push of the
+// pattern, so call before the BC is started or at a pattern boundary. The
+// IRQ_BC interrupt log handler is replaced, so Configure_6131_IRQ( ) must have
+// been called, and the BCGPQ interrupt enabled as initialize_613x_BC( ) does.
+//
+//	param	pattern   op codes of the push instructions, in list order: PTT,
+//	                  PTH, PBS, PSI or PSM
+//	param	count     pattern length, 1 to BC_GPQ_MAX_PATTERN
+//
+// Returns 'P', or 'F' for a bad parameter or if the handler could not be set.
+//
+unsigned char Start_BC_GPQ(const unsigned short *pattern, unsigned char count) {
+
+	unsigned char i;
+
+	if((pattern == 0) || (count == 0) || (count > BC_GPQ_MAX_PATTERN)) return ('F');
+	for(i = 0; i < count; i++) {
+		switch(pattern[i]) {
+			case PTT:
+			case PTH:
+			case PBS:
+			case PSI:
+			case PSM:
+				gpq_pattern[i] = pattern[i];
+				break;
+			default:
+				return ('F');
+		}
+	}
+	gpq_count = count;
+	gpq_phase = 0;
+	gpq_time = gpq_time_high = 0;
+	gpq_head = gpq_tail = gpq_lost = 0;
+	gpq_rolls = 0;
+	gpq_next = READ_6131_REG(BC_GP_QUEUE_POINTER, 1);
+
+	return bc_ilog_update();
+}
+
+
+// This function reads the words the BC pushed since the last call and decodes
+// them into records. It runs from the interrupt log handler at each BCGPQ
+// rollover, so the queue is read before the BC overwrites it as long as
+// Poll_6131_IRQ( ) runs within 64 pushes of each rollover; it may also be
+// called from the main loop. Rollovers tell 64 words pushed from none. If the
+// BC got further ahead the 64 words still queued are read, the words lost are
+// counted, see Get_BC_GPQ_Lost( ), and the pattern position skips them.
+//
+// Returns the number of queue words read, 0 if none, the consumer is not
+// started, or a DMA burst owns the SPI.
+//
+unsigned short Drain_BC_GPQ(void) {
+
+	unsigned short ptr, base, start, n, words, i, op, lost = 0;
+	signed short wraps, laps;
+	BC_GPQ_RECORD *rec;
+
+	if(gpq_next == 0) return 0;
+	ptr = READ_6131_REG(BC_GP_QUEUE_POINTER, 1);
+	base = ptr & ~(BC_GPQ_WORDS - 1);
+	start = gpq_next;
+	n = (ptr - start) & (BC_GPQ_WORDS - 1);
+
+	// a pointer below the read position wrapped once; each rollover logged
+	// beyond that is a full lap of 64 words
+	wraps = ((ptr & (BC_GPQ_WORDS - 1)) < (start & (BC_GPQ_WORDS - 1))) ? 1 : 0;
+	laps = gpq_rolls - wraps;
+	if(laps < 0) laps = 0;
+	if(laps && !((n == 0) && (laps == 1))) {
+		// overrun: read the 64 words left, oldest first, and skip the rest
+		lost = n + (laps - 1) * BC_GPQ_WORDS;
+		start = ptr;
+	}
+	if(laps) n = BC_GPQ_WORDS;
+	if(n == 0) return 0;
+
+	// up to the end of the queue, then from its start
+	words = base + BC_GPQ_WORDS - start;
+	if(words > n) words = n;
+	if(Read_6131_Burst(start, gpq_buf, words, 0, 1) != 'P') return 0;
+	if(words < n) {
+		if(Read_6131_Burst(base, gpq_buf + words, n - words, 0, 1) != 'P') return 0;
+	}
+	gpq_next = ptr;
+	gpq_rolls -= wraps + laps;
+	gpq_lost += lost;
+	gpq_phase = (unsigned char)((gpq_phase + lost) % gpq_count);
+
+	for(i = 0; i < n; i++) {
+		op = gpq_pattern[gpq_phase];
+		if(++gpq_phase == gpq_count) gpq_phase = 0;
+
+		if(op == PTT) gpq_time = gpq_buf[i];
+		else if(op == PTH) gpq_time_high = gpq_buf[i];
+		else if(((gpq_head + 1) & (BC_GPQ_RECORDS - 1)) == gpq_tail) gpq_lost++;
+		else {
+			rec = &gpq_ring[gpq_head];
+			rec->op = op;
+			rec->data = gpq_buf[i];
+			rec->time_tag = gpq_time;
+			rec->time_high = gpq_time_high;
+			gpq_head = (gpq_head + 1) & (BC_GPQ_RECORDS - 1);
+		}
+	}
+	return n;
+}
+
+
+// This function removes the oldest decoded record.
+//
+//	param	record    caller structure the record is copied to
+//
+// Returns 'P', or 'F' if no record is waiting.
+//
+unsigned char Read_BC_GPQ_Record(BC_GPQ_RECORD *record) {
+
+	if((record == 0) || (gpq_tail == gpq_head)) return ('F');
+	*record = gpq_ring[gpq_tail];
+	gpq_tail = (gpq_tail + 1) & (BC_GPQ_RECORDS - 1);
+	return ('P');
+}
+
+
+// This function returns the number of queue words overwritten before they were
+// read, plus records dropped because the record ring was full, since
+// Start_BC_GPQ( ).
+//
+unsigned short Get_BC_GPQ_Lost(void) {
+
+	return gpq_lost;
+}
+
+
+
 
 // end of file 
 
@@ -162,6 +162,230 @@
                                   // starting RAM address for BC instruction list. Initialization
                                   // should copy this value into the BC Instruction List Start Addr
                                   // register 0x0033. No need to copy to pointer reg 0x0034, read-only.
+#define BC_ILIST_SIZE      0x0090 // words allocated at BC_ILIST_BASE_ADDR
+
+
+//------------------------------------------------------------------------------
+//                       BC Instruction List Assembler
+//------------------------------------------------------------------------------
+
+//      These macros build BC Instruction List words as compile-time constants, so 
+//      an instruction list is a const array in flash, written to HI-613x RAM as is.
+//      Each instruction is an op code word (op code, condition code, validation 
+//      field and odd parity bit) followed by a parameter word. A condition code 
+//      outside 0-31 or a message block address that is not an 8-word aligned RAM
+//      address stops the build with a negative bit-field width error. Condition 
+//      codes and message block addresses passed to BC_OPWORD, BC_MSG and the 
+//      BC_XEQ/BC_XQF/BC_INST instructions must be constant expressions: a 
+//      variable operand does not compile.
+//
+//      A list is written as rows of label and instruction, expanded once by 
+//      BC_ILIST_LABEL and once by BC_ILIST_WORDS, see BC_SCHEDULE in 613x_bc.c.
+//      Each label names its instruction's address for JMP and CAL, so branch
+//      targets always land on an instruction of the same list.
+
+// compile-time check inside a constant expression, adds zero. A bit-field width
+// must be a constant, so unlike an array size (a C99 VLA) a variable cond is
+// rejected too, see REG_ASSERT in board_6131.h
+#define BC_CHECK(cond)          (0 * sizeof(struct { int bc_ok : (cond) ? 1 : -1; }))
+
+// odd parity of a 16-bit constant: 1 if an odd number of bits are set
+#define BC_PAR4(n)              ((0x6996 >> ((n) & 0xF)) & 1)
+#define BC_PARITY(w)            (BC_PAR4(w) ^ BC_PAR4((w) >> 4) ^ BC_PAR4((w) >> 8) ^ BC_PAR4((w) >> 12))
+
+// op code word: VP1 sets bit 15 when op code and condition code have even parity
+#define BC_OPWORD(op, cond)     ((((op) | (cond)) | (BC_PARITY((op) | (cond)) ? VP0 : VP1)) \
+                                 + BC_CHECK(((cond) & ~0x1F) == 0))
+
+// parameter words: message block address, or the address of a labeled instruction
+#define BC_MSG(addr)            ((addr) + BC_CHECK((((addr) & 0x0007) == 0) && \
+                                 ((addr) >= 0x0050) && ((addr) <= 0x7FF8)))
+#define BC_LABEL(label)         (BC_ILIST_BASE_ADDR + 2 * (BC_L_##label))
+
+// one instruction, two words
+#define BC_INST(op, cond, param)    BC_OPWORD(op, cond), (param)
+
+#define BC_XEQ(cond, msg_addr)      BC_INST(XEQ, cond, BC_MSG(msg_addr))    // execute message
+#define BC_XQF(cond, msg_addr)      BC_INST(XQF, cond, BC_MSG(msg_addr))    // execute and flip
+#define BC_JMP(cond, label)         BC_INST(JMP, cond, BC_LABEL(label))     // jump
+#define BC_CAL(cond, label)         BC_INST(CAL, cond, BC_LABEL(label))     // call subroutine
+#define BC_RTN(cond)                BC_INST(RTN, cond, 0x0000)              // return from call
+#define BC_IRQ(cond, bits)          BC_INST(IRQ, cond, (bits))              // interrupt request
+#define BC_HLT(cond)                BC_INST(HLT, cond, 0x0000)              // halt
+#define BC_DLY(cond, delay)         BC_INST(DLY, cond, (delay))             // delay
+#define BC_WFT(cond)                BC_INST(WFT, cond, 0x0000)              // wait for frame timer
+#define BC_WTG(cond)                BC_INST(WTG, cond, 0x0000)              // wait for trigger
+// other op codes: BC_INST(op, cond, param)
+
+// row expanders for a list of ROW(label, instruction) rows: label enum
+// BC_L_label = instruction number, then the instruction words
+#define BC_ILIST_LABEL(label, inst)     BC_L_##label,
+#define BC_ILIST_WORDS(label, inst)     inst,
+
+
+//------------------------------------------------------------------------------
+//                       BC Rate Group Scheduler
+//------------------------------------------------------------------------------
+
+//      Build_BC_Schedule( ) turns a list of periodic messages into message blocks
+//      and an instruction list driven by the BC frame timer. The major frame is
+//      minor_frames minor frames; a message with period p is sent in every p-th
+//      minor frame starting at its phase. With a 20ms minor frame, periods 1, 2
+//      and 4 give 50Hz, 25Hz and 12.5Hz. Each minor frame is
+//
+//          SFT             start frame timer, loaded by LFT at the top of the list
+//          XEQ  msg ...    messages due in this minor frame
+//          WFT             wait for frame timer to expire
+//
+//      and the last minor frame jumps back to the first. Message start times 
+//      within a minor frame are set by each block's Time to Next Message word.
+//
+//      Build_BC_Schedule( ) only checks that both areas end below 0x8000. The
+//      caller must reserve the RAM: no RT buffer, BC table or MT stack may use
+//      ilist_addr to ilist_addr + ilist_words - 1 or msg_addr to msg_addr +
+//      msg_words - 1 while the BC runs.
+
+// frame timer and Time to Next Message resolution, see HI-6130/6131 datasheet
+#define BC_FRAME_TICK_US    100
+#define BC_TTNM_TICK_US     1
+
+// bus time estimate per message: 20us per word, RT response time per response,
+// plus an intermessage gap
+#define BC_WORD_US          20
+#define BC_SCHED_RESP_US    12
+#define BC_SCHED_GAP_US     10
+
+#define BC_SCHED_MAX_MSGS   32
+#define BC_SCHED_MAX_FRAMES 16
+#define BC_SCHED_BUF_WORDS  512     // largest instruction list or message block area
+
+// BC_SCHED_MSG phase: put the message in its least loaded minor frames
+#define BC_SCHED_AUTO       0xFF
+
+// suggested RAM for a schedule, between the demo BC message blocks (to 0x3E5F)
+// and the RT2 buffers and benchmark range (from 0x4000). The SMT stacks, RT2
+// circular buffer and SPI tune range use 0x5400-0x7FFF.
+#define BC_SCHED_MSG_ADDR   0x3E60  // thru 0x3EFF, 20 message blocks
+#define BC_SCHED_ILIST_ADDR 0x3F00  // thru 0x3FFF, 256 words
+
+// one periodic message
+typedef struct {
+    unsigned short control;         // BC Control Word, TXTTMC17 ... RT_RT above
+    unsigned short command;         // Command Word, receive Command Word for RT-to-RT
+    unsigned short tx_command;      // RT-to-RT transmit Command Word, else unused
+    unsigned short data_addr;       // data buffer address
+    unsigned char  period;          // minor frames between transmissions, divides minor_frames
+    unsigned char  phase;           // first minor frame, 0 to period - 1, or BC_SCHED_AUTO
+} BC_SCHED_MSG;
+
+// one schedule. The caller sets the first group, Build_BC_Schedule( ) the rest.
+typedef struct {
+    const BC_SCHED_MSG *msgs;       // message list, in XEQ order within a minor frame
+    unsigned char  num_msgs;        // 1 to BC_SCHED_MAX_MSGS
+    unsigned char  minor_frames;    // minor frames per major frame, 1 to BC_SCHED_MAX_FRAMES
+    unsigned short minor_us;        // minor frame time, multiple of BC_FRAME_TICK_US
+    unsigned short ilist_addr;      // instruction list RAM address, even
+    unsigned short msg_addr;        // message block RAM address, 16-word aligned
+
+    unsigned short ilist_words;     // instruction list length
+    unsigned short msg_words;       // message block RAM used
+    unsigned short frame_us[BC_SCHED_MAX_FRAMES];   // bus time booked per minor frame
+    unsigned short peak_us;         // busiest minor frame
+    unsigned char  phase[BC_SCHED_MAX_MSGS];        // phase used for each message
+} BC_SCHED;
+
+
+//------------------------------------------------------------------------------
+//                       BC Data Double Buffering
+//------------------------------------------------------------------------------
+//      A BC receive command (BC-to-RT) sends the data words its message block's
+//      Data Addr word points to, read from RAM while the message is on the bus.
+//      Update_BC_Data_Buffer( ) writes new data to the buffer the BC is not
+//      using, in one burst, then writes the Data Addr word: the next time the
+//      message runs it sends the new data, and a message in progress finishes
+//      with the old. The BC keeps running throughout.
+//
+//      Before it writes the inactive buffer, the update waits while BCMIP is set
+//      and the BC Last Message Block Address register holds this message, since
+//      that message may have started before the previous update's pointer write.
+
+// Master Status polls before Update_BC_Data_Buffer( ) gives up. A 32-word
+// message is under 700us.
+#define BC_DBUF_WAIT        2000
+
+// one double-buffered BC message
+typedef struct {
+    unsigned short msg_addr;        // message block address
+    unsigned short buffer[2];       // data buffer addresses
+    unsigned short words;           // data words per buffer, 1 to 32
+    unsigned char  active;          // buffer the Data Addr word points to, 0 or 1
+} BC_DBUF;
+
+
+//------------------------------------------------------------------------------
+//                       BC Result Harvesting
+//------------------------------------------------------------------------------
+//      Start_BC_Harvest( ) takes a list of message blocks. Each BC end of
+//      message (BCEOM, SELMSG) logged in the interrupt log marks its block,
+//      and at the end of the frame every marked block's status words, then
+//      its received data, are read in one DMA burst each into a BC_RESULT
+//      table in MCU RAM. The frame ends when the log shows an IRQ op code
+//      with one of the irq_bits, e.g. BC_IRQ(ALWAYS, 0x0001) before WFT sets
+//      bit 5; with irq_bits = 0 each message is harvested as it is logged.
+//
+//      Harvesting runs in the IRQ_BC interrupt log handler, called from
+//      Poll_6131_IRQ( ) in the main loop, so results do not change while
+//      the application reads them there.
+
+#define BC_HARVEST_MAX      32      // message blocks harvested
+
+// results for one message block: control-status block words, then data
+typedef struct {
+    unsigned short msg_addr;        // message block address
+    unsigned short control;         // BC Control Word
+    unsigned short command;         // Command Word, receive Command Word for RT-to-RT
+    unsigned short time_tag;        // Time Tag Word
+    unsigned short block_status;    // Block Status Word
+    unsigned short loopback;        // Loopback Word
+    unsigned short rt_status;       // RT Status Word, transmitting RT for RT-to-RT
+    unsigned short tx_command;      // RT-to-RT transmit Command Word, else 0
+    unsigned short rx_status;       // RT-to-RT receiving RT Status Word, else 0
+    unsigned short words;           // received data words in data[ ], 0 for receive commands
+    unsigned short data[32];
+    unsigned short count;           // times harvested since Start_BC_Harvest( ), wraps
+} BC_RESULT;
+
+
+//------------------------------------------------------------------------------
+//                       BC General Purpose Queue Consumer
+//------------------------------------------------------------------------------
+//      PTT, PTH, PBS, PSI and PSM instructions push one word each into the
+//      64-word General Purpose Queue, 0x00C0-0x00FF by default. The BC GP Queue
+//      Pointer register addresses the next word the BC writes; the queue wraps
+//      at its 64-word boundary, setting BCGPQ. The words carry no type, so the
+//      consumer is given the push pattern the instruction list repeats, e.g.
+//      PTT, PBS, PSI once per minor frame.
+//
+//      Drain_BC_GPQ( ) reads the words pushed since the last drain in one or two
+//      DMA bursts and decodes them by pattern position: PTT and PTH words set
+//      the time tag, every PBS, PSI or PSM word becomes a BC_GPQ_RECORD stamped
+//      with it. The IRQ_BC interrupt log handler drains at every BCGPQ rollover,
+//      so nothing is lost while Poll_6131_IRQ( ) keeps up. The rollovers also
+//      count full laps of the queue: words the BC overwrote before they were
+//      read are counted by Get_BC_GPQ_Lost( ) and skipped in the pattern, so
+//      decoding stays in step. The handler is shared with result harvesting.
+
+#define BC_GPQ_WORDS        64      // queue length, words
+#define BC_GPQ_MAX_PATTERN  16      // push instructions per pattern
+#define BC_GPQ_RECORDS      64      // records held in MCU RAM, power of 2
+
+// one pushed word
+typedef struct {
+    unsigned short op;              // pushing op code: PBS, PSI or PSM
+    unsigned short data;            // word pushed
+    unsigned short time_tag;        // last PTT word before it, 0 if none
+    unsigned short time_high;       // last PTH word before it, 0 if none
+} BC_GPQ_RECORD;
 
 
 //----------------------------------------------------------------------
@@ -240,6 +464,47 @@ void SW2_BCtest (void);
 void initialize_613x_BC(void);
 
 
+// This function writes the message blocks and frame-timed instruction
+// list for a BC_SCHED rate group schedule, with bus load per minor frame.
+// Returns 'F' for a bad schedule or an overloaded minor frame, else 'P'.
+//
+unsigned char Build_BC_Schedule(BC_SCHED *sched);
+
+
+// Function call writes the demo 50Hz / 25Hz / 12.5Hz rate group schedule
+// (BC_RATE_SCHEDULE = YES) in place of the demo instruction list
+//
+unsigned char initialize_bc_schedule(void);
+
+
+// These functions set up and update a double-buffered BC message: the
+// inactive data buffer is written by DMA, then the Data Addr word flipped.
+// Return 'F' for a bad parameter, or if the BC stays busy on the message.
+//
+unsigned char Init_BC_Data_Buffer(BC_DBUF *dbuf, unsigned short msg_addr, unsigned short alt_buffer, unsigned short words);
+unsigned char Update_BC_Data_Buffer(BC_DBUF *dbuf, unsigned short *data);
+
+
+// These functions read BC message results into MCU RAM once per frame, see
+// BC Result Harvesting above. Get_BC_Result( ) returns a block's latest
+// results, or null for a block not in the harvest list.
+//
+unsigned char Start_BC_Harvest(const unsigned short *msg_addr, unsigned char count, unsigned short irq_bits);
+void Stop_BC_Harvest(void);
+unsigned char Harvest_BC_Results(unsigned char all);
+const BC_RESULT *Get_BC_Result(unsigned short msg_addr);
+
+
+// These functions consume the BC General Purpose Queue, see above. Start_BC_GPQ( )
+// skips words already queued; Read_BC_GPQ_Record( ) returns 'F' when empty.
+// Get_BC_GPQ_Lost( ) counts overwritten words and records that did not fit.
+//
+unsigned char Start_BC_GPQ(const unsigned short *pattern, unsigned char count);
+unsigned short Drain_BC_GPQ(void);
+unsigned char Read_BC_GPQ_Record(BC_GPQ_RECORD *record);
+unsigned short Get_BC_GPQ_Lost(void);
+
+
 
 // End of File 
 
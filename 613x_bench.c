@@ -0,0 +1,414 @@
+/*
+ *  file	613x_bench.c
+ *
+ *  brief	This file contains a throughput and latency benchmark for the
+ *		HI-6131 SPI transfer functions in board_6131.c. Results are
+ *		printed to the console as comma-separated lines so they can be
+ *		captured and compared release to release:
+ *
+ *		BENCH,scbr,dlybs,dlybct,function,words,calls,cycles_per_call,words_per_sec
+ *
+ *		scbr, dlybs and dlybct are the SPI chip select register fields in
+ *		effect (see Set_6131_SPI_Timing). "words" is the number of 16-bit
+ *		words moved per call, cycles_per_call is the average MCLK cycle
+ *		count per call and words_per_sec is based on BOARD_MCK.
+ *
+ *		On the target, cycles are counted by the Cortex-M3 DWT cycle
+ *		counter. In the host build (HOST_MODEL = YES) cycles are the SPI
+ *		bus time modeled by host/hi6131_sim.c, so CPU time between
+ *		frames is not included.
+ *
+ *		The benchmark writes HI-6131 RAM BENCH_RAM_ADDR through
+ *		BENCH_RAM_ADDR + BENCH_RAM_WORDS - 1 and uses MAP3. The RAM range
+ *		and the SPI timing are restored when finished, but BC, RT1, RT2
+ *		and MT must be disabled while the benchmark runs: RT2 transmit
+ *		buffers live in that range. The console refuses to start it
+ *		otherwise.
+ *
+ *		Stress_6131( ) checks every SPI read path against known RAM
+ *		patterns at each benchmark SPI timing setting, one line per
+ *		setting and read function:
+ *
+ *		STRESS,scbr,dlybs,dlybct,function,words_read,errors
+ *
+ *
+ *		HOLT DISCLAIMER
+ *
+ *		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *		EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *		OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *		NONINFRINGEMENT.
+ *		IN NO EVENT SHALL HOLT, INC BE LIABLE FOR ANY CLAIM, DAMAGES
+ *		OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ *		OTHERWISE,ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *		SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *		Copyright (C) 2011 by  HOLT, Inc.
+ *		All Rights Reserved.
+ *
+ */
+
+// standard Atmel/IAR headers
+#include <board.h>
+#include <intrinsics.h>
+#include <stdio.h>
+
+// Holt project headers
+#include "613x_initialization.h"
+#include "board_6131.h"
+#include "device_6131.h"
+#include "613x_bench.h"
+#if (HOST_MODEL == YES)
+#include "hi6131_sim.h"
+#endif
+
+
+//------------------------------------------------------------------------------
+//         Local Definitions
+//------------------------------------------------------------------------------
+
+// calls per measurement, so short transfers average over several calls
+#define BENCH_MAX_CALLS     64
+
+// benchmark cases
+#define B_WRITE_REG         0   // Write_6131LowReg( )
+#define B_READ_REG          1   // Read_6131LowReg( )
+#define B_READ_1WORD        2   // Read_6131_1word( )
+#define B_WRITE_BLOCK       3   // Write_6131_Block( ), CPU
+#define B_READ_BLOCK        4   // Read_6131_Block( ), CPU
+#define B_WRITE_BURST       5   // Write_6131_Burst( ), DMA
+#define B_READ_BURST        6   // Read_6131_Burst( ), DMA
+#define B_FILL              7   // Fill_6131RAM( )
+#define B_DT_WRITE_BLOCK    8   // descriptor table load, CPU
+#define B_DT_READ_BLOCK     9   // descriptor table read, CPU
+#define B_DT_WRITE_BURST    10  // descriptor table load, DMA
+
+// read stress cases
+#define S_LOWREG            0   // Read_6131LowReg( ), MAP3 register
+#define S_1WORD             1   // Read_6131_1word( )
+#define S_ADV4              2   // ReadWord_Adv4( ), every 4th word
+#define S_READ              3   // Read_6131( ) to read_data[ ]
+#define S_BUFFER            4   // Read_6131_Buffer( ) to read_data[ ]
+#define S_BLOCK             5   // Read_6131_Block( ), CPU
+#define S_BURST             6   // Read_6131_Burst( ), DMA
+#define S_CASES             7
+
+
+//------------------------------------------------------------------------------
+//         Local Variables
+//------------------------------------------------------------------------------
+
+// SPI timing settings measured by Bench_6131( ): SCBR, DLYBS, DLYBCT.
+// The first entry is the Configure_ARM_MCU_SPI( ) default.
+static const unsigned char bench_timing[][3] = {
+    { 3, 12, 1 },   // 16MHz, .25us nCS-SCK, .67us between transfers
+    { 3,  0, 0 },   // 16MHz, minimum delays
+    { 3,  6, 0 },   // 16MHz, .125us nCS-SCK
+    { 4, 12, 1 },   // 12MHz
+    { 6, 12, 1 },   //  8MHz
+    { 12, 12, 1 }   //  4MHz
+};
+
+// transfer sizes measured for block and burst functions, words
+static const unsigned short bench_sizes[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+
+// transfer data, and the saved contents of the benchmark RAM range
+static unsigned short bench_data[BENCH_MAX_WORDS];
+static unsigned short bench_save[BENCH_RAM_WORDS];
+// enabled Memory Address Pointer when the benchmark started, 1-4
+static unsigned char bench_map;
+
+static const char * const stress_names[S_CASES] = {
+    "Read_6131LowReg", "Read_6131_1word", "ReadWord_Adv4", "Read_6131",
+    "Read_6131_Buffer", "Read_6131_Block", "Read_6131_Burst"
+};
+// words read and mismatches per read stress case, at one SPI timing setting
+static unsigned long stress_words[S_CASES];
+static unsigned long stress_errors[S_CASES];
+
+// words read by Read_6131( ) and Read_6131_Buffer( ), declared in board_6131.c
+extern unsigned short read_data[];
+
+
+//------------------------------------------------------------------------------
+//         Local Functions
+//------------------------------------------------------------------------------
+
+// run one case and print its result line
+static void bench_case(const char *name, unsigned char which, unsigned short words) {
+
+    unsigned short i, calls;
+    unsigned long start, cycles;
+    unsigned long long wps = 0;
+    unsigned char scbr, dlybs, dlybct;
+
+    calls = BENCH_MAX_WORDS / words;
+    if(calls > BENCH_MAX_CALLS) calls = BENCH_MAX_CALLS;
+    if(calls == 0) calls = 1;
+
+    // MAP3 addresses the benchmark RAM for the single word functions
+    enaMAP(3);
+    Write_6131LowReg(MAP_3, BENCH_RAM_ADDR, 1);
+
+    start = Bench_Cycles();
+    switch(which) {
+        case B_WRITE_REG:
+            for(i = 0; i < calls; i++) Write_6131LowReg(MAP_3, BENCH_RAM_ADDR, 1);
+            break;
+        case B_READ_REG:
+            for(i = 0; i < calls; i++) Read_6131LowReg(MAP_3, 1);
+            break;
+        case B_READ_1WORD:
+            for(i = 0; i < calls; i++) Read_6131_1word(1);
+            break;
+        case B_WRITE_BLOCK:
+            for(i = 0; i < calls; i++) Write_6131_Block(BENCH_RAM_ADDR, bench_data, words, 0, 1);
+            break;
+        case B_READ_BLOCK:
+            for(i = 0; i < calls; i++) Read_6131_Block(BENCH_RAM_ADDR, bench_data, words, 0, 1);
+            break;
+        case B_WRITE_BURST:
+            for(i = 0; i < calls; i++) Write_6131_Burst(BENCH_RAM_ADDR, bench_data, words, 0, 1);
+            break;
+        case B_READ_BURST:
+            for(i = 0; i < calls; i++) Read_6131_Burst(BENCH_RAM_ADDR, bench_data, words, 0, 1);
+            break;
+        case B_FILL:
+            for(i = 0; i < calls; i++) Fill_6131RAM(BENCH_RAM_ADDR, words, 0x0000);
+            break;
+        case B_DT_WRITE_BLOCK:
+            for(i = 0; i < calls; i++) Write_6131_Block(BENCH_RAM_ADDR, bench_data, words, 1, 0);
+            break;
+        case B_DT_READ_BLOCK:
+            for(i = 0; i < calls; i++) Read_6131_Block(BENCH_RAM_ADDR, bench_data, words, 1, 0);
+            break;
+        case B_DT_WRITE_BURST:
+            for(i = 0; i < calls; i++) Write_6131_Burst(BENCH_RAM_ADDR, bench_data, words, 1, 1);
+            break;
+        default:
+            return;
+    }
+    cycles = Bench_Cycles() - start;
+
+    if(cycles) wps = (unsigned long long)words * calls * BOARD_MCK / cycles;
+    Get_6131_SPI_Timing(&scbr, &dlybs, &dlybct);
+    printf("BENCH,%u,%u,%u,%s,%u,%u,%lu,%lu\r\n", scbr, dlybs, dlybct, name,
+           words, calls, cycles / calls, (unsigned long)wps);
+}
+
+
+// all cases at the SPI timing now in effect
+static void bench_all_cases(void) {
+
+    unsigned char i;
+
+    bench_case("Write_6131LowReg", B_WRITE_REG, 1);
+    bench_case("Read_6131LowReg", B_READ_REG, 1);
+    bench_case("Read_6131_1word", B_READ_1WORD, 1);
+    for(i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i++) {
+        bench_case("Write_6131_Block", B_WRITE_BLOCK, bench_sizes[i]);
+        bench_case("Read_6131_Block", B_READ_BLOCK, bench_sizes[i]);
+        bench_case("Write_6131_Burst", B_WRITE_BURST, bench_sizes[i]);
+        bench_case("Read_6131_Burst", B_READ_BURST, bench_sizes[i]);
+    }
+    bench_case("Fill_6131RAM", B_FILL, BENCH_RAM_WORDS);
+    // one 512-word RT descriptor table, MAP reloaded every 4 words
+    bench_case("Dtable_Write_Block", B_DT_WRITE_BLOCK, 512);
+    bench_case("Dtable_Read_Block", B_DT_READ_BLOCK, 512);
+    bench_case("Dtable_Write_Burst", B_DT_WRITE_BURST, 512);
+}
+
+
+// save benchmark RAM and enabled MAP, start cycle counter, print column names
+static void bench_begin(void) {
+
+    unsigned short i;
+
+    bench_map = (unsigned char)(getMAPaddr() - (MAP_1) + 1);
+    Read_6131_Block(BENCH_RAM_ADDR, bench_save, BENCH_RAM_WORDS, 0, 1);
+    for(i = 0; i < BENCH_MAX_WORDS; i++) bench_data[i] = i;
+
+#if (HOST_MODEL != YES)
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+
+    printf("\r\nBENCH,scbr,dlybs,dlybct,function,words,calls,cycles_per_call,words_per_sec\r\n");
+}
+
+
+// restore benchmark RAM and enabled MAP
+static void bench_end(void) {
+
+    Write_6131_Block(BENCH_RAM_ADDR, bench_save, BENCH_RAM_WORDS, 0, 1);
+    enaMAP(bench_map);
+}
+
+
+// read stress pattern word i for a pass: alternating bits, walking one,
+// walking zero, then a scrambled count, so every data bit toggles
+static unsigned short stress_word(unsigned short i, unsigned long pass) {
+
+    switch(pass & 3) {
+        case 0:  return (i & 1) ? 0xAAAA : 0x5555;
+        case 1:  return (unsigned short)(1 << ((i + pass) & 15));
+        case 2:  return (unsigned short)~(1 << ((i + pass) & 15));
+        default: return (unsigned short)(i * 0x9E37 + pass);
+    }
+}
+
+
+// count the words of got[ ] that differ from the pattern, every step'th word
+static void stress_check(unsigned char which, const unsigned short *got, unsigned short count,
+                         unsigned short step, unsigned long pass) {
+
+    unsigned short i;
+
+    for(i = 0; i < count; i++)
+        if(got[i] != stress_word(i * step, pass)) stress_errors[which]++;
+    stress_words[which] += count;
+}
+
+
+// write one pattern into the stress RAM range, then read it back with each
+// read function. MAP3 is enabled throughout.
+static void stress_pass(unsigned long pass) {
+
+    unsigned short i, data;
+
+    for(i = 0; i < STRESS_WORDS; i++) bench_data[i] = stress_word(i, pass);
+    Write_6131_Block(BENCH_RAM_ADDR, bench_data, STRESS_WORDS, 0, 1);
+
+    // register read: MAP3 itself holds each pattern word in turn
+    for(i = 0; i < STRESS_WORDS; i++) {
+        Write_6131LowReg(MAP_3, bench_data[i], 1);
+        if(Read_6131LowReg(MAP_3, 1) != bench_data[i]) stress_errors[S_LOWREG]++;
+    }
+    stress_words[S_LOWREG] += STRESS_WORDS;
+
+    // single word reads, MAP3 auto-increments
+    Write_6131LowReg(MAP_3, BENCH_RAM_ADDR, 1);
+    for(i = 0; i < STRESS_WORDS; i++) bench_data[i] = Read_6131_1word(1);
+    stress_check(S_1WORD, bench_data, STRESS_WORDS, 1, pass);
+
+    // single word reads, MAP3 advances by 4
+    Write_6131LowReg(MAP_3, BENCH_RAM_ADDR, 1);
+    for(i = 0; i < STRESS_WORDS / 4; i++) bench_data[i] = ReadWord_Adv4(1);
+    stress_check(S_ADV4, bench_data, STRESS_WORDS / 4, 4, pass);
+
+    Read_6131(BENCH_RAM_ADDR, STRESS_WORDS);
+    stress_check(S_READ, read_data, STRESS_WORDS, 1, pass);
+
+    // MAP3 addresses a word holding the buffer address
+    data = BENCH_RAM_ADDR;
+    Write_6131_Block(BENCH_RAM_ADDR + STRESS_WORDS, &data, 1, 0, 1);
+    Write_6131LowReg(MAP_3, BENCH_RAM_ADDR + STRESS_WORDS, 1);
+    Read_6131_Buffer(STRESS_WORDS, 0, 1);
+    stress_check(S_BUFFER, read_data, STRESS_WORDS, 1, pass);
+
+    Read_6131_Block(BENCH_RAM_ADDR, bench_data, STRESS_WORDS, 0, 1);
+    stress_check(S_BLOCK, bench_data, STRESS_WORDS, 1, pass);
+
+    Read_6131_Burst(BENCH_RAM_ADDR, bench_data, STRESS_WORDS, 0, 1);
+    stress_check(S_BURST, bench_data, STRESS_WORDS, 1, pass);
+}
+
+
+//------------------------------------------------------------------------------
+//         Functions
+//------------------------------------------------------------------------------
+
+//	This function returns a free-running MCLK cycle count: the DWT cycle
+//	counter on the target, modeled SPI bus time in the host build.
+//
+unsigned long Bench_Cycles(void) {
+
+#if (HOST_MODEL == YES)
+    return sim_6131_cycles();
+#else
+    return DWT_CYCCNT;
+#endif
+}
+
+
+//	This function runs every benchmark case at each SPI timing setting in
+//	bench_timing[ ], then restores the SPI timing in effect when called.
+//
+void Bench_6131(void) {
+
+    unsigned char i, scbr, dlybs, dlybct;
+
+    Get_6131_SPI_Timing(&scbr, &dlybs, &dlybct);
+    bench_begin();
+    for(i = 0; i < sizeof(bench_timing) / sizeof(bench_timing[0]); i++) {
+        Set_6131_SPI_Timing(bench_timing[i][0], bench_timing[i][1], bench_timing[i][2]);
+        bench_all_cases();
+    }
+    Set_6131_SPI_Timing(scbr, dlybs, dlybct);
+    bench_end();
+}
+
+
+//	This function runs every benchmark case at one SPI timing setting, then
+//	restores the SPI timing in effect when called.
+//
+//	param	scbr    SCK = MCLK / scbr
+//	param	dlybs   delay from nCS to first SCK = dlybs / MCLK
+//	param	dlybct  delay between consecutive transfers = 32 x dlybct / MCLK
+//
+void Bench_6131_Setting(unsigned char scbr, unsigned char dlybs, unsigned char dlybct) {
+
+    unsigned char s, b, c;
+
+    Get_6131_SPI_Timing(&s, &b, &c);
+    if(Set_6131_SPI_Timing(scbr, dlybs, dlybct) != 'P') return;
+    bench_begin();
+    bench_all_cases();
+    Set_6131_SPI_Timing(s, b, c);
+    bench_end();
+}
+
+//	This function reads known RAM patterns with every SPI read function,
+//	passes times at each SPI timing setting in bench_timing[ ], and prints
+//	the words read and mismatches per setting and function. Receive data is
+//	taken only after the SPI reports RDRF or the DMA channel completes, so
+//	any mismatch is a real timing or wiring fault. The RAM range, MAP3, the
+//	enabled MAP and the SPI timing are restored when finished; BC, RT1, RT2
+//	and MT must be disabled while the test runs, as for Bench_6131( ).
+//
+//	param	passes  patterns written and read back at each setting
+//
+//	Returns the total number of mismatched words, zero if all reads passed.
+//
+unsigned long Stress_6131(unsigned long passes) {
+
+    unsigned char i, j, scbr, dlybs, dlybct;
+    unsigned short map3;
+    unsigned long pass, total = 0;
+
+    Get_6131_SPI_Timing(&scbr, &dlybs, &dlybct);
+    bench_map = (unsigned char)(getMAPaddr() - (MAP_1) + 1);
+    enaMAP(3);
+    map3 = Read_6131LowReg(MAP_3, 1);
+    Read_6131_Block(BENCH_RAM_ADDR, bench_save, STRESS_WORDS + 1, 0, 1);
+
+    printf("\r\nSTRESS,scbr,dlybs,dlybct,function,words_read,errors\r\n");
+    for(i = 0; i < sizeof(bench_timing) / sizeof(bench_timing[0]); i++) {
+        Set_6131_SPI_Timing(bench_timing[i][0], bench_timing[i][1], bench_timing[i][2]);
+        for(j = 0; j < S_CASES; j++) stress_words[j] = stress_errors[j] = 0;
+        for(pass = 0; pass < passes; pass++) stress_pass(pass);
+        for(j = 0; j < S_CASES; j++) {
+            printf("STRESS,%u,%u,%u,%s,%lu,%lu\r\n", bench_timing[i][0], bench_timing[i][1],
+                   bench_timing[i][2], stress_names[j], stress_words[j], stress_errors[j]);
+            total += stress_errors[j];
+        }
+    }
+    Set_6131_SPI_Timing(scbr, dlybs, dlybct);
+
+    Write_6131_Block(BENCH_RAM_ADDR, bench_save, STRESS_WORDS + 1, 0, 1);
+    Write_6131LowReg(MAP_3, map3, 1);
+    enaMAP(bench_map);
+    return total;
+}
+
+// end of file
@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	613x_bench.h
+ *    brief     This file contains prototype functions and
+ * 	        definitions used by functions in 613x_bench.c file.
+ *
+ *	   	HOLT DISCLAIMER
+ *      	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+ *      	KIND, EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ *      	WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *      	PURPOSE AND NONINFRINGEMENT.
+ *      	IN NO EVENT SHALL HOLT, INC BE LIABLE FOR ANY CLAIM, DAMAGES
+ *      	OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ *      	OTHERWISE,ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *      	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *              Copyright (C) 2009-2011 by  HOLT, Inc.
+ *              All Rights Reserved
+ */
+
+//------------------------------------------------------------------------------
+//      Benchmark Definitions
+//------------------------------------------------------------------------------
+
+// HI-6131 RAM used for benchmark transfers. Contents are saved before and
+// restored after each benchmark run.
+#define BENCH_RAM_ADDR      0x4000
+#define BENCH_RAM_WORDS     4096
+
+// largest transfer measured, words
+#define BENCH_MAX_WORDS     4096
+
+// Read stress test: RAM words checked per pass by each read function, and
+// the pass count used by the console. 4000 passes read about a million words
+// per function at each SPI timing setting. The word after the test range
+// holds the buffer pointer for Read_6131_Buffer( ).
+#define STRESS_WORDS        256
+#define STRESS_PASSES       4000
+
+
+//------------------------------------------------------------------------------
+//      Global Function Prototypes
+//------------------------------------------------------------------------------
+
+void Bench_6131(void);
+void Bench_6131_Setting(unsigned char scbr, unsigned char dlybs, unsigned char dlybct);
+unsigned long Bench_Cycles(void);
+unsigned long Stress_6131(unsigned long passes);
+
+
+// End of File
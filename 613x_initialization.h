@@ -117,6 +117,12 @@
 				//  NO = descriptor table is initialized to store mode command
 				//       results in assigned RAM buffers
 
+//    brief	Macro for selecting the BC instruction list
+//
+#define BC_RATE_SCHEDULE  NO	// YES = initialize_bc_schedule( ) runs a 50Hz / 25Hz / 12.5Hz
+				//	 message set from the BC frame timer, no host involvement
+                                //  NO = demo list, each message waits for a BC trigger
+
 //    brief	Macro for enabling/disabling irq-driven bus activity LEDs based on ACTIVE signal
 //
 #define BUS_ACTIVITY_LEDS  YES	// YES = enables falling edge IRQ when ACTIVE subsides
@@ -128,6 +134,52 @@
                                 //  NO = Bus activity LEDs are disabled.
 
 
+//    brief	Macro for enabling/disabling vectored HI-6131 interrupt service (file 613x_irq.c)
+//
+#define IRQ_HANDLING  YES	// YES = PIO interrupt on nIRQ reads the pending interrupt
+				//	 registers and queues events; the main loop calls 
+				//	 the hardware, BC, RT1, RT2 and MT callbacks set 
+				//	 by Set_6131_IRQ_Callback( )
+                                //  NO = pending interrupts are only seen by console keys 6-9
+
+
+//    brief	Macro for selecting the SPI frame size used for HI-6131 data words (HI-6131 only)
+//
+#define SPI_16BIT_FRAMES  YES	// YES = each data word is one 16-bit SPI transfer,
+				//	 op codes remain 8-bit transfers
+                                //  NO = each data word is two 8-bit SPI transfers
+
+
+//    brief	Macro for building the SPI transaction trace ring into board_6131.c (HI-6131 only)
+//
+#define SPI_TRACE  YES		// YES = Start_6131_Trace( ) records every SPI op code with
+				//	 cycle stamps, a few cycles per op code when running
+                                //  NO = trace functions are empty, no overhead
+
+
+//    brief	Macro for SPI clock and delay calibration at startup (HI-6131 only)
+//
+#define SPI_AUTOTUNE  YES	// YES = main( ) calls Tune_6131_SPI_Timing( ) after reset to
+				//	 pick the fastest reliable SCK and delays, less a margin
+                                //  NO = Configure_ARM_MCU_SPI( ) settings are kept
+
+
+//    brief	Macro for RAM table verification after host initialization (HI-6131 only)
+//
+#define RAM_VERIFY  YES		// YES = init functions record a CRC of each RAM table they write,
+				//	 main( ) reads the tables back and compares CRCs
+                                //  NO = no recording, Verify_6131_Images( ) always passes
+
+
+//    brief	Macro for building the HI-6131 driver on a PC against the simulated device
+//
+#ifndef HOST_MODEL
+#define HOST_MODEL  NO		// YES = SPI frames go to the HI-6131 model in host/hi6131_sim.c,
+				//	 set on the host build command line (see host/host_main.c)
+                                //  NO = normal build for the Holt evaluation board
+#endif
+
+
 
 
 //    brief	misc macro list
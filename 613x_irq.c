@@ -0,0 +1,607 @@
+/*
+ *  file	613x_irq.c
+ *
+ *  brief	This file contains the vectored interrupt service for the HI-6131
+ *		nIRQ output. A PIO interrupt on the nIRQ pin (PB1) reads the
+ *		pending interrupt registers and the new interrupt log entries.
+ *		Reading a pending register clears it.
+ *
+ *		The service is split in two. The top half, Service_6131_IRQ( ),
+ *		runs with interrupts disabled and only reads device words: it
+ *		queues an event for each source with pending bits (hardware, BC,
+ *		RT1, RT2 and MT) and for each log entry. The bottom half,
+ *		Poll_6131_IRQ( ) in the main loop, removes the events and calls
+ *		the per-source callbacks and log handlers with interrupts enabled,
+ *		so their buffer reads and console output do not lengthen the
+ *		interrupt-disabled window, and events arriving under load are
+ *		handled in batches.
+ *
+ *		The event queue is a single-producer, single-consumer ring: only
+ *		code running with interrupts disabled adds events and only the
+ *		bottom half removes them, so neither side takes a lock. Each
+ *		index is written by one side only, and an event is complete
+ *		before the index that publishes it is advanced. If the ring is
+ *		full, pending bits are merged into a per-source backlog that the
+ *		bottom half delivers after the ring; a log entry that does not
+ *		fit is counted as lost.
+ *
+ *		The four pending registers 0x06-0x09 are read by one MAP burst,
+ *		Read_6131_IntRegs( ), so each interrupt costs two SPI op codes
+ *		and all sources are seen at the same instant. The RTIP, MTIP and
+ *		BCIP summary bits are removed from the hardware pending bits.
+ *
+ *		The top half runs between Enter_6131_ISR( ) and Exit_6131_ISR( )
+ *		with MAP_MSG_ISR (MAP4) enabled, so a foreground multi-word
+ *		transfer that was interrupted resumes by itself. If a DMA burst
+ *		owns the SPI the service is deferred: Poll_6131_IRQ( ) in the
+ *		main loop runs it once the burst is finished.
+ *
+ *		The top half also drains the interrupt log: every IIW/IAW pair
+ *		logged since the last service is read, one burst per contiguous
+ *		part of the ring, and queued. The bottom half passes each to the
+ *		handler for its source in the order logged, so back-to-back
+ *		message interrupts that share one pending bit are each seen. The
+ *		read position is kept here; the interrupt count in register 0x0A
+ *		detects entries overwritten before they were read.
+ *
+ *		Under heavy bus traffic per-message interrupts (RT IWA, MT EOM)
+ *		can arrive every 20us. Configure_6131_Coalescing( ) removes them
+ *		from the nIRQ output enables and lets a TC1 tick run the top
+ *		half instead, so interrupt load is bounded by the tick rate. The
+ *		interrupts stay enabled, so they are still logged and nothing is
+ *		lost as long as the log cannot wrap between ticks. In AUTO mode
+ *		the tick also counts logged messages and switches between
+ *		per-message and batch servicing with hysteresis. TC0 is the
+ *		delay timer in board_613x.c, so the tick uses TC1.
+ *
+ *		Select pulse interrupts (PULSE_INT in Master Config register 0,
+ *		the initialize_613x_shared( ) default). The PIO interrupts on both
+ *		nIRQ edges and a short pulse may be over when the service runs,
+ *		so the pending registers are read for either edge.
+ *
+ *		Enabled by IRQ_HANDLING in file 613x_initialization.h.
+ *
+ *
+ *		HOLT DISCLAIMER
+ *
+ *		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *		EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ *		OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *		NONINFRINGEMENT.
+ *		IN NO EVENT SHALL HOLT, INC BE LIABLE FOR ANY CLAIM, DAMAGES
+ *		OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ *		OTHERWISE,ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *		SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *		Copyright (C) 2011 by  HOLT, Inc.
+ *		All Rights Reserved.
+ *
+ */
+
+// standard Atmel/IAR headers
+#include <board.h>
+#include <pio/pio.h>
+#include <pio/pio_it.h>
+#include <pmc/pmc.h>
+#include <irq/irq.h>
+#include <intrinsics.h>
+
+// Holt project headers
+#include "613x_initialization.h"
+#include "613x_regs.h"
+#include "board_613x.h"
+#include "board_6131.h"
+#include "device_6131.h"
+#include "613x_irq.h"
+
+
+//------------------------------------------------------------------------------
+//         Local Variables
+//------------------------------------------------------------------------------
+
+// HI-6131 nIRQ output
+static const Pin pinNIRQ = PIN_NIRQ;
+
+// per-source callbacks, null if not used
+static IRQ_6131_CALLBACK irq_callback[IRQ_SOURCES];
+
+// pending bits seen by the service since the last Get_6131_IRQ_History( ),
+// indexed by pending register 0x06-0x09
+static unsigned short irq_history[4];
+
+// set when the service found the SPI owned by a DMA burst
+static volatile unsigned char irq_deferred;
+
+// per-source interrupt log handlers, null if not used
+static ILOG_6131_HANDLER ilog_handler[IRQ_SOURCES];
+
+// log address of the next IIW to read
+static unsigned short ilog_next = ILOG_FIRST;
+
+// log entries overwritten before they were read
+static unsigned short ilog_lost;
+
+// IIW/IAW pairs read by one drain
+static unsigned short ilog_buf[2 * ILOG_ENTRIES];
+
+// event queue. irq_head is written only by the top half, irq_tail only by
+// the bottom half. Empty when equal, one slot is left unused when full.
+static volatile IRQ_6131_EVENT irq_ring[IRQ_EVENT_RING];
+static volatile unsigned short irq_head, irq_tail;
+
+// pending bits that did not fit in the event queue, per source
+static unsigned short irq_backlog[IRQ_SOURCES];
+
+// coalescing mode set by Configure_6131_Coalescing( ), and whether
+// per-message interrupts are now serviced by the tick
+static unsigned char coal_mode = IRQ_COALESCE_OFF;
+static unsigned char coal_batch;
+
+// MT and RT Interrupt Output Enable regs 0x15-0x16 as initialized
+static unsigned short coal_output[2];
+
+// messages logged since the last tick
+static unsigned short coal_count;
+
+
+//------------------------------------------------------------------------------
+//         Local Functions
+//------------------------------------------------------------------------------
+
+// call the source's callback if it has pending bits
+static void irq_dispatch(unsigned char source, unsigned short pending) {
+
+    IRQ_6131_CALLBACK callback = irq_callback[source];
+
+    if(pending && callback) callback(pending);
+}
+
+
+// add one event to the queue, interrupts disabled. Returns 0 if full.
+static unsigned char irq_push(unsigned char type, unsigned char source, unsigned short word1, unsigned short word2) {
+
+    unsigned short head = irq_head;
+    unsigned short next = (head + 1) & (IRQ_EVENT_RING - 1);
+
+    if(next == irq_tail) return 0;
+
+    irq_ring[head].type = type;
+    irq_ring[head].source = source;
+    irq_ring[head].word1 = word1;
+    irq_ring[head].word2 = word2;
+    // publish only after the event is complete
+    irq_head = next;
+    return 1;
+}
+
+
+// queue a source's pending bits, or add them to its backlog if the queue
+// is full
+static void irq_queue_pending(unsigned char source, unsigned short pending) {
+
+    if(pending == 0) return;
+    if(!irq_push(IRQ_EVT_PENDING, source, pending, 0)) irq_backlog[source] |= pending;
+}
+
+
+// interrupt source for a log entry, from IIW bits 2-0 and the RT field
+static unsigned char ilog_source(unsigned short iiw) {
+
+    if(iiw & (BCIP)) return IRQ_BC;
+    if(iiw & (MTIP)) return IRQ_MT;
+    if(iiw & (RTIP)) return (iiw & IRQ_RT2_MASK) ? IRQ_RT2 : IRQ_RT1;
+    return IRQ_HW;
+}
+
+
+// read and queue the log entries written up to the log address in
+// count_log, the register 0x0A value. Interrupts disabled, own MAP enabled.
+// Returns the number of entries read.
+static unsigned short ilog_drain(unsigned short count_log) {
+
+    unsigned short head, count, n, first, words, i;
+
+    head = count_log & ILOG_ADDR_MASK;
+    count = count_log >> ILOG_COUNT_SHIFT;
+    if((head < ILOG_FIRST) || (head > ILOG_LAST)) return 0;
+
+    // entries between the read position and the log address
+    n = ((head - ilog_next) & (2 * ILOG_ENTRIES - 1)) >> 1;
+    if(count >= ILOG_ENTRIES) {
+        // ring wrapped, the oldest entries left start at the log address
+        ilog_lost += count - ILOG_ENTRIES;
+        n = ILOG_ENTRIES;
+    }
+    if(n == 0) return 0;
+
+    // first entry to read, then the part up to the end of the ring
+    first = ILOG_FIRST + ((head - ILOG_FIRST - 2 * n) & (2 * ILOG_ENTRIES - 1));
+    words = ILOG_LAST + 1 - first;
+    if(words > 2 * n) words = 2 * n;
+    Read_6131_MAP(first, ilog_buf, words, 0);
+    if(words < 2 * n) Read_6131_MAP(ILOG_FIRST, ilog_buf + words, 2 * n - words, 0);
+    ilog_next = head;
+
+    // source is decoded by the bottom half
+    for(i = 0; i < n; i++)
+        if(!irq_push(IRQ_EVT_LOG, 0, ilog_buf[2 * i], ilog_buf[2 * i + 1])) ilog_lost++;
+    return n;
+}
+
+
+// write the MT and RT output enable registers for per-message or batch
+// servicing. Interrupts disabled, between Enter_6131_ISR( ) and
+// Exit_6131_ISR( ) when called from an interrupt.
+static void coal_write(unsigned char batch) {
+
+    unsigned short mt = coal_output[0], rt = coal_output[1];
+
+    if(batch) {
+        mt &= ~(IRQ_COALESCE_MT_BITS);
+        rt &= ~(IRQ_COALESCE_RT_BITS);
+    }
+    Write_6131LowReg(MT_INT_OUTPUT_ENABLE_REG, mt, 0);
+    Write_6131LowReg(RT_INT_OUTPUT_ENABLE_REG, rt, 0);
+    coal_batch = batch;
+}
+
+
+// switch servicing from the tick interrupt. Skipped, and retried next tick,
+// if a DMA burst owns the SPI.
+static void coal_switch(unsigned char batch) {
+
+    unsigned char savemap = Enter_6131_ISR(MAP_MSG_ISR);
+
+    if(savemap == 0) return;
+    coal_write(batch);
+    Exit_6131_ISR(savemap);
+    // messages logged just before nIRQ output was re-enabled
+    if(!batch) Service_6131_IRQ();
+}
+
+
+// PIO interrupt on either nIRQ edge
+static void irq_6131_pin(const Pin *pin) {
+
+    // prevent warning: parameter pin is not used
+    pin = pin;
+
+    __disable_interrupt();
+    Service_6131_IRQ();
+    __enable_interrupt();
+}
+
+
+//------------------------------------------------------------------------------
+//         Functions
+//------------------------------------------------------------------------------
+
+//	This function configures the nIRQ pin interrupt. Call once, with
+//	interrupts disabled, after the HI-6131 interrupt enable and output
+//	enable registers are initialized. Set callbacks before or after.
+//
+void Configure_6131_IRQ(void) {
+
+    Reset_6131_ILog();
+    PIO_InitializeInterrupts(0);
+    PIO_ConfigureIt(&pinNIRQ, irq_6131_pin);
+    PIO_EnableIt(&pinNIRQ);
+}
+
+
+//	This function sets or clears the callback for one interrupt source.
+//
+//	param	source is IRQ_HW, IRQ_BC, IRQ_RT1, IRQ_RT2 or IRQ_MT
+//	param	callback is called with the source's pending bits, or null
+//
+//	Returns 'F' for an illegal source, otherwise 'P'.
+//
+unsigned char Set_6131_IRQ_Callback(unsigned char source, IRQ_6131_CALLBACK callback) {
+
+    if(source >= IRQ_SOURCES) return ('F');
+
+    __disable_interrupt();
+    irq_callback[source] = callback;
+    __enable_interrupt();
+
+    return ('P');
+}
+
+
+//	This function is the top half of the interrupt service: it reads the
+//	pending interrupt registers and new interrupt log entries and queues
+//	events for Poll_6131_IRQ( ). It is called by the nIRQ pin interrupt,
+//	and by Poll_6131_IRQ( ) when deferred. Interrupts must be disabled.
+//
+void Service_6131_IRQ(void) {
+
+    unsigned char savemap;
+    unsigned short hw, bc, mt, rt;
+    INT_6131_REGS regs;
+
+    savemap = Enter_6131_ISR(MAP_MSG_ISR);
+    if(savemap == 0) {
+        // a DMA burst owns the SPI
+        irq_deferred = 1;
+        return;
+    }
+    irq_deferred = 0;
+
+    // all four pending registers and the log address in one burst through
+    // MAP_MSG_ISR
+    Read_6131_IntRegs(&regs, INT_REGS_LOG, 0);
+    hw = regs.pending[INT_HDW] & ~(RTIP|MTIP|BCIP);
+    bc = regs.pending[INT_BC];
+    mt = regs.pending[INT_MT];
+    rt = regs.pending[INT_RT];
+
+    irq_history[HDW_PENDING_INT_REG - HDW_PENDING_INT_REG] |= hw;
+    irq_history[BC_PENDING_INT_REG - HDW_PENDING_INT_REG] |= bc;
+    irq_history[MT_PENDING_INT_REG - HDW_PENDING_INT_REG] |= mt;
+    irq_history[RT_PENDING_INT_REG - HDW_PENDING_INT_REG] |= rt;
+
+    irq_queue_pending(IRQ_HW, hw);
+    irq_queue_pending(IRQ_BC, bc);
+    irq_queue_pending(IRQ_RT1, rt & IRQ_RT1_MASK);
+    irq_queue_pending(IRQ_RT2, rt & IRQ_RT2_MASK);
+    irq_queue_pending(IRQ_MT, mt);
+
+    coal_count += ilog_drain(regs.count_log);
+
+    Exit_6131_ISR(savemap);
+}
+
+
+//	This function is the bottom half of the interrupt service. It runs a
+//	service that was deferred because a DMA burst owned the SPI, then
+//	calls the callbacks and log handlers for all queued events. Call from
+//	the main loop.
+//
+void Poll_6131_IRQ(void) {
+
+    if(irq_deferred) {
+        __disable_interrupt();
+        Service_6131_IRQ();
+        __enable_interrupt();
+    }
+    Process_6131_IRQ_Events(IRQ_EVENT_RING);
+}
+
+
+//	This function removes up to max_events events from the queue, oldest
+//	first, and calls the callback or log handler for each. Pending bits
+//	that did not fit in the queue are then delivered, one call per source.
+//	Call with interrupts enabled, from the main loop only: this is the
+//	single consumer of the queue.
+//
+//	param	max_events limits the events handled by one call
+//
+//	Returns the number of queued events handled.
+//
+unsigned short Process_6131_IRQ_Events(unsigned short max_events) {
+
+    unsigned short n = 0, tail, bits;
+    unsigned char source;
+    IRQ_6131_EVENT event;
+    ILOG_6131_HANDLER handler;
+
+    while((n < max_events) && (irq_tail != irq_head)) {
+        // copy the event before its slot is released to the top half
+        tail = irq_tail;
+        event.type = irq_ring[tail].type;
+        event.source = irq_ring[tail].source;
+        event.word1 = irq_ring[tail].word1;
+        event.word2 = irq_ring[tail].word2;
+        irq_tail = (tail + 1) & (IRQ_EVENT_RING - 1);
+        n++;
+
+        if(event.type == IRQ_EVT_LOG) {
+            handler = ilog_handler[ilog_source(event.word1)];
+            if(handler) handler(event.word1, event.word2);
+        }
+        else irq_dispatch(event.source, event.word1);
+    }
+
+    for(source = 0; source < IRQ_SOURCES; source++) {
+        if(irq_backlog[source] == 0) continue;
+        __disable_interrupt();
+        bits = irq_backlog[source];
+        irq_backlog[source] = 0;
+        __enable_interrupt();
+        irq_dispatch(source, bits);
+    }
+    return n;
+}
+
+
+//	This function returns the pending bits the interrupt service found in
+//	one pending register since the last call, then clears them. The console
+//	ORs these with its own register read, which only sees bits that arrived
+//	after the last service.
+//
+//	param	reg_number is HDW_PENDING_INT_REG, BC_PENDING_INT_REG,
+//		MT_PENDING_INT_REG or RT_PENDING_INT_REG
+//
+//	Returns the pending bits, 0 for an illegal register number.
+//
+unsigned short Get_6131_IRQ_History(unsigned char reg_number) {
+
+    unsigned short bits;
+
+    if((reg_number < HDW_PENDING_INT_REG) || (reg_number > RT_PENDING_INT_REG)) return 0;
+
+    __disable_interrupt();
+    bits = irq_history[reg_number - HDW_PENDING_INT_REG];
+    irq_history[reg_number - HDW_PENDING_INT_REG] = 0;
+    __enable_interrupt();
+
+    return bits;
+}
+
+//	This function sets or clears the interrupt log handler for one source.
+//
+//	param	source is IRQ_HW, IRQ_BC, IRQ_RT1, IRQ_RT2 or IRQ_MT
+//	param	handler is called with each IIW/IAW pair logged by the source, or null
+//
+//	Returns 'F' for an illegal source, otherwise 'P'.
+//
+unsigned char Set_6131_ILog_Handler(unsigned char source, ILOG_6131_HANDLER handler) {
+
+    if(source >= IRQ_SOURCES) return ('F');
+
+    __disable_interrupt();
+    ilog_handler[source] = handler;
+    __enable_interrupt();
+
+    return ('P');
+}
+
+
+//	This function moves the interrupt log read position to the device's
+//	current log address, so entries already logged are not dispatched.
+//	Called by Configure_6131_IRQ( ). Call again after HI-6131 reset.
+//
+void Reset_6131_ILog(void) {
+
+    unsigned short count_log;
+
+    __disable_interrupt();
+    count_log = Read_6131LowReg(INT_COUNT_AND_LOG_ADDR_REG, 0);
+    ilog_next = count_log & ILOG_ADDR_MASK;
+    if((ilog_next < ILOG_FIRST) || (ilog_next > ILOG_LAST)) ilog_next = ILOG_FIRST;
+    ilog_lost = 0;
+    __enable_interrupt();
+}
+
+
+//	This function reads and dispatches new interrupt log entries without
+//	waiting for an interrupt, for systems that poll the HI-6131 or leave the
+//	nIRQ output disabled for message interrupts. Entries are queued like the
+//	interrupt service does, then all queued events are processed. Call from
+//	the main loop.
+//
+//	Returns the number of entries read, 0 if a DMA burst owns the SPI.
+//
+unsigned short Drain_6131_ILog(void) {
+
+    unsigned char savemap;
+    unsigned short n;
+
+    __disable_interrupt();
+    savemap = Enter_6131_ISR(MAP_MSG_ISR);
+    if(savemap == 0) {
+        __enable_interrupt();
+        return 0;
+    }
+    n = ilog_drain(Read_6131LowReg(INT_COUNT_AND_LOG_ADDR_REG, 0));
+    Exit_6131_ISR(savemap);
+    __enable_interrupt();
+
+    Process_6131_IRQ_Events(IRQ_EVENT_RING);
+    return n;
+}
+
+
+//	This function selects per-message or batch servicing of the interrupts in
+//	IRQ_COALESCE_RT_BITS and IRQ_COALESCE_MT_BITS. Call after the HI-6131
+//	interrupt registers are initialized and Configure_6131_IRQ( ), and again
+//	after changing the MT or RT Interrupt Output Enable registers: their
+//	values are saved here and restored for per-message servicing.
+//
+//	param	mode is IRQ_COALESCE_OFF, IRQ_COALESCE_ON or IRQ_COALESCE_AUTO.
+//		AUTO starts with per-message interrupts.
+//	param	tick_us is the TC1 tick period, 1 to 43690 us. Use
+//		IRQ_COALESCE_TICK_US unless the bus has no short messages.
+//
+void Configure_6131_Coalescing(unsigned char mode, unsigned short tick_us) {
+
+    unsigned int status;
+
+    if(mode > IRQ_COALESCE_AUTO) return;	// illegal parameter
+    if(tick_us == 0) tick_us = IRQ_COALESCE_TICK_US;
+    if(tick_us > 43690) tick_us = 43690;
+
+    __disable_interrupt();
+
+    // stop the tick, restore the output enables saved by an earlier call
+    IRQ_DisableIT(AT91C_ID_TC1);
+    AT91C_BASE_TC1->TC_CCR = AT91C_TC_CLKDIS;
+    AT91C_BASE_TC1->TC_IDR = 0xFFFFFFFF;
+    if(coal_batch) coal_write(0);
+    Read_6131_MAP(MT_INT_OUTPUT_ENABLE_REG, coal_output, 2, 0);
+
+    coal_mode = mode;
+    coal_count = 0;
+    if(mode == IRQ_COALESCE_ON) coal_write(1);
+
+    if(mode != IRQ_COALESCE_OFF) {
+        // TC1 waveform mode, MCLK/32 counts up to RC and restarts
+        PMC_EnablePeripheral(AT91C_ID_TC1);
+        AT91C_BASE_TC1->TC_CMR = AT91C_TC_WAVE | AT91C_TC_WAVESEL_UP_AUTO
+                               | AT91C_TC_CLKS_TIMER_DIV3_CLOCK;
+        AT91C_BASE_TC1->TC_RC = (unsigned int)tick_us * (BOARD_MCK / 32000) / 1000;
+        // clear status by reading it
+        status = AT91C_BASE_TC1->TC_SR;
+        status = status;
+        AT91C_BASE_TC1->TC_IER = AT91C_TC_CPCS;
+        IRQ_ConfigureIT(AT91C_ID_TC1, 0);
+        IRQ_EnableIT(AT91C_ID_TC1);
+        AT91C_BASE_TC1->TC_CCR = AT91C_TC_CLKEN | AT91C_TC_SWTRG;
+    }
+
+    __enable_interrupt();
+}
+
+
+//	This function returns IRQ_COALESCE_ON while per-message interrupts are
+//	serviced by the tick, otherwise IRQ_COALESCE_OFF.
+//
+unsigned char Get_6131_Coalescing(void) {
+
+    return coal_batch ? IRQ_COALESCE_ON : IRQ_COALESCE_OFF;
+}
+
+
+//	TC1 RC compare interrupt, the coalescing tick. In batch servicing the
+//	top half runs here. In AUTO mode the messages logged since the last
+//	tick select the servicing for the next tick.
+//
+void TC1_IrqHandler(void) {
+
+    unsigned int status;
+    unsigned short count;
+
+    // reading the status register acknowledges the compare
+    status = AT91C_BASE_TC1->TC_SR;
+    status = status;
+
+    __disable_interrupt();
+    if(coal_batch) Service_6131_IRQ();
+    if(coal_mode == IRQ_COALESCE_AUTO) {
+        count = coal_count;
+        coal_count = 0;
+        if(!coal_batch && (count >= IRQ_COALESCE_HIGH)) coal_switch(1);
+        else if(coal_batch && (count <= IRQ_COALESCE_LOW)) coal_switch(0);
+    }
+    __enable_interrupt();
+}
+
+
+//	This function returns the number of log entries overwritten by the device
+//	before they were read, or dropped because the event queue was full, since
+//	the last call, then clears it. A register 0x0A read outside this file
+//	would restart the device count and could hide an overrun.
+//
+unsigned short Get_6131_ILog_Lost(void) {
+
+    unsigned short lost;
+
+    __disable_interrupt();
+    lost = ilog_lost;
+    ilog_lost = 0;
+    __enable_interrupt();
+
+    return lost;
+}
+
+// end of file
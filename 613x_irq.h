@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	613x_irq.h
+ *    brief     This file contains prototype functions and
+ * 	        definitions used by functions in 613x_irq.c file.
+ *
+ *	   	HOLT DISCLAIMER
+ *      	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+ *      	KIND, EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ *      	WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *      	PURPOSE AND NONINFRINGEMENT.
+ *      	IN NO EVENT SHALL HOLT, INC BE LIABLE FOR ANY CLAIM, DAMAGES
+ *      	OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ *      	OTHERWISE,ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *      	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *              Copyright (C) 2009-2011 by  HOLT, Inc.
+ *              All Rights Reserved
+ */
+
+//------------------------------------------------------------------------------
+//      Interrupt Service Definitions
+//------------------------------------------------------------------------------
+
+// interrupt sources, one callback each
+#define IRQ_HW          0   // Hardware Pending Interrupt reg, except RTIP MTIP BCIP
+#define IRQ_BC          1   // Bus Controller Pending Interrupt reg
+#define IRQ_RT1         2   // RT Pending Interrupt reg bits 8-0
+#define IRQ_RT2         3   // RT Pending Interrupt reg bits 15-9
+#define IRQ_MT          4   // Bus Monitor Pending Interrupt reg
+#define IRQ_SOURCES     5
+
+// RT1-2 Pending Interrupt Register fields, see RT1_xxx and RT2_xxx in 613x_regs.h
+#define IRQ_RT1_MASK    0x01FF
+#define IRQ_RT2_MASK    0xFE00
+
+// called from Poll_6131_IRQ( ) in the main loop with the source's pending bits,
+// never zero. Interrupts are enabled: the callback accesses the HI-6131 like
+// other foreground code, with irq_mgmt = 1.
+typedef void (*IRQ_6131_CALLBACK)(unsigned short pending);
+
+
+//------------------------------------------------------------------------------
+//      Interrupt Log Definitions
+//------------------------------------------------------------------------------
+
+// Each interrupt writes an Interrupt Identification Word (IIW) and Interrupt
+// Address Word (IAW) pair to the 32-entry log buffer 0x0180-0x01BF. Register
+// 0x0A bits 8-0 address where the next IIW is written, bits 15-9 count the
+// interrupts since register 0x0A was last read.
+#define ILOG_FIRST          0x0180
+#define ILOG_LAST           0x01BF
+#define ILOG_ENTRIES        32
+#define ILOG_ADDR_MASK      0x01FF
+#define ILOG_COUNT_SHIFT    9
+
+// called once per log entry, oldest first, from Poll_6131_IRQ( ) or
+// Drain_6131_ILog( ). IIW bits 2-0 identify the function like the RTIP, MTIP
+// and BCIP bits, zero for a hardware interrupt; bits 15-3 are its pending
+// interrupt bits. For message interrupts the IAW is the message address.
+// Same calling conditions as IRQ_6131_CALLBACK.
+typedef void (*ILOG_6131_HANDLER)(unsigned short iiw, unsigned short iaw);
+
+
+//------------------------------------------------------------------------------
+//      Event Queue Definitions
+//------------------------------------------------------------------------------
+
+// The interrupt service queues one event per source with pending bits and one
+// per log entry. Poll_6131_IRQ( ) removes them and calls the callbacks.
+#define IRQ_EVENT_RING      64      // queue size, events, power of 2
+
+// IRQ_6131_EVENT type
+#define IRQ_EVT_PENDING     0       // word1 = source's pending bits
+#define IRQ_EVT_LOG         1       // word1 = IIW, word2 = IAW
+
+typedef struct {
+    unsigned char  type;            // IRQ_EVT_PENDING or IRQ_EVT_LOG
+    unsigned char  source;          // IRQ_HW ... IRQ_MT, for IRQ_EVT_PENDING
+    unsigned short word1;
+    unsigned short word2;
+} IRQ_6131_EVENT;
+
+
+//------------------------------------------------------------------------------
+//      Interrupt Coalescing Definitions
+//------------------------------------------------------------------------------
+
+// Coalescing keeps the per-message RT and MT interrupts enabled, so they are
+// still pending and logged, but removes them from the output enable registers
+// so they no longer drive nIRQ. A TC1 tick then services them in batches.
+// Watermark interrupts (RT IXEQZ, MT STKADRSS and STKROVR, ...) keep their
+// output enables and still interrupt at once.
+#define IRQ_COALESCE_OFF    0       // per-message interrupts, tick stopped
+#define IRQ_COALESCE_ON     1       // batch servicing by the tick
+#define IRQ_COALESCE_AUTO   2       // switch by messages per tick
+
+// per-message interrupts that are coalesced
+#define IRQ_COALESCE_RT_BITS    ((RT1_IWA) | (RT2_IWA))
+#define IRQ_COALESCE_MT_BITS    (MT_EOM)
+
+// tick period, us. The 32-entry interrupt log must not wrap between ticks:
+// 32 x 20us, the shortest 1553 message, is 640us.
+#define IRQ_COALESCE_TICK_US    500
+
+// IRQ_COALESCE_AUTO thresholds, messages logged per tick
+#define IRQ_COALESCE_HIGH       4   // at or above: batch servicing
+#define IRQ_COALESCE_LOW        1   // at or below: per-message interrupts
+
+
+//------------------------------------------------------------------------------
+//      Global Function Prototypes
+//------------------------------------------------------------------------------
+
+void Configure_6131_IRQ(void);
+unsigned char Set_6131_IRQ_Callback(unsigned char source, IRQ_6131_CALLBACK callback);
+void Service_6131_IRQ(void);
+void Poll_6131_IRQ(void);
+unsigned short Process_6131_IRQ_Events(unsigned short max_events);
+unsigned short Get_6131_IRQ_History(unsigned char reg_number);
+unsigned char Set_6131_ILog_Handler(unsigned char source, ILOG_6131_HANDLER handler);
+void Reset_6131_ILog(void);
+unsigned short Drain_6131_ILog(void);
+unsigned short Get_6131_ILog_Lost(void);
+void Configure_6131_Coalescing(unsigned char mode, unsigned short tick_us);
+unsigned char Get_6131_Coalescing(void);
+void TC1_IrqHandler(void);
+
+
+// End of File
@@ -56,7 +56,7 @@ void initialize_613x_MT(void) {
     
     
     #if(SMT_ena)
-    volatile unsigned short smt_addr_list[8] = {
+    unsigned short smt_addr_list[8] = {
 
     //  =============  Command Stack ==============
     //  Start     Current   End       Interrupt
@@ -69,7 +69,7 @@ void initialize_613x_MT(void) {
         0x6000,   0x6000,   0x7FFF,   0x7DFF }; // end - 512 
 
     #else // (IMT_ena)
-     volatile unsigned short imt_addr_list[8] = {
+     unsigned short imt_addr_list[8] = {
 
     //  =============  Combined Stack ==============
     //  Start     Current   End       Interrupt
@@ -83,7 +83,7 @@ void initialize_613x_MT(void) {
      
     #endif
 
-    volatile unsigned short mt_filter_table[128] = {
+    unsigned short mt_filter_table[128] = {
 
     // bit = 0: all msgs to that subaddress are recorded, 
     // bit = 1: all messages to that subaddress are ignored.
@@ -494,10 +494,9 @@ void initialize_613x_MT(void) {
         // Initialize MT Filter table in RAM using values in array above.
         // Skip this if all messages shall be recorded (since Master Reset clears RAM) 
 
-        Write_6131LowReg(MAP_1,0x0100,0);	
-        for ( i = 0; i < 128; i++) {	
-            Write_6131_1word(mt_filter_table[i],0);
-        }
+        Write_6131_Block(0x0100, mt_filter_table, 128, 0, 0);
+        // keep its CRCs for the read-back check after initialization
+        Record_6131_Image(0x0100, mt_filter_table, 128, 0);
                     
             
 	// ================== Simple Monitor ======================= 
@@ -507,13 +506,9 @@ void initialize_613x_MT(void) {
             // Initialize base address for MT Address List at 0x00B0  
             Write_6131LowReg(MT_ADDR_LIST_POINTER,0x00B0,0);
 
-            // Load same address to mem address ptr 
-            Write_6131LowReg(MAP_1,0x00B0,0);	
-
             // initialize MT address list using array declared at top of function 
-            for ( i = 0; i < 8; i++) {
-                Write_6131_1word(smt_addr_list[i],0);
-            }
+            Write_6131_Block(0x00B0, smt_addr_list, 8, 0, 0);
+            Record_6131_Image(0x00B0, smt_addr_list, 8, 0);
 
             // Set up SMT interrupts:
             //
@@ -538,7 +533,7 @@ void initialize_613x_MT(void) {
 
             // Optional: assert IMTA bit in the Master Config Reg 0 
             // so the ACTIVE pin reflects MT activity 
-            j = Read_6131LowReg(MASTER_CONFIG_REG, 0);
+            j = Read_6131_MasterConfig(0);
             Write_6131LowReg(MASTER_CONFIG_REG, j|IMTA, 0);
 		
             // Config options for Simple monitor, 
@@ -570,13 +565,9 @@ void initialize_613x_MT(void) {
             // Initialize base address for MT Address List at 0x00B0  
             Write_6131LowReg(MT_ADDR_LIST_POINTER,0x00B0,0);
 
-            // Load same address to mem address ptr 
-            Write_6131LowReg(MAP_1,0x00B0,0);	
-
             // initialize MT address list using array declared at top of function 
-            for ( i = 0; i < 8; i++) {
-		Write_6131_1word(imt_addr_list[i],0);
-            }
+            Write_6131_Block(0x00B0, imt_addr_list, 8, 0, 0);
+            Record_6131_Image(0x00B0, imt_addr_list, 8, 0);
 
             // In addition to these packet size limits, a stack rollover trips packet finalization... 
             Write_6131LowReg(IMT_MAX_1553_MSGS,4545,0); // max possible in 100ms = 4,545
@@ -614,7 +605,7 @@ void initialize_613x_MT(void) {
 
             // Optional: assert IMTA bit in the Master Config Reg 0 
             // so the ACTIVE pin reflects MT activity 
-            j = Read_6131LowReg(MASTER_CONFIG_REG, 0);
+            j = Read_6131_MasterConfig(0);
             Write_6131LowReg(MASTER_CONFIG_REG, j|IMTA, 0);
 		
             // Config options (IMT automatically uses TTAG48) 		 
@@ -59,9 +59,11 @@
 void initialize_613x_RT1(void) {
 	
 
-	unsigned short a, k;
+	unsigned short a;
 
 	unsigned short i,j;
+	SPI_BATCH_OP ops[6];
+	SPI_BATCH batch;
                 
 	unsigned short descr_table_RT1[512] = {
 	/* this array is used to initialize the Descriptor Table. For subaddress-
@@ -630,7 +632,7 @@ void initialize_613x_RT1(void) {
 	    Write_6131LowReg(RT1_CONFIG_REG,i,0);
 
 	    // do not overwrite previously initialized common features 
-	    j = Read_6131LowReg(MASTER_CONFIG_REG,0) & ~(RT1STEX);
+	    j = Read_6131_MasterConfig(0) & ~(RT1STEX);
 	    
 	    // if "bus shutdown" mode codes 4 & 20 disable Tx only but Rx still operates 
             // normally (NOT RECOMMENDED) then OR in BSDTXO, affecting Remote Terminals:
@@ -642,40 +644,38 @@ void initialize_613x_RT1(void) {
 	    // enable RT1 address parity fail interrupt, but not time tag match interrupt 
 	    Write_6131LowReg(HDW_INT_ENABLE_REG,(j|RT1APF),0);
 		
-	    j = Read_6131LowReg(HDW_INT_OUTPUT_ENABLE_REG,0) & ~(RT1TTM);
+	    j = READ_6131_REG(HDW_INT_OUTPUT_ENABLE_REG,0) & ~(RT1TTM);
 	    // enable pin putput for selected interrupts  
 	    Write_6131LowReg(HDW_INT_OUTPUT_ENABLE_REG,(j|RT1APF),0);
 		
-	    j = Read_6131LowReg(RT_INT_ENABLE_REG,0) & 0xFE00;
+	    j = READ_6131_REG(RT_INT_ENABLE_REG,0) & 0xFE00;
 	    // enable RT1 interrupts, but not the Message Error interrupt 
 	    Write_6131LowReg(RT_INT_ENABLE_REG,(j|RT1_IXEQZ|RT1_IWA|RT1_IBR|RT1_MC8),0);
 
 	    // no fast access read for the rest of these registers, but write is okay... 
 	    enaMAP(1);	
-	    Write_6131LowReg(MAP_1, RT_INT_OUTPUT_ENABLE_REG,0);  
-	    j = Read_6131_1word(0) & 0xFE00;
+	    j = READ_6131_REG(RT_INT_OUTPUT_ENABLE_REG, 0) & 0xFE00;
 	    // enable pin output for selected RT1 interrupts 
 	    Write_6131LowReg(RT_INT_OUTPUT_ENABLE_REG,(j|RT1_IXEQZ|RT1_IWA|RT1_IBR|RT1_MC8),0);
-	    Write_6131LowReg(RT1_1553_STATUS_BITS_REG,0x0000,0);	 
-	    Write_6131LowReg(RT1_TTAG_UTILITY_REG,0x0000,0);	 
-	    Write_6131LowReg(RT1_BUSA_SELECT_REG,0xAAAA,0);		 
-	    Write_6131LowReg(RT1_BUSB_SELECT_REG,0xBBBB,0);		 
-	    Write_6131LowReg(RT1_BIT_WORD_REG,0x0000,0);			 
-	    Write_6131LowReg(RT1_ALT_BIT_WORD_REG,0xABCD,0);			 
+	    Init_6131_Batch(&batch, ops, 6);
+	    Batch_6131_WriteReg(&batch, RT1_1553_STATUS_BITS_REG, 0x0000);
+	    Batch_6131_WriteReg(&batch, RT1_TTAG_UTILITY_REG, 0x0000);
+	    Batch_6131_WriteReg(&batch, RT1_BUSA_SELECT_REG, 0xAAAA);
+	    Batch_6131_WriteReg(&batch, RT1_BUSB_SELECT_REG, 0xBBBB);
+	    Batch_6131_WriteReg(&batch, RT1_BIT_WORD_REG, 0x0000);
+	    Batch_6131_WriteReg(&batch, RT1_ALT_BIT_WORD_REG, 0xABCD);
+	    Run_6131_Batch(&batch, 0);
 
 	    // load the RT1 Descriptor Table
 	    // SPI read/writes to RAM use indirect addressing, with the access address 
 	    // indicated by a memory address pointer. The HI-6131 provides 4 separate 
 	    // memory address pointers (MAPs), and the active MAP is enabled by bits 
-	    // 11-10 in the Master Status Register 0x0000. Table initialization below 
-	    // uses MAP auto-increment. Starting at the table base address written above, 
-	    // copy the RT1 Descriptor Table array (declared above) into HI-6131 RAM.   
-            enaMAP(1);
-	    // write address of the RT1 d-table base addr reg to MAP so we can read it		
-	    Write_6131LowReg(MAP_1, RT1_DESC_TBL_BASE_ADDR_REG,0); 
-	    // read base address then write base address to MAP  
-	    a = Read_6131_1word(0);
-	    Write_6131LowReg(MAP_1, a, 0);
+	    // 11-10 in the Master Status Register 0x0000. Write_6131_Block( ) loads 
+	    // MAP3 itself and uses MAP auto-increment. Starting at the table base 
+	    // address read below, copy the RT1 Descriptor Table array (declared above)
+	    // into HI-6131 RAM.   
+	    // read the RT1 d-table base addr reg, MAP1 is still enabled
+	    a = READ_6131_REG(RT1_DESC_TBL_BASE_ADDR_REG, 0);
 
 	    // If using simplified mode command processing (SMCP), the program is only 
 	    // required to initialize Descriptor Word 1 (Control Words) for each mode command 
@@ -685,53 +685,23 @@ void initialize_613x_RT1(void) {
 
 	    #if (USE_SMCP)
 
-		// in subaddress command half of table, every word is written 
-                
-		for ( i=0, j=0; i < 256; i++,j++) {
-                      // MAP does not auto-increment if next address is a
-                      // RT descriptor table Control Word, every 4th word.
-                      // j counts modulo 4
-                      if(j==4) j=0;
-                      // reload MAP every 4th word
-                      if(j==0) Write_6131LowReg(MAP_1, a+i, 0);
-                      k = descr_table_RT1[i];
-		      Write_6131_1word(k, 0);
-		}		                                
-                                
-                // in mode command half of table, just write Control Words, every 4th word
-		for ( i=256,j=0; i<512; i++,j++) {
-                      // MAP does not auto-increment if next address is a
-                      // RT descriptor table Control Word, every 4th word.
-                      // j counts modulo 4
-                      if(j==4) j=0;
-                      if(j==0) {
-                          // reload MAP every 4th word
-                          Write_6131LowReg(MAP_1, a+i, 0);
-                          // write a Control Word, just the host-maintained Control Word bits
-                          k = descr_table_RT1[i] & 0xF000;
-                          Write_6131_1word(k, 0);
-                      }
-                      else Write_6131_1word(0, 0);
-		}		                                
-
-
-	    #else // not using SMCP
-
-		// every word in table is written 
-                
-		for ( i=0, j=0; i < 512; i++,j++) {
-                      // MAP does not auto-increment if next address is a
-                      // RT descriptor table Control Word, every 4th word.
-                      // j counts modulo 4
-                      if(j==4) j=0;
-                      // reload MAP every 4th word
-                      if(j==0) Write_6131LowReg(MAP_1, a+i, 0);
-                      k = descr_table_RT1[i];
-		      Write_6131_1word(k, 0);
-		}		
+		// in subaddress command half of table, every word is written. In mode 
+		// command half of table, just the host-maintained Control Word bits are 
+		// written, every 4th word, other words are written 0x0000
+		for ( i=256; i<512; i++) {
+                      if((i & 0x0003) == 0) descr_table_RT1[i] &= 0xF000;
+                      else descr_table_RT1[i] = 0;
+		}
 
 	    #endif
 
+		// MAP does not auto-increment if next address is a RT descriptor
+		// table Control Word, every 4th word. Block write with dtable = 1 
+		// reloads its MAP at every 4-word boundary
+		Write_6131_Block(a, descr_table_RT1, 512, 1, 0);
+		// keep its CRCs for the read-back check after initialization
+		Record_6131_Image(a, descr_table_RT1, 512, 1);
+
 	    //-----------------------------------------------
 
 	    // If using Illegal Command Detection, now copy the illegalization 
@@ -742,15 +712,9 @@ void initialize_613x_RT1(void) {
 		//-----------------------------------------------
 		// RT1 Illegalization Table 
 
-		// select Memory Address Pointer 
-		enaMAP(1);
-
 		// RT1 table starts at 0x0200 
-		Write_6131LowReg(MAP_1,0x0200,0);	
-
-		for ( i = 0; i < 256; i++) {	
-			Write_6131_1word(illegal_table[i],0);
-		}
+		Write_6131_Block(0x0200, illegal_table, 256, 0, 0);
+		Record_6131_Image(0x0200, illegal_table, 256, 0);
 
 	    #endif // (ILLEGAL_CMD_DETECT)
 
@@ -760,10 +724,11 @@ void initialize_613x_RT1(void) {
 //--------------------------------------------------------------------------------------
 //	This function loads dummy data into the limited set of RT1 transmit buffers 
 //	assigned above during initialization. This is only used for testing.
+//	Returns 'F' if the DMA fill fails, else 'P'.
 //--------------------------------------------------------------------------------------
-void write_dummy_tx_data_RT1(void) {
+unsigned char write_dummy_tx_data_RT1(void) {
 	
-	unsigned short i, j;
+	unsigned short j;
 	unsigned short a_data[32] = {0x0101,0x0202,0x0303,0x0404,0x0505,0x0606,0x0707,0x0808,
 			             0x0909,0x1010,0x1111,0x1212,0x1313,0x1414,0x1515,0x1616,
 				     0x1717,0x1818,0x1919,0x2020,0x2121,0x2222,0x2323,0x2424,
@@ -774,34 +739,23 @@ void write_dummy_tx_data_RT1(void) {
 				     0xF011,0xF012,0xF013,0xF014,0xF015,0xF016,0xF017,0xF018,
 				     0xF019,0xF01A,0xF01B,0xF01C,0xF01D,0xF01E,0xF01F,0xF020};
 
+	// safety pad after the circular mode 1 buffer, the circular mode 2 buffer 
+	// with incrementing data, and the buffer for unimplemented transmit SA's
+	static const FILL_RANGE fills[3] = {
+		{ 0x1A16, 32, 0xBADD, FILL_VALUE },
+		{ 0x1E00, 8192, 0x0000, FILL_INCREMENT },
+		{ (0x1A58 + 2), 32, 0xDEAD, FILL_VALUE }
+	};
+
 		// FOR TESTING PING-PONG, A PAIR OF DPA/DPB Tx BUFFERS: EACH BUFFER RESERVES
                 // SPACE FOR MSG INFO WORD AND TIME TAG WORD, PLUS 32 DATA WORDS 
 	
-		// first a 32-word buffer starting at offset = 0x0866.
-                enaMAP(1);
-		// Init the memory address pointer, skip over 2 addresses 
+		// first a 32-word buffer starting at offset = 0x0866. Skip over 2 addresses 
 		// reserved for the MsgInfo Word and the TimeTag word 
-		Write_6131LowReg(MAP_1,(0x0866 + 2),0);
-
-		// write the 32 data words...
-		for ( i = 0; i < 32; i++) {	
-			// memory address pointer increments after write
-			Write_6131_1word(a_data[i],0);
-		}
-		
+		Write_6131_Block((0x0866 + 2), a_data, 32, 0, 0);
 
 		// next a 32-word buffer starting at offset = 0x0888 
-
-		// Init the memory address pointer, skip over 2 addresses 
-		// reserved for the MsgInfo Word and the TimeTag word 
-		Write_6131LowReg(MAP_1,(0x0888 + 2),0);
-
-		// write the 32 data words...
-		for ( i = 0; i < 32; i++) {	
-			// memory address pointer increments after write
-			Write_6131_1word(b_data[i],0);
-		}
-		
+		Write_6131_Block((0x0888 + 2), b_data, 32, 0, 0);
 
 		// ================================================================================= 
 
@@ -811,20 +765,12 @@ void write_dummy_tx_data_RT1(void) {
 		// total 1088-word buffer starting at offset = 0x0D32 
 		// this is 32 contiguous segments of 34 words each, 
 
-		// Init the memory address pointer to buffer start address 
-		Write_6131LowReg(MAP_1, 0x0D32, 0);
-
 		for ( j = 0; j < 32; j++) {
 
-			// skip 2 addresses at top of each 32-word segment, 
-			// reserved for each message's MsgInfo and TimeTag words 
-			SPIopcode(MAPadd2); 
-
-			// write 32 data words for each message...					
-			for ( i = 0; i < 32; i++) {	
-				// memory address pointer increments after write
-				Write_6131_1word(b_data[i],0);
-			}
+			// skip 2 addresses at top of each 34-word segment, reserved 
+			// for each message's MsgInfo and TimeTag words, then write 
+			// 32 data words for each message
+			Write_6131_Block(0x0D32 + (j * 34) + 2, b_data, 32, 0, 0);
 		}
 
 		// ================================================================================= 
@@ -835,57 +781,34 @@ void write_dummy_tx_data_RT1(void) {
 		// total 1088-word buffer starting at offset = 0x15D6 
 		// this is 32 contiguous segments of 34 words each, 
 
-		// Init the memory address pointer to buffer start address 
-		Write_6131LowReg(MAP_1,0x15D6,0);
-
 		for ( j = 0; j < 32; j++) {
 
-			// skip 2 addresses at top of each 32-word segment, 
-			// reserved for each message's MsgInfo and TimeTag words 
-			SPIopcode(MAPadd2); 
-
-			// write 32 data words for each message...					
-			for ( i = 0; i < 32; i++) {	
-				// memory address pointer increments after write
-				Write_6131_1word(a_data[i],0);
-			}
+			// skip 2 addresses at top of each 34-word segment, reserved 
+			// for each message's MsgInfo and TimeTag words, then write 
+			// 32 data words for each message
+			Write_6131_Block(0x15D6 + (j * 34) + 2, a_data, 32, 0, 0);
 		}
 
-		// reserve a 32-word safety pad in case of circ-1 buffer overrun
-		for ( i = 0; i < 32; i++) {	
-			// memory address pointer increments after write
-			Write_6131_1word(0xBADD,0);
-		}
-		
+		// reserve a 32-word safety pad in case of circ-1 buffer overrun, 
+		// written with 0xBADD by fills[0] below
 
 		// ================================================================================= 
 	
 		// FOR TESTING CIRCULAR MODE 2, A CONTIGUOUS 32 X 32-WORD DATA BLOCK 
 	
 		// total 8192-word buffer with offset range from 0x1E00 to 0x3DFF.
-		// Init the memory address pointer to buffer start address  
-		Write_6131LowReg(MAP_1,0x1E00,0);
-
-		// write the 8192 data words using incrementing data pattern...
-		for ( i = 0, j = 0; i < 8192; i++, j++) {
-			// memory address pointer increments after write
-			Write_6131_1word(j,0);
-		}
+		// write the 8192 data words using incrementing data pattern. The
+		// safety pad above and the unimplemented SA buffer below are filled 
+		// by the same DMA call
+		if(Fill_6131_Ranges(fills, 3, 0) != 'P') return ('F');
 	
 		// ================================================================================= 
 
 		// for unimplemented transmit SA's. a 32-word buffer starting at offset 
-		// of 0x1A58. Init the memory address pointer, skipping over 2 addresses 
-		// reserved for the MsgInfo Word and the TimeTag word 
-		Write_6131LowReg(MAP_1,(0x1A58 + 2),0);
-
-		// write the 32 data words...
-		for ( i = 0; i < 32; i++) {	
-			// memory address pointer increments after write
-			Write_6131_1word(0xDEAD,0);
-		}
+		// of 0x1A58, skipping over 2 addresses reserved for the MsgInfo Word 
+		// and the TimeTag word, written with 0xDEAD by fills[2] above
 
-	return;
+	return ('P');
 
 }	// end write_dummy_tx_data_RT1()
 
@@ -910,9 +833,11 @@ void write_dummy_tx_data_RT1(void) {
 //
 void initialize_613x_RT2(void) {
 	        
-	unsigned short a,k;
+	unsigned short a;
 
 	unsigned short i,j;
+	SPI_BATCH_OP ops[6];
+	SPI_BATCH batch;
         
 	unsigned short descr_table_RT2[512] = {
 	/* this array is used to initialize the Descriptor Table. For subaddress-
@@ -1481,7 +1406,7 @@ void initialize_613x_RT2(void) {
 	    Write_6131LowReg(RT2_CONFIG_REG,i,0);
 
 	    // do not overwrite previously initialized common features 
-	    j = Read_6131LowReg(MASTER_CONFIG_REG,0) & ~(RT2STEX);
+	    j = Read_6131_MasterConfig(0) & ~(RT2STEX);
 	    
 	    // if "bus shutdown" mode codes 4 & 20 disable Tx only but Rx still operates 
             // normally (NOT RECOMMENDED) then OR in BSDTXO, affecting Remote Terminals:
@@ -1493,41 +1418,40 @@ void initialize_613x_RT2(void) {
 	    // enable RT2 address parity fail interrupt, but not time tag match interrupt 
 	    Write_6131LowReg(HDW_INT_ENABLE_REG,(j|RT2APF),0);
 		
-	    j = Read_6131LowReg(HDW_INT_OUTPUT_ENABLE_REG,0) & ~(RT2TTM);
+	    j = READ_6131_REG(HDW_INT_OUTPUT_ENABLE_REG,0) & ~(RT2TTM);
 	    // enable pin putput for selected interrupts  
 	    Write_6131LowReg(HDW_INT_OUTPUT_ENABLE_REG,(j|RT2APF),0);
 		
-	    j = Read_6131LowReg(RT_INT_ENABLE_REG,0) & 0xFE00;
+	    // keep RT1 bits 8-0
+	    j = READ_6131_REG(RT_INT_ENABLE_REG,0) & 0x01FF;
 	    // enable RT2 interrupts, but not the Message Error interrupt 
 	    Write_6131LowReg(RT_INT_ENABLE_REG,(j|RT2_IXEQZ|RT2_IWA|RT2_IBR|RT2_MC8),0);
 
 	    // no fast access read for the rest of these registers, but write is okay... 
 	    enaMAP(1);	
-	    Write_6131LowReg(MAP_1, RT_INT_OUTPUT_ENABLE_REG,0);  
-	    j = Read_6131_1word(0) & 0xFE00;
+	    j = READ_6131_REG(RT_INT_OUTPUT_ENABLE_REG, 0) & 0x01FF;
 	    // enable pin output for selected RT2 interrupts 
 	    Write_6131LowReg(RT_INT_OUTPUT_ENABLE_REG,(j|RT2_IXEQZ|RT2_IWA|RT2_IBR|RT2_MC8),0);
-	    Write_6131LowReg(RT2_1553_STATUS_BITS_REG,0x0000,0);	 
-	    Write_6131LowReg(RT2_TTAG_UTILITY_REG,0x0000,0);	 
-	    Write_6131LowReg(RT2_BUSA_SELECT_REG,0xAAAA,0);		 
-	    Write_6131LowReg(RT2_BUSB_SELECT_REG,0xBBBB,0);		 
-	    Write_6131LowReg(RT2_BIT_WORD_REG,0x0000,0);			 
-	    Write_6131LowReg(RT2_ALT_BIT_WORD_REG,0xABCD,0);			 
+	    Init_6131_Batch(&batch, ops, 6);
+	    Batch_6131_WriteReg(&batch, RT2_1553_STATUS_BITS_REG, 0x0000);
+	    Batch_6131_WriteReg(&batch, RT2_TTAG_UTILITY_REG, 0x0000);
+	    Batch_6131_WriteReg(&batch, RT2_BUSA_SELECT_REG, 0xAAAA);
+	    Batch_6131_WriteReg(&batch, RT2_BUSB_SELECT_REG, 0xBBBB);
+	    Batch_6131_WriteReg(&batch, RT2_BIT_WORD_REG, 0x0000);
+	    Batch_6131_WriteReg(&batch, RT2_ALT_BIT_WORD_REG, 0xABCD);
+	    Run_6131_Batch(&batch, 0);
 
 	    // load the RT2 Descriptor Table
 	    // SPI read/writes to RAM use indirect addressing, with the access address 
 	    // indicated by a memory address pointer. The HI-6131 provides 4 separate 
 	    // memory address pointers (MAPs), and the active MAP is enabled by bits 
-	    // 11-10 in the Master Status Register 0x0000. Table initialization below 
-	    // uses MAP auto-increment. Starting at the table base address written above, 
-	    // copy the RT2 Descriptor Table array (declared above) into HI-6131 RAM.   
-
-            enaMAP(1);
-	    // write address of the RT2 d-table base addr reg to MAP so we can read it		
-	    Write_6131LowReg(MAP_1, RT2_DESC_TBL_BASE_ADDR_REG,0); 
-	    // read base address then write base address to MAP  
-	    a = Read_6131_1word(0);
-	    Write_6131LowReg(MAP_1, a, 0);
+	    // 11-10 in the Master Status Register 0x0000. Write_6131_Block( ) loads 
+	    // MAP3 itself and uses MAP auto-increment. Starting at the table base 
+	    // address read below, copy the RT2 Descriptor Table array (declared above)
+	    // into HI-6131 RAM.   
+
+	    // read the RT2 d-table base addr reg, MAP1 is still enabled
+	    a = READ_6131_REG(RT2_DESC_TBL_BASE_ADDR_REG, 0);
                                                            
 	    // If using simplified mode command processing (SMCP), the program is only 
 	    // required to initialize Descriptor Word 1 (Control Words) for each mode command 
@@ -1537,52 +1461,22 @@ void initialize_613x_RT2(void) {
 
 	    #if (USE_SMCP)
 
-		// in subaddress command half of table, every word is written 
-                
-		for ( i=0, j=0; i < 256; i++,j++) {
-                      // MAP does not auto-increment if next address is a
-                      // RT descriptor table Control Word, every 4th word.
-                      // j counts modulo 4
-                      if(j==4) j=0;
-                      // reload MAP every 4th word
-                      if(j==0) Write_6131LowReg(MAP_1, a+i, 0);
-                      k = descr_table_RT2[i];
-		      Write_6131_1word(k, 0);
-		}		                                
-                                
-                // in mode command half of table, just write Control Words, every 4th word
-		for ( i=256,j=0; i<512; i++,j++) {
-                      // MAP does not auto-increment if next address is a
-                      // RT descriptor table Control Word, every 4th word.
-                      // j counts modulo 4
-                      if(j==4) j=0;
-                      if(j==0) {
-                          // reload MAP every 4th word
-                          Write_6131LowReg(MAP_1, a+i, 0);
-                          // write a Control Word, just the host-maintained Control Word bits
-                          k = descr_table_RT2[i] & 0xF000;
-                          Write_6131_1word(k, 0);
-                      }
-                      else Write_6131_1word(0, 0);
-		}		                                
-
-
-	    #else // not using SMCP
-
-		// every word in table is written 
-                
-		for ( i=0, j=0; i < 512; i++,j++) {
-                      // MAP does not auto-increment if next address is a
-                      // RT descriptor table Control Word, every 4th word.
-                      // j counts modulo 4
-                      if(j==4) j=0;
-                      // reload MAP every 4th word
-                      if(j==0) Write_6131LowReg(MAP_1, a+i, 0);
-                      k = descr_table_RT2[i];
-		      Write_6131_1word(k, 0);
-		}		
+		// in subaddress command half of table, every word is written. In mode 
+		// command half of table, just the host-maintained Control Word bits are 
+		// written, every 4th word, other words are written 0x0000
+		for ( i=256; i<512; i++) {
+                      if((i & 0x0003) == 0) descr_table_RT2[i] &= 0xF000;
+                      else descr_table_RT2[i] = 0;
+		}
 
 	    #endif
+
+		// MAP does not auto-increment if next address is a RT descriptor
+		// table Control Word, every 4th word. Block write with dtable = 1 
+		// reloads its MAP at every 4-word boundary
+		Write_6131_Block(a, descr_table_RT2, 512, 1, 0);
+		// keep its CRCs for the read-back check after initialization
+		Record_6131_Image(a, descr_table_RT2, 512, 1);
 	    //-----------------------------------------------
 
 	    // If using Illegal Command Detection, now copy the illegalization 
@@ -1593,15 +1487,9 @@ void initialize_613x_RT2(void) {
 		//-----------------------------------------------
 		// RT2 Illegalization Table 
 
-		// select Memory Address Pointer 
-		enaMAP(1);
-
 		// RT2 table starts at 0x0300 
-		Write_6131LowReg(MAP_1,0x0300,0);	
-
-		for ( i = 0; i < 256; i++) {	
-			Write_6131_1word(illegal_table[i],0);
-		}
+		Write_6131_Block(0x0300, illegal_table, 256, 0, 0);
+		Record_6131_Image(0x0300, illegal_table, 256, 0);
 
 	    #endif // (ILLEGAL_CMD_DETECT)
 
@@ -1614,12 +1502,13 @@ void initialize_613x_RT2(void) {
 
 // 	This function loads dummy data into the limited set of RT2 transmit buffers 
 //	assigned above during initialization. This is only used for testing.
+//	Returns 'F' if the DMA fill fails, else 'P'.
  
-void write_dummy_tx_data_RT2(void) {
+unsigned char write_dummy_tx_data_RT2(void) {
 	
-	unsigned short i, j;
+	unsigned short j;
 	unsigned short a_data[32] = {0x0101,0x0202,0x0303,0x0404,0x0505,0x0606,0x0707,0x0808,
-				     0x0909,0x1010,0x1111,0x1212,0x1313,0x1414,0x1515,0x1616,
+			             0x0909,0x1010,0x1111,0x1212,0x1313,0x1414,0x1515,0x1616,
 				     0x1717,0x1818,0x1919,0x2020,0x2121,0x2222,0x2323,0x2424,
 				     0x2525,0x2626,0x2727,0x2828,0x2929,0x3030,0x3131,0x3232};
 
@@ -1628,37 +1517,25 @@ void write_dummy_tx_data_RT2(void) {
 				     0xF011,0xF012,0xF013,0xF014,0xF015,0xF016,0xF017,0xF018,
 				     0xF019,0xF01A,0xF01B,0xF01C,0xF01D,0xF01E,0xF01F,0xF020};
 
+	// safety pad after the circular mode 1 buffer, the circular mode 2 buffer 
+	// with incrementing data, and the buffer for unimplemented transmit SA's
+	static const FILL_RANGE fills[3] = {
+		{ 0x5216, 32, 0xBADD, FILL_VALUE },
+		{ 0x5600, 8192, 0x0000, FILL_INCREMENT },
+		{ (0x5258 + 2), 32, 0xDEAD, FILL_VALUE }
+	};
+
 		// FOR TESTING PING-PONG, A PAIR OF DPA/DPB Tx BUFFERS: EACH BUFFER RESERVES
                 // SPACE FOR MSG INFO WORD AND TIME TAG WORD, PLUS 32 DATA WORDS 
 	
-		// first a 32-word buffer starting at offset = 0x4066.
-                enaMAP(1);
-
-		// Init the memory address pointer, skip over 2 addresses 
+		// first a 32-word buffer starting at offset = 0x4066. Skip over 2 addresses 
 		// reserved for the MsgInfo Word and the TimeTag word 
-		Write_6131LowReg(MAP_1,(0x4066 + 2),0);
-
-		// write the 32 data words...
-		for ( i = 0; i < 32; i++) {	
-			// memory address pointer increments after write
-			Write_6131_1word(a_data[i],0);
-		}
-		
+		Write_6131_Block((0x4066 + 2), a_data, 32, 0, 0);
 
 		// next a 32-word buffer starting at offset = 0x4088 
+		Write_6131_Block((0x4088 + 2), b_data, 32, 0, 0);
 
-		// Init the memory address pointer, skip over 2 addresses 
-		// reserved for the MsgInfo Word and the TimeTag word
-		Write_6131LowReg(MAP_1,(0x4088 + 2),0);
-
-		// write the 32 data words...
-		for ( i = 0; i < 32; i++) {	
-			// memory address pointer increments after write
-			Write_6131_1word(b_data[i],0);
-		}
-		
-
-		// =================================================================================
+		// ================================================================================= 
 
 		// FOR TESTING INDEXED MODE, A BUFFER THAT HOLDS 32 32-WORD MESSAGES,
 		// REQUIRING INTERLACED MSG INFO AND TIME TAG WORDS FOR EACH MESSAGE 
@@ -1666,80 +1543,50 @@ void write_dummy_tx_data_RT2(void) {
 		// total 1088-word buffer starting at offset = 0x4532 
 		// this is 32 contiguous segments of 34 words each, 
 
-		// Init the memory address pointer to buffer start address
-		Write_6131LowReg(MAP_1,(0x4532),0);
-
 		for ( j = 0; j < 32; j++) {
 
-			// skip 2 addresses at top of each 32-word segment, 
-			// reserved for each message's MsgInfo and TimeTag words
-			SPIopcode(MAPadd2); 
-
-			// write 32 data words for each message...					
-			for ( i = 0; i < 32; i++) {	
-				// memory address pointer increments after write
-				Write_6131_1word(b_data[i],0);
-			}
+			// skip 2 addresses at top of each 34-word segment, reserved 
+			// for each message's MsgInfo and TimeTag words, then write 
+			// 32 data words for each message
+			Write_6131_Block(0x4532 + (j * 34) + 2, b_data, 32, 0, 0);
 		}
 
 		// ================================================================================= 
 
 		// FOR TESTING CIRCULAR MODE 1, A BUFFER THAT HOLDS 32 32-WORD MESSAGES,
-		// REQUIRING INTERLACED MSG INFO AND TIME TAG WORDS FOR EACH MESSAGE 
+		// REQUIRING INTERLACED MSG INFO AND TIME TAG WORDS FOR EACH MESSAGE  
 
 		// total 1088-word buffer starting at offset = 0x4DD6 
 		// this is 32 contiguous segments of 34 words each, 
 
-		// Init the memory address pointer to buffer start address
-		Write_6131LowReg(MAP_1,0x4DD6,0);
-
 		for ( j = 0; j < 32; j++) {
 
-			// skip 2 addresses at top of each 32-word segment, 
-			// reserved for each message's MsgInfo and TimeTag words 
-			SPIopcode(MAPadd2); 
-
-			// write 32 data words for each message...					
-			for ( i = 0; i < 32; i++) {	
-				// memory address pointer increments after write
-				Write_6131_1word(a_data[i],0);
-			}
+			// skip 2 addresses at top of each 34-word segment, reserved 
+			// for each message's MsgInfo and TimeTag words, then write 
+			// 32 data words for each message
+			Write_6131_Block(0x4DD6 + (j * 34) + 2, a_data, 32, 0, 0);
 		}
 
-		// reserve a 32-word safety pad in case of circ-1 buffer overrun
-		for ( i = 0; i < 32; i++) {	
-			// memory address pointer increments after write
-			Write_6131_1word(0xBADD,0);
-		}
-		
+		// reserve a 32-word safety pad in case of circ-1 buffer overrun, 
+		// written with 0xBADD by fills[0] below
 
-		// =================================================================================
+		// ================================================================================= 
 	
 		// FOR TESTING CIRCULAR MODE 2, A CONTIGUOUS 32 X 32-WORD DATA BLOCK 
 	
 		// total 8192-word buffer with offset range from 0x5600 to 0x75FF.
-		// Init the memory address pointer to buffer start address 
-		Write_6131LowReg(MAP_1,0x5600,0);
-
-		// write the 8192 data words using incrementing data pattern...
-		for ( i = 0, j = 0; i < 8192; i++, j++) {
-			// memory address pointer increments after write
-			Write_6131_1word(j,0);
-		}
+		// write the 8192 data words using incrementing data pattern. The
+		// safety pad above and the unimplemented SA buffer below are filled 
+		// by the same DMA call
+		if(Fill_6131_Ranges(fills, 3, 0) != 'P') return ('F');
 	
 		// ================================================================================= 
 
 		// for unimplemented transmit SA's. a 32-word buffer starting at offset 
-		// of 0x5258. Init the memory address pointer, skipping over 2 addresses 
-		// reserved for the MsgInfo Word and the TimeTag word 
-		Write_6131LowReg(MAP_1,(0x5258 + 2),0);
+		// of 0x5258, skipping over 2 addresses reserved for the MsgInfo Word 
+		// and the TimeTag word, written with 0xDEAD by fills[2] above
 
-		// write the 32 data words...
-		for ( i = 0; i < 32; i++) {	
-			// memory address pointer increments after write
-			Write_6131_1word(0xDEAD,0);
-		}
-		
+	return ('P');
 
 }	// end write_dummy_tx_data_RT2()
 
@@ -1847,18 +1694,18 @@ void RTstatusUpdate(void) {
         const Pin pinRT2BSY  = PIN_RT2BSY;        
 
 	///#if (!HOST_BUS_INTERFACE) // Host_SPI_Interface
-            unsigned char savemap;
+            SPI_BATCH_OP ops[3];
+            SPI_BATCH batch;
 
 	    // no fast access read for these registers, but write is okay...
             __disable_interrupt();
-            // we will restore the active MAP when finished
-            savemap = (char)(getMAPaddr() - 0x000A);
-            // use MAP3 
-            enaMAP(3);
-            Write_6131LowReg(MAP_3, RT1_1553_STATUS_BITS_REG,0);  
-	    out_rt1 = Read_6131_1word(0) & ~(BUSY|TERMFLAG);
-	    Write_6131LowReg(MAP_3, RT2_1553_STATUS_BITS_REG,0);  
-	    out_rt2 = Read_6131_1word(0) & ~(BUSY|TERMFLAG);     
+            // read both through MAP3 in one batch, the active MAP is restored
+            Init_6131_Batch(&batch, ops, 3);
+            Batch_6131_Read(&batch, RT1_1553_STATUS_BITS_REG, &out_rt1, 1);
+            Batch_6131_Read(&batch, RT2_1553_STATUS_BITS_REG, &out_rt2, 1);
+            Run_6131_Batch(&batch, 0);
+	    out_rt1 &= ~(BUSY|TERMFLAG);
+	    out_rt2 &= ~(BUSY|TERMFLAG);     
 	// set BUSY status bit if "BUSYBIT" switch is high, else reset bit.	        
         if(PIO_Get(&pinRT1BSY)) out_rt1 |= BUSY;
         if(PIO_Get(&pinRT2BSY)) out_rt2 |= BUSY;
@@ -1866,10 +1713,10 @@ void RTstatusUpdate(void) {
 	if(PIO_Get(&pinRT1TFLG)) out_rt1 |= TERMFLAG;
 	if(PIO_Get(&pinRT2TFLG)) out_rt2 |= TERMFLAG;
 	    // fast access write is okay...
-	Write_6131LowReg(RT1_1553_STATUS_BITS_REG,out_rt1,0);
-	Write_6131LowReg(RT2_1553_STATUS_BITS_REG,out_rt2,0);
-	    // restore original MAP
-	enaMAP(savemap);        
+	Init_6131_Batch(&batch, ops, 2);
+	Batch_6131_WriteReg(&batch, RT1_1553_STATUS_BITS_REG, out_rt1);
+	Batch_6131_WriteReg(&batch, RT2_1553_STATUS_BITS_REG, out_rt2);
+	Run_6131_Batch(&batch, 0);
 	__enable_interrupt();
 	//#endif      
         
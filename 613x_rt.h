@@ -393,9 +393,10 @@ void modify_RT_status_bits(void);
 
 // 	These functions load dummy data into the limited set of RT1 or RT2 transmit
 //	buffers assigned above during initialization. This is only used for testing.
+//	Returns 'F' if the DMA fill fails, else 'P'.
 // 
-void write_dummy_tx_data_RT1(void);
-void write_dummy_tx_data_RT2(void);
+unsigned char write_dummy_tx_data_RT1(void);
+unsigned char write_dummy_tx_data_RT2(void);
 
 
 //	This function reads BUSY and TFLAG DIP switch settings then updates HI-613x 
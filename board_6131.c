@@ -44,19 +44,62 @@
 //	Write_6131_Buffer( ) writes N words to sequential register or RAM locations
 //	Read_6131_Buffer( ) reads N words from sequential register or RAM locations
 //
+//	Write_6131_Block( ) writes N words from caller array to a specified start address
+//	Read_6131_Block( ) reads N words from a specified start address into caller array
+//
+//	Enter_6131_ISR( ) / Exit_6131_ISR( ) bracket HI-6131 accesses by interrupt service routines
+//
+//	Read_6131_MasterConfig( ) returns Master Config register 0 from the host shadow copy
+//	Invalidate_6131_MasterConfig( ) forces the next shadow read to come from the device
+//
+//	Set_6131_SPI_Timing( ) changes SPI clock and delay settings for the HI-6131
+//	Get_6131_SPI_Timing( ) returns the SPI clock and delay settings
+//	Tune_6131_SPI_Timing( ) selects the fastest reliable SPI settings by RAM readback
+//
 //	Read_Current_Control_Word( ) returns descriptor Control Word for the current/last command
 //	Read_This_Control_Word() returns a specified descriptor Control Word
 //	ReadWord_Adv4( ) returns data addressed by Memory Address Pointer, then adds 4 to ptr
 //	Read_Last_IIW( ) returns the last Interrupt Information Word written to log buffer
+//	Read_6131_IntRegs( ) reads pending, enable and output enable interrupt regs by MAP bursts
+//	Read_6131_MAP( ) reads N words into caller array through the enabled MAP, for ISRs
+//	Read_6131_Reg( ) / Write_6131_Reg( ) access one register or RAM word through the enabled MAP
+//	READ_6131_REG( ) / WRITE_6131_REG( ) macros pick fast access or MAP by register address
 //	Increase_Mem_Ptr( ) adds 1,2, or 4 to current Memory Address Pointer value in reg 15
 //
 //	Special Complex Functions
 //	=========================
 //	Fill_6131RAM_Offset( ) writes each RAM address with its address/offset value
 //	Fill_6131RAM( ) writes a specified range of addresses with a fixed value
+//	Fill_6131_Ranges( ) fills several RAM ranges with a value or incrementing pattern by DMA
 //	mem_dump( ) copies a 256-word block from HI-6131 reg/RAM to processor internal RAM
 //	spi_demo( ) demonstrates various SPI function calls
 //
+//	DMA Burst Engine
+//	================
+//	Configure_6131_DMA( ) enables the DMA controller channels used for SPI bursts
+//	Start_6131_Burst( ) starts a DMA-driven N-word read, write or fill, returns immediately
+//	Wait_6131_Burst( ) waits for a started burst to complete
+//	Read_6131_Burst( ) / Write_6131_Burst( ) blocking N-word burst into/from caller buffer
+//
+//	SPI Transaction Trace
+//	=====================
+//	Start_6131_Trace( ) / Stop_6131_Trace( ) record every op code in a RAM ring (SPI_TRACE = YES)
+//	Get_6131_Trace( ) copies the recorded op codes, oldest first
+//	Dump_6131_Trace( ) prints the ring on the console, as text or a binary stream
+//
+//	SPI Transaction Batch
+//	=====================
+//	Init_6131_Batch( ) starts an empty list of SPI ops in a caller array
+//	Batch_6131_Opcode( ) / _WriteReg( ) / _ReadReg( ) / _Read( ) / _Write( ) append one op
+//	Run_6131_Batch( ) performs every op in the list back to back
+//
+//	RAM Image Verification
+//	======================
+//	Crc_6131( ) table-driven CRC-16 over 16-bit words
+//	Reset_6131_Verify( ) forgets all recorded RAM images
+//	Record_6131_Image( ) keeps block CRCs of a table written to HI-6131 RAM
+//	Verify_6131_Images( ) reads back every recorded table, returns first bad block address
+//
 
 
 //------------------------------------------------------------------------------
@@ -64,17 +107,44 @@
 //------------------------------------------------------------------------------
 #include <pio/pio.h>
 #include <spi/spi.h>
+#include <pmc/pmc.h>
+#include <irq/irq.h>
 #include <intrinsics.h>
 #include "613x_initialization.h"
 #include "board_6131.h"
 #include "device_6131.h"
+#include "console.h"
 #include <stdio.h>
+#if (HOST_MODEL == YES)
+#include "hi6131_sim.h"
+#endif
 
 //------------------------------------------------------------------------------
 //         Defines
 //------------------------------------------------------------------------------
 
-// none  
+// Master Configuration register BC start bit, see BCSTRT in 613x_regs.h
+#define MCFG_BCSTRT         (1 << 13)
+
+// SPI chip select register BITS field for 16-bit transfers
+#define SPI_CSR_BITS16      (8 << 4)
+
+// DMAC channel register fields used by the burst engine
+#define DMA_CTRLA_HALFWORD  ((1 << 24) | (1 << 28))     // SRC_WIDTH = DST_WIDTH = half-word
+#define DMA_CTRLB_TX        ((1 << 16) | (1 << 20) |    /* no descriptor fetch           */ \
+                             (1 << 21) | (2 << 28))     // mem-to-periph, dest fixed, src incr
+#define DMA_CTRLB_TX_FIXED  ((1 << 16) | (1 << 20) |    /* no descriptor fetch           */ \
+                             (1 << 21) | (2 << 24) |    /* mem-to-periph, src fixed      */ \
+                             (2 << 28))                 // dest fixed
+#define DMA_CTRLB_RX        ((1 << 16) | (1 << 20) |    /* no descriptor fetch           */ \
+                             (2 << 21) | (2 << 24))     // periph-to-mem, src fixed, dest incr
+#define DMA_CFG_TX          ((BOARD_6131_DMA_TX_PER << 4) | (1 << 13) | (1 << 24))  // DST_PER, DST_H2SEL hardware
+#define DMA_CFG_RX          ((BOARD_6131_DMA_RX_PER << 0) | (1 << 9)  | (1 << 24))  // SRC_PER, SRC_H2SEL hardware
+
+// non-zero if a BATCH_READ or BATCH_WRITE op goes by DMA burst
+#define BATCH_BY_DMA(op, irq_mgmt) \
+    ((irq_mgmt) && (((op)->type == BATCH_READ) || ((op)->type == BATCH_WRITE)) && \
+     ((op)->count >= BATCH_DMA_WORDS))
 
 //------------------------------------------------------------------------------
 //         Local variables
@@ -86,23 +156,396 @@ static const Pin pinsSPI[]  = {BOARD_6131_SPI_PINS, BOARD_6131_NPCS_PIN};
 // HI-6131 /CS pin
 //static const Pin pinNss[]  = {BOARD_6131_NPCS_PIN};
 
+// SPI chip select register value written by Configure_ARM_MCU_SPI( ), 8-bit transfers
+static unsigned int spi_csr;
+
+// SPI settings tried by Tune_6131_SPI_Timing( ), fastest first: SCBR, DLYBS, DLYBCT.
+// SCK never exceeds the 16MHz the HI-6131 SPI is specified for; at that clock
+// only the delays are shortened, a read-back pass shows no margin beyond it.
+static const unsigned char tune_timing[][3] = {
+    {  3,  0, 0 },  // 16MHz, minimum delays
+    {  3,  6, 0 },
+    {  3, 12, 0 },
+    {  3, 12, 1 },  // Configure_ARM_MCU_SPI( ) default
+    {  4, 12, 1 },  // 12MHz
+    {  6, 12, 1 },  //  8MHz
+    { 12, 12, 1 }   //  4MHz
+};
+// calibration pattern, words read back, and the saved calibration RAM range
+static unsigned short tune_buf[TUNE_RAM_WORDS];
+static unsigned short tune_read[TUNE_RAM_WORDS];
+static unsigned short tune_save[TUNE_RAM_WORDS];
+
+// Host copy of Master Configuration register 0, which only the host writes. MAP
+// selection and terminal enable bits are read from here instead of the device.
+// Kept by Write_6131LowReg( ), Read_6131LowReg( ) and every MAP enable op code;
+// invalid until first read after reset. BC start bit is a strobe, never kept.
+static unsigned short mcfg_shadow;
+static unsigned char mcfg_valid;
+
+// DMA burst engine state. The active burst is advanced one segment at a time,
+// a segment being the words moved under one MAP load and one op code
+static SPI_BURST *burst_active;
+static unsigned short burst_addr, burst_left, burst_seg;
+static unsigned short *burst_ptr;
+static unsigned char burst_savemap;
+// non-zero while the burst engine sends its own MAP load and op code, which
+// spi_start( ) must not hold up
+static unsigned char burst_spi;
+// advances the running burst, used by spi_dma_wait( ) before its definition
+static void burst_service(void);
+#if (HOST_MODEL != YES)
+// transmitted while receiving, read bursts
+static unsigned short burst_dummy = 0;
+#endif
+
+// Fill_6131_Ranges( ) pattern buffers, one is built while DMA writes the other
+static unsigned short fill_buf[2][FILL_CHUNK];
+
+// CRC-16-CCITT table for Crc_6131( ), polynomial 0x1021
+static const unsigned short crc_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+#if (RAM_VERIFY == YES)
+// RAM images recorded by Record_6131_Image( ). Each image's block CRCs are
+// kept in verify_crc[ ] starting at index first
+static struct {
+    unsigned short address;
+    unsigned short count;
+    unsigned short first;
+    unsigned char  dtable;
+} verify_region[VERIFY_REGIONS];
+static unsigned short verify_crc[VERIFY_CRCS];
+static unsigned short verify_buf[VERIFY_CHUNK];
+static unsigned char verify_regions, verify_overflow;
+static unsigned short verify_crcs;
+#endif
+
 //------------------------------------------------------------------------------
 //         Global Variables
 //------------------------------------------------------------------------------
 
-
+// Interrupted transfer handshake, managed by the functions in this file. spi_busy is 
+// non-zero while a foreground multi-word transfer holds chip select between words. 
+// Enter_6131_ISR( ) then negates chip select and sets spi_irq, and the transfer 
+// re-asserts chip select and sends its op code again before the next word.
 unsigned char spi_busy, spi_irq;
 
+// non-zero while a DMA burst owns the SPI. SPI-using interrupt routines
+// must not access the HI-6131 while this is set; foreground accesses wait.
+volatile unsigned char spi_dma_busy;
+
 //	Array for storing 16-bit words read from HI-6131 RAM or registers. Several functions 
 //	below read data from one or more sequential addresses. The reserved array size in 
 //	this declaration can be adjusted to match project requirements. 
 unsigned short read_data[256]; 
 
+#if (SPI_TRACE == YES)
+//------------------------------------------------------------------------------
+//         SPI Transaction Trace
+//------------------------------------------------------------------------------
+
+// Trace ring written by spi_start( ) and spi_stop( ) while trace_on is set. One record
+// per op code; trace_head is the record being written, trace_total counts records.
+static SPI_TRACE_REC spi_trace[SPI_TRACE_SIZE];
+static unsigned short trace_head;
+static unsigned long trace_total;
+static unsigned char trace_on, trace_open, trace_isr;
+// host's idea of each MAP's value: last address loaded, advanced by 0x40/0xC0 words
+static unsigned short trace_map[4];
+
+#if (HOST_MODEL == YES)
+#define TRACE_CYCLES()      sim_6131_cycles()
+#else
+#define TRACE_CYCLES()      DWT_CYCCNT
+#endif
+
+#define TRACE_START(opcode) if(trace_on) trace_start(opcode)
+#define TRACE_WORD()        if(trace_open) spi_trace[trace_head].words++
+#define TRACE_STOP()        if(trace_open) trace_stop()
+#define TRACE_DMA(n)        if(trace_open) { spi_trace[trace_head].words = (n); \
+                                             spi_trace[trace_head].flags |= SPI_TRACE_DMA; }
+#define TRACE_MAP(reg, data) if(((reg) >= MAP_1) && ((reg) <= MAP_4)) trace_map[(reg) - (MAP_1)] = (data)
+#define TRACE_ISR(n)        trace_isr = (n)
+
+
+// open a record at chip select assertion
+static void trace_start(unsigned char opcode) {
+
+    SPI_TRACE_REC *rec = &spi_trace[trace_head];
+
+    rec->start = TRACE_CYCLES();
+    rec->opcode = opcode;
+    rec->map = (unsigned char)((mcfg_shadow >> 10) & 0x0003) + 1;
+    rec->words = 0;
+    rec->flags = 0;
+    if(spi_busy && spi_irq) rec->flags |= SPI_TRACE_RESUMED;
+    if(trace_isr) rec->flags |= SPI_TRACE_ISR;
+    // fast-access register op codes carry the register number
+    if(opcode < 0x40) rec->address = opcode >> 2;
+    else if((opcode >= 0x80) && (opcode < 0xC0)) rec->address = opcode - 0x80;
+    else if((opcode == 0x40) || (opcode == 0x60) || (opcode == 0xC0)) rec->address = trace_map[rec->map - 1];
+    else if(opcode == 0xC8) rec->address = trace_map[rec->map - 1] + 1;
+    else rec->address = SPI_TRACE_NOADDR;
+    trace_open = 1;
+}
+
+
+// close the record at chip select negation
+static void trace_stop(void) {
+
+    SPI_TRACE_REC *rec = &spi_trace[trace_head];
+
+    rec->end = TRACE_CYCLES();
+    // MAP auto-increment, so a resumed op code shows where it continued
+    if((rec->opcode == 0x40) || (rec->opcode == 0xC0) || (rec->opcode == 0xC8))
+        trace_map[rec->map - 1] = rec->address + rec->words;
+    trace_head = (trace_head + 1) & (SPI_TRACE_SIZE - 1);
+    trace_total++;
+    trace_open = 0;
+}
+
+#else
+
+#define TRACE_START(opcode)
+#define TRACE_WORD()
+#define TRACE_STOP()
+#define TRACE_DMA(n)
+#define TRACE_MAP(reg, data)
+#define TRACE_ISR(n)
+
+#endif  // SPI_TRACE
+
 //------------------------------------------------------------------------------
 //         Functions
 //------------------------------------------------------------------------------
 
 
+//	Local function that waits until no DMA burst owns the SPI. Burst segments
+//	are completed here by polling the DMAC status, so the wait also ends with
+//	interrupts disabled. spi_start( ) and Read_6131_MasterConfig( ) call this
+//	first, so a foreground access started during a burst waits for it and sees
+//	the MAP the burst re-enabled. Not used by the burst engine's own accesses.
+//
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, interrupts are disabled only while polling.
+//
+static void spi_dma_wait(unsigned char irq_mgmt) {
+
+    while(spi_dma_busy && !burst_spi) {
+        if(irq_mgmt)  __disable_interrupt();
+        burst_service();
+        if(irq_mgmt)  __enable_interrupt();
+    }
+}
+
+
+//	Local SPI frame functions used by all HI-6131 accesses below. Every access is
+//	spi_start( ) to assert chip select and send the 8-bit op code frame, then zero
+//	or more spi_put( ) or spi_get( ) data words, then spi_stop( ) to negate chip select.
+//
+//	With SPI_16BIT_FRAMES = YES (file 613x_initialization.h) each data word is sent as
+//	one 16-bit SPI frame, halving the TDR writes, status polls and DLYBCT gaps needed 
+//	for two 8-bit frames. The op code is always its own 8-bit frame. Between accesses 
+//	the SPI is left configured for 8-bit frames.
+//
+//	spi_start( ) and spi_get( ) wait for RDRF and read RDR for every frame, so received
+//	data is never stale. spi_put( ) only waits for TDRE; the data characters received 
+//	while writing are discarded by spi_stop( ).
+//
+//	Interrupts must be disabled by the caller. spi_start( ) first waits for a
+//	running DMA burst to finish.
+//
+#if (HOST_MODEL == YES)
+
+//	Host build: chip select and frames go to the simulated HI-6131 in file
+//	host/hi6131_sim.c instead of SPI0 and PIOA. Frame sizes are unchanged.
+//
+static void spi_start(unsigned char opcode) {
+
+    spi_dma_wait(0);
+    TRACE_START(opcode);
+    sim_6131_select();
+    sim_6131_frame(opcode, 8);
+}
+
+
+static void spi_put(unsigned short data) {
+
+    TRACE_WORD();
+#if (SPI_16BIT_FRAMES == YES)
+    sim_6131_frame(data, 16);
+#else
+    sim_6131_frame(data >> 8, 8);
+    sim_6131_frame(data & 0xFF, 8);
+#endif
+}
+
+
+static unsigned short spi_get(void) {
+
+    TRACE_WORD();
+#if (SPI_16BIT_FRAMES == YES)
+    return sim_6131_frame(0x0000, 16);
+#else
+    unsigned short data;
+
+    data = sim_6131_frame(0x00, 8) << 8;
+    data |= sim_6131_frame(0x00, 8);
+    return data;
+#endif
+}
+
+
+static void spi_stop(void) {
+
+    sim_6131_deselect();
+    TRACE_STOP();
+}
+
+#else
+
+static void spi_start(unsigned char opcode) {
+
+    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
+    unsigned int dummy;
+
+    // the SPI may belong to a DMA burst
+    spi_dma_wait(0);
+    TRACE_START(opcode);
+    // Assert SPI chip select
+    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss);
+    // Wait for TDR and shifter = empty
+    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
+    // discard any unread data char
+    dummy = spi->SPI_RDR;
+    // Send 8-bit SPI op code
+    spi->SPI_TDR = opcode | SPI_PCS(BOARD_6131_NPCS);
+    // Wait for RDRF flag (Rx Data Register Full), discard received char
+    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
+    dummy = spi->SPI_RDR;
+    // prevent warning: variable dummy was set but never used
+    dummy = dummy;
+#if (SPI_16BIT_FRAMES == YES)
+    // data words are 16-bit frames. Wait for op code frame to finish first
+    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
+    spi->SPI_CSR[BOARD_6131_NPCS] = spi_csr | SPI_CSR_BITS16;
+#endif
+}
+
+
+static void spi_put(unsigned short data) {
+
+    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
+
+    TRACE_WORD();
+#if (SPI_16BIT_FRAMES == YES)
+    // Wait for TDRE flag (Tx Data Register Empty), transmit data word
+    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
+    spi->SPI_TDR = data | SPI_PCS(BOARD_6131_NPCS);
+#else
+    // transmit upper byte then lower byte
+    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
+    spi->SPI_TDR = (data >> 8) | SPI_PCS(BOARD_6131_NPCS);
+    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
+    spi->SPI_TDR = (data & 0xFF) | SPI_PCS(BOARD_6131_NPCS);
+#endif
+}
+
+
+static unsigned short spi_get(void) {
+
+    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
+    unsigned short data;
+
+    TRACE_WORD();
+#if (SPI_16BIT_FRAMES == YES)
+    // transmit dummy data word to receive data word
+    spi->SPI_TDR = 0x0000 | SPI_PCS(BOARD_6131_NPCS);
+    // Wait for RDRF flag (Rx Data Register Full)
+    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
+    data = spi->SPI_RDR & 0xFFFF;
+#else
+    // transmit dummy data bytes to receive upper byte then lower byte
+    spi->SPI_TDR = 0x00 | SPI_PCS(BOARD_6131_NPCS);
+    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
+    data = (spi->SPI_RDR & 0xFF) << 8;
+    spi->SPI_TDR = 0x00 | SPI_PCS(BOARD_6131_NPCS);
+    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
+    data |= spi->SPI_RDR & 0xFF;
+#endif
+    return data;
+}
+
+
+static void spi_stop(void) {
+
+    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
+    unsigned int dummy;
+
+    // Wait for TDR and shifter = empty
+    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
+    // negate slave chip select
+    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+#if (SPI_16BIT_FRAMES == YES)
+    // back to 8-bit frames
+    spi->SPI_CSR[BOARD_6131_NPCS] = spi_csr;
+#endif
+    // discard received data char and clear overrun flag left by spi_put( )
+    dummy = spi->SPI_RDR;
+    dummy = spi->SPI_SR;
+    // prevent warning: variable dummy was set but never used
+    dummy = dummy;
+    TRACE_STOP();
+}
+
+#endif  // HOST_MODEL
+
+
+
+//	Local function that updates the Master Config shadow bits 11-10 after a MAP 
+//	enable op code 0xD8-0xDB was sent. Other op codes are ignored.
+//
+static void mcfg_track(unsigned char opcode) {
+
+    if((opcode >= enMAP1) && (opcode <= enMAP4))
+        mcfg_shadow = (mcfg_shadow & ~0x0C00) | ((opcode - enMAP1) << 10);
+}
+
+
+
 //	This function transmits the parameter 8-bit op code of the type that 
 //      does not read or write following data word(s):
 //
@@ -115,48 +558,36 @@ unsigned short read_data[256];
 //       0xD2       Add 2 to currently-enabled Memory Address Pointer value
 //       0xD4       Add 4 to currently-enabled Memory Address Pointer value
 //
-//      Any other op code value will give unpredictable results. The op code
-//      is transmited a byte at a time. The data characters received during 
-//      op code transmission are discarded.
-//
-//		The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//		can initialize a new transfer whether/not SPI RxData register has unread
-//		data. To speed up SPI operations by taking advantnage of the WDRBT
-//		option, several statements are commented-out in the function below.
+//      Any other op code value will give unpredictable results. The data 
+//      character received during op code transmission is discarded.
 //
 void SPIopcode( unsigned char opcode)  {
         
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short dummy;
-        
     __disable_interrupt();	 
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss);
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send SPI op code 
-    spi->SPI_TDR = opcode | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // without this next delay, the ARM SPI reads wrong value in RDR!
-    // I see good data shifting out from HI-6131 but RxData register value is wrong
-    for (dummy=0; dummy<2; dummy++);
-    // Read received data char in Rx buffer, discard it 
-    dummy = spi->SPI_RDR & 0xFFFF;
-    // prevent warning: variable dummy was set but never used
-    dummy = dummy;
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    spi_start(opcode);
+    spi_stop();
+    mcfg_track(opcode);
 	__enable_interrupt();
 }
 
 
 
+//	This local function sends a single-byte op code like SPIopcode( ) but leaves 
+//	the interrupt enable state alone. Used by the block and burst functions and 
+//	interrupt entry and exit, which run with interrupts disabled.
+//
+static void SPIopcode_noirq(unsigned char opcode) {
+
+    spi_start(opcode);
+    spi_stop();
+    mcfg_track(opcode);
+}
+
+
+
 
 // This function writes a single 16-bit value to a specified HI-6131 register 0-63.
-// The function transmits an 8-bit op code, then transmits the data a byte at a time. 
+// The function transmits an 8-bit op code, then transmits the data word. 
 // All data characters received during op code and data transmission are discarded.
 //
 // To avoid disruption during SPI transfers, interrupts that use SPI must be 
@@ -174,55 +605,21 @@ void SPIopcode( unsigned char opcode)  {
 //			  if non-zero, this function locally calls __disable_interrupt() 
 //                        and __enable_interrupt().
 //
-//		The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//		can initialize a new transfer whether/not SPI RxData register has unread
-//		data. To speed up SPI operations by taking advantnage of the WDRBT
-//		option, several statements are commented-out in the function below.
-//
 unsigned char Write_6131LowReg(unsigned char reg_number, unsigned short data, unsigned char irq_mgmt) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-	unsigned short i;
-	//unsigned short dummy;
-    volatile unsigned char bufferTX[2];
-        
 	if(reg_number > 63) return('F');	// illegal parameter 		
 
-    bufferTX[0] = (char)(data >> 8);        // upper data byte  
-    bufferTX[1] = (char)data;               // lower data byte 
-        
     // disable interrupts, if IRQs managed at this level
 	if(irq_mgmt)  __disable_interrupt();	 
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss);                        
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send 8-bit SPI op code = 0x80 + reg_number
-    spi->SPI_TDR = (0x80 + reg_number) | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    // dummy = spi->SPI_RDR & 0xFFFF;
-
-    // transmit 2 data bytes
-    for (i = 0; i < 2; i++) {
-        // Wait for TDR and shifter = empty
-        // while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit next byte
-        spi->SPI_TDR = bufferTX[i] | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        // dummy = spi->SPI_RDR & 0xFFFF;
-        // prevent warning: variable dummy was set but never used
-        // dummy = dummy;
-    }    
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    // 8-bit SPI op code = 0x80 + reg_number, then data word
+    spi_start(0x80 + reg_number);
+    spi_put(data);
+    spi_stop();
+    TRACE_MAP(reg_number, data);
+    if(reg_number == MASTER_CONFIG_REG) {
+        mcfg_shadow = data & ~MCFG_BCSTRT;
+        mcfg_valid = 1;
+    }
     // re-enable interrupts, if IRQs managed at this level 
 	if(irq_mgmt)  __enable_interrupt();	
         
@@ -231,8 +628,8 @@ unsigned char Write_6131LowReg(unsigned char reg_number, unsigned short data, un
         
 
 // 	This function reads a single 16-bit value from a specified HI-6131 register 0-15.
-//	The function transmits an 8-bit op code, then receives the data word as two 
-//	bytes. The data is returned as a word. The data character received during 
+//	The function transmits an 8-bit op code, then receives the data word. 
+//	The data is returned as a word. The data character received during 
 //	op code transmission is discarded.
 //
 //	Either the calling routine issues __disable_interrupt() before calling this function, 
@@ -246,57 +643,24 @@ unsigned char Write_6131LowReg(unsigned char reg_number, unsigned short data, un
 //			  if non-zero, this function locally calls __disable_interrupt() 
 //                        and __enable_interrupt().
 //
-//		The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//		can initialize a new transfer whether/not SPI RxData register has unread
-//		data. To speed up SPI operations by taking advantnage of the WDRBT
-//		option, several statements are commented-out in the function below.
-//
 unsigned short Read_6131LowReg(unsigned char reg_number, unsigned char irq_mgmt) {
        
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short data, i;
-    volatile unsigned char bufferRX[2];
+    unsigned short data;
         
     if(reg_number > 15) return('F');  // illegal parameter 		
 
     // disable interrupts, if IRQs managed at this level
     if(irq_mgmt)  __disable_interrupt();	 
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send 8-bit SPI op code = reg_number << 2
-    spi->SPI_TDR = (reg_number << 2) | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read received data char in Rx buffer, discard/overwrite below
-    bufferRX[0] = spi->SPI_RDR;// & 0xFF;
-
-    // receive 2 bytes register data, transmit 2 dummy data bytes
-    for (i = 0; i < 2; i++) {
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data to receive next byte
-        spi->SPI_TDR = 0x00 | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (data=0; data<2; data++);
-        // Read received data char in Rx buffer
-        bufferRX[i] = spi->SPI_RDR;// & 0xFF;
-    }    
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    // 8-bit SPI op code = reg_number << 2, then receive data word
+    spi_start(reg_number << 2);
+    data = spi_get();
+    spi_stop();
+    if(reg_number == MASTER_CONFIG_REG) {
+        mcfg_shadow = data & ~MCFG_BCSTRT;
+        mcfg_valid = 1;
+    }
     // re-enable interrupts, if IRQs managed at this level 
     if(irq_mgmt)  __enable_interrupt();	
-    // concantenate (merge) 2 data bytes into 16-bit value
-    data =  (unsigned int)bufferRX[0] << 8;
-    data |= (unsigned int)bufferRX[1];
         
     return data;
 }
@@ -306,7 +670,7 @@ unsigned short Read_6131LowReg(unsigned char reg_number, unsigned char irq_mgmt)
 
 //  This function writes a single 16-bit word to the address indicated by the 
 //  current value in the already-enabled HI-6131 Memory Address Pointer register. 
-// The function transmits an 8-bit op code then the data word a byte at a time. 
+// The function transmits an 8-bit op code then the data word. 
 // Data characters received during op code and data transmission are discarded.
 // The Memory Address Pointer auto-increments after writing the data
 //
@@ -323,48 +687,12 @@ unsigned short Read_6131LowReg(unsigned char reg_number, unsigned char irq_mgmt)
 //
 void Write_6131_1word(unsigned short data, unsigned char irq_mgmt)  {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short i;
-    unsigned short dummy;
-    volatile unsigned char bufferTX[2];
-        
-    // upper data byte
-    bufferTX[0] = (char)(data >> 8);          
-    // lower data byte
-    bufferTX[1] = (char)data;               
-        
     // disable interrupts, if IRQs managed at this level
     if(irq_mgmt)  __disable_interrupt();	 
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss);                        
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send 8-bit SPI op code 0xC0: write using enabled MAP current value
-    spi->SPI_TDR = 0xC0 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    dummy = spi->SPI_RDR & 0xFFFF;
-
-    // transmit 2 data bytes
-    for (i = 0; i < 2; i++) {
-        // Wait for TDR and shifter = empty
-        // while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit next byte
-        spi->SPI_TDR = bufferTX[i] | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        dummy = spi->SPI_RDR;
-    }    
-    // prevent warning: variable dummy was set but never used
-    dummy = dummy;        
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    // 8-bit SPI op code 0xC0: write using enabled MAP current value
+    spi_start(0xC0);
+    spi_put(data);
+    spi_stop();
     // re-enable interrupts, if IRQs managed at this level 
     if(irq_mgmt)  __enable_interrupt();	
         
@@ -377,7 +705,7 @@ void Write_6131_1word(unsigned short data, unsigned char irq_mgmt)  {
 // This function reads one 16-bit register or RAM location, indicated by
 // the address value in the HI-6131 Memory Address Pointer register. 
 // The function transmits an 8-bit op code, then reads and returns the 
-// data using SPI, a byte at a time. Bytes are merged into returned word.
+// data word using SPI.
 //
 // Either the calling routine issues __disable_interrupt() before calling this function, 
 //  or the __disable_interrupt() and __enable_interrupt() calls are performed here. This 
@@ -389,56 +717,18 @@ void Write_6131_1word(unsigned short data, unsigned char irq_mgmt)  {
 //                   if non-zero, this function locally calls __disable_interrupt() 
 //                   and __enable_interrupt().
 //
-// The MCU's SPI mode register is written with option WDRBT = 0 so Master
-// can initialize a new transfer whether/not SPI RxData register has unread
-// data. To speed up SPI operations by taking advantnage of the WDRBT
-// option, several statements are commented-out in the function below.
-//
 unsigned short Read_6131_1word(unsigned char irq_mgmt) {
        
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short data, i;
-    volatile unsigned char bufferRX[2];
+    unsigned short data;
         
     // disable interrupts, if IRQs managed at this level
     if(irq_mgmt)  __disable_interrupt();	 
-       
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send 8-bit SPI read op code 0x40
-    spi->SPI_TDR = 0x40 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read received data char in Rx buffer, overwrite/discard it below
-    bufferRX[0] = spi->SPI_RDR & 0xFFFF;
-
-    // receive 2 bytes register data, transmit 2 dummy data bytes
-    for (i = 0; i < 2; i++) {
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data byte 0x00 to start receive
-        spi->SPI_TDR = 0x00 | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (data=0; data<5; data++);
-       // Read received data char in Rx buffer
-        bufferRX[i] = spi->SPI_RDR;
-    }    
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    // 8-bit SPI read op code 0x40, then receive data word
+    spi_start(0x40);
+    data = spi_get();
+    spi_stop();
     // re-enable interrupts, if IRQs managed at this level 
     if(irq_mgmt)  __enable_interrupt();	
-    // merge 2 data bytes into 16-bit value
-    data =  (unsigned int)bufferRX[0] << 8;
-    data |= (unsigned int)bufferRX[1];
         
 	return data;
 }
@@ -447,7 +737,7 @@ unsigned short Read_6131_1word(unsigned char irq_mgmt) {
 
 // This function writes one or more 16-bit words to the starting address indicated
 // by the current value in the HI-6131 Memory Address Pointer register. The function
-// transmits an 8-bit op code, then transmits data words a byte at a time. 
+// transmits an 8-bit op code, then transmits data words. 
 // All data characters received during op code and data transmission are discarded.
 //
 // Either the calling routine issues __disable_interrupt() before calling this function, 
@@ -460,53 +750,32 @@ unsigned short Read_6131_1word(unsigned char irq_mgmt) {
 // used with parameter irq_mgmt = 1. In this mode, IRQs are disabled during spi intervals,
 // but IRQs are periodically enabled between whole word transfers. The function will 
 // recover from vectored spi-using interrupts (recognized only between written data words) 
-// when these IRQs use the demonstrated "spi_busy spi_irq" handshake. Such IRQs are 
-// detected and a new SPI op code is issued to permit this function to continue to completion.
+// that use Enter_6131_ISR( ) and Exit_6131_ISR( ) with their own Memory Address Pointer.
+// Such IRQs are detected and a new SPI op code is issued to continue to completion.
 //
 // 	param 	write_data[] array containing 16-bit words to be written, write_data[0] is written first
-// 	param 	inc_pointer_first = 0 begins reading at current Memory Address Pointer addr, 
-//                              1 (non-zero) increments Memory Address Pointer before reading
+// 	param 	number_of_words is the number of words to be written from write_data[]
+// 	param 	inc_pointer_first = 0 begins writing at current Memory Address Pointer addr, 
+//                              1 (non-zero) increments Memory Address Pointer before writing
 //      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
 //	                  if non-zero, this function locally calls __disable_interrupt() 
 //                        and __enable_interrupt().
 //
-//		The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//		can initialize a new transfer whether/not SPI RxData register has unread
-//		data. To speed up SPI operations by taking advantnage of the WDRBT
-//		option, several statements are commented-out in the function below.
-//
-void Write_6131(unsigned short write_data[], unsigned char inc_pointer_first, unsigned char irq_mgmt) {
+void Write_6131(unsigned short write_data[], unsigned short number_of_words, unsigned char inc_pointer_first, unsigned char irq_mgmt) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short i, len;
-    //unsigned short dummy;
+    unsigned short i;
     unsigned char opcode;
         
-    // disable interrupts, if IRQs managed at this level
-    if(irq_mgmt)  __disable_interrupt();	 
-        
     if(inc_pointer_first) opcode = 0xC8;
     else opcode = 0xC0;
              
+    // disable interrupts, if IRQs managed at this level
     if(irq_mgmt)  __disable_interrupt();
     // variable tested by vectored interrupt routine 
     spi_busy = 1;				
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send SPI op code 
-    spi->SPI_TDR = opcode | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    // dummy = spi->SPI_RDR & 0xFFFF;
-        
-    len = sizeof(write_data);
+    spi_start(opcode);
                                                      
-	for (i = 0; i < len; i++) 	{
+	for (i = 0; i < number_of_words; i++) 	{
 
 		if(irq_mgmt) __enable_interrupt();
 		// Before writing the next word, momentarily enable IRQs...
@@ -518,55 +787,18 @@ void Write_6131(unsigned short write_data[], unsigned char inc_pointer_first, un
 
 		if(spi_irq) {
 		    // the multi-word transfer was disturbed, but the interrupt's
-	        // ISR should have used a different Memory Address Pointer and
-            // reenabled the Memory Address Pointer we were using, so our
-			// MAP points to the next word to be written. Issue a new SPI 
-			// op code to resume a multi-word write process, starting at the 
-			// RAM location addressed by the Memory Address Pointer value. 
-
-            // Assert SPI chip select since there was an interrupt
-            AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-            // Wait for TDR and shifter = empty
-            while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-            // Issue SPI op code 0xC0: write using existing MAP pointer value.
-            spi->SPI_TDR = 0xC0 | SPI_PCS(BOARD_6131_NPCS);
-            // Wait for TDRE flag (Tx Data Register Empty)
-            while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-            // Wait for RDRF flag (Rx Data Register Full)
-            // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-            // Read and discard received data char in Rx buffer
-            // dummy = spi->SPI_RDR & 0xFFFF;
+	        // ISR used its own Memory Address Pointer and re-enabled the
+            // Memory Address Pointer we were using, so our MAP points to
+			// the next word to be written. Chip select was negated by 
+			// Enter_6131_ISR( ): issue a new SPI op code 0xC0 to resume the
+			// multi-word write at the RAM location addressed by the MAP. 
+            spi_start(0xC0);
 			spi_irq = 0;
 		}
-                
-        // transmit next data word a byte at a time
-                
-        // Wait for TDR and shifter = empty
-        // while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit upper byte
-        spi->SPI_TDR = ((char)(write_data[i] >> 8)) | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        // dummy = spi->SPI_RDR & 0xFFFF;
-
-        // Wait for TDR and shifter = empty
-        // while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit lower byte
-        spi->SPI_TDR = ((char)(write_data[i])) | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        // dummy = spi->SPI_RDR & 0xFFFF;                            
+        // transmit next data word
+        spi_put(write_data[i]);
 	}
-    // prevent warning: variable dummy was set but never used
-    // dummy = dummy;
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    spi_stop();
 	spi_busy = 0;
     // re-enable interrupts, if IRQs managed at this level
 	if(irq_mgmt) __enable_interrupt();				 
@@ -577,258 +809,107 @@ void Write_6131(unsigned short write_data[], unsigned char inc_pointer_first, un
 
 
 
-// 	This function reads one to 256 sequential 16-bit words beginning at the starting 
-//	address indicated by the address value in the HI-6131 Memory Address Pointer register. 
-//	The function transmits an 8-bit op code, then reads data words a byte at a time.
-//	Words read are stored in global read_data[], starting at read_data[0].
-//
-//	Either the calling routine issues __disable_interrupt() before calling this function, 
-//  or the __disable_interrupt() and __enable_interrupt() calls are performed here. This 
-//  choice determines where IRQ recognition	occurs. When series of spi function calls are 
-//  chained to perform larger tasks, it may be desirable to disable/enable IRQs at the 
-//  higher level (param irq_mgmt = 0)
-//
-//	Note: Because this function may perform long N-word transfers, it is typically 
-//	used with parameter irq_mgmt = 1. In this mode, IRQs are disabled during spi intervals,
-//	but IRQs are periodically enabled between whole word transfers. The function will 
-//	recover from vectored spi-using interrupts (recognized only between read data words) 
-//	when these IRQs use the demonstrated "spi_busy spi_irq" handshake. Such IRQs are 
-//	detected and a new SPI op code is issued to permit this function to continue to completion.
-// 
-// 	param 	number_of_words is the array size 
-//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
-//	                  if non-zero, this function locally calls __disable_interrupt() 
-//                    and __enable_interrupt().
-//
-//	Note: This function is designed to recover from a vectored interrupt (recognized only
-//	between read data words) that disturbs the SPI operation. A new SPI op code is issued
-//	to permit the operation to continue to completion.
+// 	This function reads one to 256 sequential 16-bit words beginning at the specified
+//	address. Words read are stored in global read_data[], starting at read_data[0]. 
+//	Nothing is displayed; use print_hex_dump( ) to show the words on the console.
+//	The read is performed by Read_6131_Block( ) with descriptor table handling enabled,
+//	so RT Descriptor Tables read correctly.
 //
-//		The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//		can initialize a new transfer whether/not SPI RxData register has unread
-//		data. To speed up SPI operations by taking advantnage of the WDRBT
-//		option, several statements are commented-out in the function below.
+// 	param 	address is the HI-6131 address for the first word
+// 	param 	number_of_words is the number of words to read, 256 maximum
 //
-#if 0
-void Read_6131(unsigned short number_of_words, unsigned char irq_mgmt) {
-// ************* THIS DOES NOT WORK *******************
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    volatile unsigned char bufferRX[2];
-    unsigned short dummy;
-    unsigned short i,j;
-        
-    // disable interrupts, if IRQs managed at this level
-    if(irq_mgmt)  __disable_interrupt();	 
-    // variable tested by vectored interrupt routine
-    spi_busy = 1;				         
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send SPI op code 0x40 to read using existing pointer value
-    spi->SPI_TDR = 0x40 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    dummy = spi->SPI_RDR & 0xFFFF;
-        
-    for (i = 0; i < number_of_words; i++) 
-      {
+void Read_6131(unsigned short address, unsigned short number_of_words) {
 
-	if(irq_mgmt) __enable_interrupt();
-	// Before reading the next word, momentarily enable IRQs...
-	// A pending IRQ that occurred since last __disable_interrupt() will be recognized here.
-	// Its ISR (int.svc routine) will execute, probably using SPI, disrupting 
-	// our multi-word transfer. The ISR sets the spi_irq flag, then execution 
-	// resumes here, at this next __disable_interrupt() call...   
-	if(irq_mgmt) __disable_interrupt();
+    if(number_of_words > 256) number_of_words = 256;
 
-	if(spi_irq) 
-          {
-	    // the multi-word transfer was disturbed, but the interrupt's
-	    // ISR should have used a different Memory Address Pointer and
-            // reenabled the Memory Address Pointer we were using, so our
-	    // MAP points to the next word to be read. Issue a new SPI 
-	    // op code to resume a multi-word read process, starting at the 
-	    // RAM location addressed by the Memory Address Pointer value. 
-	    // Assert SPI chip select
-	    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-	    // Wait for TDR and shifter = empty
-	    // while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-	    // Send SPI op code to resume reading using existing pointer value
-	    spi->SPI_TDR = 0x40 | SPI_PCS(BOARD_6131_NPCS);
-	    // Wait for TDRE flag (Tx Data Register Empty)
-	    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-	    // Wait for RDRF flag (Rx Data Register Full)
-	    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-	    // Read and discard received data char in Rx buffer
-	    dummy = spi->SPI_RDR & 0xFFFF;
-            // prevent warning: variable dummy was set but never used
-            // dummy = dummy;
-	    spi_irq = 0;
-          }
-      // receive 2 bytes RAM data, transmit 2 dummy data bytes
-      for (j = 0; j < 2; j++) 
-        {
-          // Wait for TDR and shifter = empty
-          while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);  // **** added this b a c k
-          // transmit dummy data byte 0x00 to start receive
-          spi->SPI_TDR = 0x00 | SPI_PCS(BOARD_6131_NPCS);
-          // Wait for TDRE flag (Tx Data Register Empty)
-          while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-          // Wait for RDRF flag (Rx Data Register Full)
-          while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-          // without this next delay, the ARM SPI reads wrong value in RDR!
-          // I see good data shifting out from HI-6131 but RxData register value is wrong
-          for (dummy=0; dummy<5; dummy++);
-          // Read received data char in Rx buffer
-          bufferRX[j] = spi->SPI_RDR & 0xFFFF;
-                  
-          // merge 2 data bytes into 16-bit value and store
-          read_data[i] =  (unsigned int)bufferRX[0] << 8;
-          read_data[i] |= (unsigned int)bufferRX[1];
-          }
-      spi_busy = 0;
-      // negate slave chip select
-      AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
-      // re-enable interrupts, if IRQs managed at this level 
-      if(irq_mgmt)  __enable_interrupt();	    
-      }
+    Read_6131_Block(address, read_data, number_of_words, 1, 1);
 }
-#endif
 
-/*
-Revised version 6/4/14
 
-*/
-void Read_6131(unsigned short address, unsigned short number_of_words) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short k,addr;
-    unsigned char savemap, data, mod4=0;
-    unsigned short dummy;
-   
-    
-     __disable_interrupt();
-    // we will restore the active MAP when finished
-    savemap = (char)(getMAPaddr() - 0x000A);
-    // use MAP3 
-    enaMAP(3);
-    addr = address & 0xFFF0;
-    Write_6131LowReg(MAP_3,addr,0); 
-    
-    // variable tested by vectored interrupt routine 
-    spi_busy = 1;				
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send SPI op code 
-    spi->SPI_TDR = 0x40 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    dummy = spi->SPI_RDR;// & 0xFFFF;
-                            
-
-    for (k = 0; k < number_of_words; k++) {
-        read_data[k]=0;
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data to receive upper byte
-        spi->SPI_TDR = (0x00 | SPI_PCS(BOARD_6131_NPCS));
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (dummy=0; dummy<5; dummy++);
-        // Read upper byte
-        data = spi->SPI_RDR;// & 0xFF;
-        printf("%.2X", (char)data);
-        read_data[k] =  (unsigned int)data << 8;          
-        
-   
-       // Now get the second byte 
-        
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data to receive lower byte
-        spi->SPI_TDR = (0x00 | SPI_PCS(BOARD_6131_NPCS));
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (dummy=0; dummy<5; dummy++);
-        // Read lower byte
-        data = spi->SPI_RDR;// & 0xFF;
-        printf("%.2X ", (char)data);
-        read_data[k] |=  (unsigned int)data;                          
-                
-        // this next part provides normal operation when reading RT Descriptor tables.
-        // MAP does not auto-increment when the next word is a descriptor Control Word.
-        // every 4th word we reload MAP to force increment, d-table words 4,8,12, etc.
-        // Behavior applies even when not accessing d-tables, AND ASSUMES RT DESCRIPTOR
-        // TABLE(S) START AT BASE ADDRESS WITH 4-LSB'S = 0, any 0xNNN0: 0x0400, 0x04F0.
-        // DESCRIPTOR TABLE START ADDRESS CANNOT EXCEED 0x7E00...
-        addr++;
-        mod4++;
-        if (mod4 == 4) {
-            mod4 = 0;
-            // negate slave chip select. Below we reload MAP to force increment, 
-            // then issue a new read op code 0x40 to resume read at next address
-            AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+// 	This function reads N 16-bit words from sequential HI-6131 register or RAM locations,
+//	beginning at the specified address, into a caller array. All N words are read under
+//	a single read op code. The function only fills the caller's array: it does not use
+//	global read_data[] and performs no console I/O, so it may be used by message 
+//	processing code. 
+//
+//	The function uses Memory Address Pointer MAP_BULK (MAP3). The incoming enabled MAP is 
+//	re-enabled when finished, so the caller's MAP value is undisturbed. 
+//
+//	Descriptor tables: the Memory Address Pointer does not auto-increment when the next 
+//	word is an RT Descriptor Table Control Word. When param dtable is non-zero, MAP3 is
+//	reloaded and a new op code issued at every 4-word boundary (address 0xNNN0, 0xNNN4,
+//	0xNNN8, 0xNNNC). RT DESCRIPTOR TABLE(S) MUST START AT A BASE ADDRESS 0xNNN0.
+//
+//	If parameter irq_mgmt is non-zero, IRQs are momentarily enabled between read words.
+//	An spi-using interrupt recognized there must use Enter_6131_ISR( ) and Exit_6131_ISR( )
+//	as described for Write_6131_Block( ). This function then issues a new read op code.
+//
+// 	param 	address is the HI-6131 address for the first word, stored in dst[0]
+// 	param 	dst is the caller array receiving the words read
+// 	param 	count is the number of words to be read
+// 	param 	dtable is non-zero if the address range includes RT descriptor table(s)
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//	Returns 'F' for a null array pointer or zero count, otherwise 'P'.
+//
+unsigned char Read_6131_Block(unsigned short address, unsigned short *dst, unsigned short count, unsigned char dtable, unsigned char irq_mgmt) {
+
+    unsigned short i;
+    unsigned char savemap, reload;
+
+    if((dst == 0) || (count == 0)) return ('F');
+
+    // disable interrupts, if IRQs managed at this level
+    if(irq_mgmt)  __disable_interrupt();	 
+    // we will restore the active MAP when finished, Master Config bits 11-10
+    savemap = (unsigned char)((Read_6131_MasterConfig(0) >> 10) & 0x0003);
+    // our MAP, loaded with the first address below
+    SPIopcode_noirq(enMAP1 + MAP_BULK - 1);
+    // variable tested by Enter_6131_ISR( )
+    spi_busy = 1;
+    spi_irq = 0;
+
+    for (i = 0; i < count; i++, address++) {
+
+        // first word, or MAP does not auto-increment onto a descriptor Control Word
+        reload = (i == 0) || (dtable && ((address & 0x0003) == 0));
+        if(reload) {
+            // chip select may already be negated by an interrupt
+            if(i && !spi_irq) spi_stop();
+            // load MAP3 with the next read address then issue read op code 0x40
+            Write_6131LowReg(MAP_REG(MAP_BULK), address, 0);
+            spi_start(0x40);
         }
-        // Before reading the next word, momentarily enable IRQs...
-        __enable_interrupt();
-        // A pending IRQ that occurred since last disable_interrupt() will be recognized here.
-        // Its int.service routine probably used SPI, disrupting our multi-word transfer. As long
-        // as the interrupt routine sets the spi_irq flag, we can recover. When the interrupt is
-        // finished, execution resumes at this next disable_interrupt() call, ...
-                
-        __disable_interrupt();
-       
-        if(spi_irq) enaMAP(4);
-          
-        if(spi_irq || (mod4==0)) {
-            spi_irq = 0;
-            // Reload MAP4 with the next read address, then issue a new SPI op code 0x40
-            // to resume our multi-word read process where it left off. This occurs after
-            // interrupt, or when new mod4 = 0, i.e., addr = 0xXXX0, 0xXXX4,0xXXX8 or 0xXXXC.
-            Write_6131LowReg(MAP_3,addr,0); 
-            
-            // Wait for TDR and shifter = empty in case spi not idle
-            while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-            // Negate then assert SPI chip select since there was an interrupt
-            AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
-            AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-            // Issue SPI op code 0x40: write using existing MAP pointer value.
-            spi->SPI_TDR = 0x40 | SPI_PCS(BOARD_6131_NPCS);
-            // Wait for TDRE flag (Tx Data Register Empty)
-            while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-            // Wait for RDRF flag (Rx Data Register Full)
-            while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-            // Read and discard received data char in Rx buffer
-            dummy = spi->SPI_RDR & 0xFFFF;
-        }             
-    }   // end for(k = 0; k < 16; k++)
-    
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS;    
+        else if(spi_irq) {
+            // an interrupt negated chip select. MAP3 is enabled again and 
+            // still holds this address, so only the op code is needed
+            spi_start(0x40);
+        }
+        spi_irq = 0;
+        // receive next data word
+        dst[i] = spi_get();
+
+        if(irq_mgmt) {
+            // Before reading the next word, momentarily enable IRQs. If an interrupt
+            // service routine uses SPI, Enter_6131_ISR( ) sets spi_irq and the loop 
+            // above resumes.
+            __enable_interrupt();
+            __disable_interrupt();
+        }
+    }
+    // chip select may already be negated by an interrupt after the last word
+    if(!spi_irq) spi_stop();
     spi_busy = 0;
-    // prevent warning
-    dummy = dummy;    
-    // restore original MAP
-    enaMAP(savemap);   
-    __enable_interrupt();       
-}    // end 
+    spi_irq = 0;
+    // restore original MAP by single op code
+    SPIopcode_noirq(enMAP1 + savemap);
+    // re-enable interrupts, if IRQs managed at this level 
+    if(irq_mgmt)  __enable_interrupt();	
+
+    return ('P');
+}
 
 
 // 	After changing the Memory Address Pointer register in the HI-6131, this function writes one 
@@ -860,23 +941,18 @@ void Read_6131(unsigned short address, unsigned short number_of_words) {
 //	used with parameter irq_mgmt = 1. In this mode, IRQs are disabled during spi intervals,
 //	but IRQs are periodically enabled between whole word transfers. The function will 
 //	recover from vectored spi-using interrupts (recognized only between written data words) 
-//	when these IRQs use the demonstrated "spi_busy spi_irq" handshake. Such IRQs are 
-//	detected and a new SPI op code is issued to permit this function to continue to completion.
+//	that use Enter_6131_ISR( ) and Exit_6131_ISR( ) with their own Memory Address Pointer.
+//	Such IRQs are detected and a new SPI op code is issued to continue to completion.
 // 
+// 	param 	write_data[] array containing 16-bit words to be written, write_data[0] is written first
+// 	param 	number_of_words is the number of words to be written from write_data[]
 // 	param 	inc_pointer_first specifies pointer adjust value (0,1 or 2 only) before writing
 //      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
 //	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
 //
-//	The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//	can initialize a new transfer whether/not SPI RxData register has unread
-//	data. To speed up SPI operations by taking advantnage of the WDRBT
-//	option, several statements are commented-out in the function below.
-//
-unsigned char Write_6131_Buffer(unsigned short write_data[], unsigned char inc_pointer_first, unsigned char irq_mgmt) {
+unsigned char Write_6131_Buffer(unsigned short write_data[], unsigned short number_of_words, unsigned char inc_pointer_first, unsigned char irq_mgmt) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short i, len;
-    //unsigned short dummy;
+    unsigned short i;
 
     // inc_pointer_first parameter determines SPI op code value, must be 0,1 or 2 only
     if(inc_pointer_first > 2) return ('F');
@@ -887,21 +963,10 @@ unsigned char Write_6131_Buffer(unsigned short write_data[], unsigned char inc_p
     if(irq_mgmt)  __disable_interrupt();	 
     // variable tested by vectored interrupt routine
     spi_busy = 1;				         
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
     // Send SPI op code i to write using adjusted pointer value
-    spi->SPI_TDR = i | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    // dummy = spi->SPI_RDR & 0xFFFF;        
-    len = sizeof(write_data);
+    spi_start(i);
     
-    for (i = 0; i < len; i++) {
+    for (i = 0; i < number_of_words; i++) {
 
 	if(irq_mgmt) __enable_interrupt();
 	// Before writing the next word, momentarily enable IRQs...
@@ -913,60 +978,113 @@ unsigned char Write_6131_Buffer(unsigned short write_data[], unsigned char inc_p
 
 	if(spi_irq) {
 		// the multi-word transfer was disturbed, but the interrupt's
-		// ISR should have used a different Memory Address Pointer and
-                // reenabled the Memory Address Pointer we were using, so our
-		// MAP points to the next word to be write. Issue a new SPI 
-		// op code to resume a multi-word write process, starting at the 
-		// RAM location addressed by the Memory Address Pointer value. 
-		// Assert SPI chip select
-		AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-		// Wait for TDR and shifter = empty
-		// while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-		// Send SPI op code to resume writing using existing pointer value
-		spi->SPI_TDR = 0xC0 | SPI_PCS(BOARD_6131_NPCS);
-		// Wait for TDRE flag (Tx Data Register Empty)
-		while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-		// Wait for RDRF flag (Rx Data Register Full)
-		// while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-		// Read and discard received data char in Rx buffer
-		// dummy = spi->SPI_RDR & 0xFFFF;
+		// ISR used its own Memory Address Pointer and re-enabled the
+                // Memory Address Pointer we were using, so our MAP points to
+		// the next word to be written. Chip select was negated by 
+		// Enter_6131_ISR( ): issue a new SPI op code 0xC0 to resume the
+		// multi-word write at the RAM location addressed by the MAP. 
+                spi_start(0xC0);
 		spi_irq = 0;
 	}
-        // transmit next data word a byte at a time
-                
-        // Wait for TDR and shifter = empty
-        // while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit upper byte
-        spi->SPI_TDR = ((char)(write_data[i] >> 8)) | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        // dummy = spi->SPI_RDR & 0xFFFF;
-    
-        // Wait for TDR and shifter = empty
-        // while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit lower byte
-        spi->SPI_TDR = ((char)(write_data[i])) | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        // while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        // dummy = spi->SPI_RDR & 0xFFFF;                            
+        // transmit next data word
+        spi_put(write_data[i]);
     }
-    // prevent warning: variable dummy was set but never used
-    // dummy = dummy;
+    spi_stop();
     spi_busy = 0;
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
     // re-enable interrupts, if IRQs managed at this level 
     if(irq_mgmt)  __enable_interrupt();	
     return ('P');
 }
 
 
+// 	This function writes N 16-bit words from a caller array to sequential HI-6131 register 
+//	or RAM locations, beginning at the specified address. All N words are streamed under 
+//	a single write op code, so a block costs one MAP load and one op code instead of one
+//	op code and chip select cycle per word as with repeated Write_6131_1word( ) calls.
+//
+//	The function uses Memory Address Pointer MAP_BULK (MAP3). The incoming enabled MAP is 
+//	re-enabled when finished, so the caller's MAP value is undisturbed. 
+//
+//	Descriptor tables: the Memory Address Pointer does not auto-increment when the next 
+//	word is an RT Descriptor Table Control Word. When param dtable is non-zero, MAP3 is
+//	reloaded and a new op code issued at every 4-word boundary (address 0xNNN0, 0xNNN4,
+//	0xNNN8, 0xNNNC). RT DESCRIPTOR TABLE(S) MUST START AT A BASE ADDRESS 0xNNN0.
+//
+//	If parameter irq_mgmt is non-zero, IRQs are momentarily enabled between written 
+//	words, so interrupt latency is about one word time. An spi-using interrupt recognized
+//	there must bracket its accesses with Enter_6131_ISR( ) and Exit_6131_ISR( ) using its
+//	own MAP. MAP3 then still holds the next address and is enabled again on return, so
+//	this function resumes with chip select and a new op code only.
+//
+// 	param 	address is the HI-6131 address for the first word, src[0]
+// 	param 	src is the caller array containing the words to be written
+// 	param 	count is the number of words to be written
+// 	param 	dtable is non-zero if the address range includes RT descriptor table(s)
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//	Returns 'F' for a null array pointer or zero count, otherwise 'P'.
+//
+unsigned char Write_6131_Block(unsigned short address, const unsigned short *src, unsigned short count, unsigned char dtable, unsigned char irq_mgmt) {
+
+    unsigned short i;
+    unsigned char savemap, reload;
+
+    if((src == 0) || (count == 0)) return ('F');
+
+    // disable interrupts, if IRQs managed at this level
+    if(irq_mgmt)  __disable_interrupt();	 
+    // we will restore the active MAP when finished, Master Config bits 11-10
+    savemap = (unsigned char)((Read_6131_MasterConfig(0) >> 10) & 0x0003);
+    // writing register 0 through MAP3 bypasses the shadow copy
+    if(address == MASTER_CONFIG_REG) Invalidate_6131_MasterConfig();
+    // our MAP, loaded with the first address below
+    SPIopcode_noirq(enMAP1 + MAP_BULK - 1);
+    // variable tested by Enter_6131_ISR( )
+    spi_busy = 1;
+    spi_irq = 0;
+
+    for (i = 0; i < count; i++, address++) {
+
+        // first word, or MAP does not auto-increment onto a descriptor Control Word
+        reload = (i == 0) || (dtable && ((address & 0x0003) == 0));
+        if(reload) {
+            // chip select may already be negated by an interrupt
+            if(i && !spi_irq) spi_stop();
+            // load MAP3 with the next write address then issue write op code 0xC0
+            Write_6131LowReg(MAP_REG(MAP_BULK), address, 0);
+            spi_start(0xC0);
+        }
+        else if(spi_irq) {
+            // an interrupt negated chip select. MAP3 is enabled again and 
+            // still holds this address, so only the op code is needed
+            spi_start(0xC0);
+        }
+        spi_irq = 0;
+        // transmit next data word
+        spi_put(src[i]);
+
+        if(irq_mgmt) {
+            // Before writing the next word, momentarily enable IRQs. If an interrupt
+            // service routine uses SPI, Enter_6131_ISR( ) sets spi_irq and the loop 
+            // above resumes.
+            __enable_interrupt();
+            __disable_interrupt();
+        }
+    }
+    // chip select may already be negated by an interrupt after the last word
+    if(!spi_irq) spi_stop();
+    spi_busy = 0;
+    spi_irq = 0;
+    // restore original MAP by single op code
+    SPIopcode_noirq(enMAP1 + savemap);
+    // re-enable interrupts, if IRQs managed at this level 
+    if(irq_mgmt)  __enable_interrupt();	
+
+    return ('P');
+}
+
+
 
 // 	After changing the Memory Address Pointer register in the HI-6131, this function reads one 
 //	or more 16-bit words from sequential RAM. Before reading data, the pre-existing pointer value 
@@ -997,27 +1115,18 @@ unsigned char Write_6131_Buffer(unsigned short write_data[], unsigned char inc_p
 //	used with parameter irq_mgmt = 1. In this mode, IRQs are disabled during spi intervals,
 //	but IRQs are periodically enabled between whole word transfers. The function will 
 //	recover from vectored spi-using interrupts (recognized only between read data words) 
-//	when these IRQs use the demonstrated "spi_busy spi_irq" handshake. Such IRQs are 
-//	detected and a new SPI op code is issued to permit this function to continue to completion.
+//	that use Enter_6131_ISR( ) and Exit_6131_ISR( ) with their own Memory Address Pointer.
+//	Such IRQs are detected and a new SPI op code is issued to continue to completion.
 // 
 // 	param 	number_of_words is the array size 
 // 	param 	inc_pointer_first specifies pointer adjust value (0,1 or 2 only) before reading
 //      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
 //	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
 //
-//	The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//	can initialize a new transfer whether/not SPI RxData register has unread
-//	data. To speed up SPI operations by taking advantnage of the WDRBT
-//	option, several statements are commented-out in the function below.
-//
 unsigned char Read_6131_Buffer(unsigned short number_of_words, unsigned char inc_pointer_first, unsigned char irq_mgmt) {
 // revised on 6/4/14
   
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    volatile unsigned char bufferRX[2];
     unsigned short i;
-    unsigned short dummy;
-    unsigned char data;
     
 
     // inc_pointer_first parameter determines SPI op code value, must be 0,1 or 2 only
@@ -1029,21 +1138,11 @@ unsigned char Read_6131_Buffer(unsigned short number_of_words, unsigned char inc
     if(irq_mgmt)  __disable_interrupt();	 
     // variable tested by vectored interrupt routine
     spi_busy = 1;				         
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
     // Send SPI op code i to read using adjusted pointer value
-    spi->SPI_TDR = i | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    dummy = spi->SPI_RDR & 0xFFFF;        
+    spi_start(i);
 
     for ( i = 0; i < number_of_words; i++ )	{
-	__enable_interrupt();
+	if(irq_mgmt) __enable_interrupt();
 	// Before writing the next word, momentarily enable IRQs...
 	// A pending IRQ that occurred since last __disable_interrupt() will be 
         // recognized here. Its ISR (int.svc routine) will execute, probably 
@@ -1053,66 +1152,18 @@ unsigned char Read_6131_Buffer(unsigned short number_of_words, unsigned char inc
 
 	if(spi_irq) {
           // the multi-word transfer was disturbed, but the interrupt's
-          // ISR should have used a different Memory Address Pointer and
-          // reenabled the Memory Address Pointer we were using, so our
-          // MAP points to the next word to be write. Issue a new SPI 
-          // op code to resume a multi-word write process, starting at the 
-          // RAM location addressed by the Memory Address Pointer value. 
-          // Assert SPI chip select
-          AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-          // Wait for TDR and shifter = empty
-          while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-          // Send SPI op code 0x40 to resume reading using existing pointer value
-          spi->SPI_TDR = 0x40 | SPI_PCS(BOARD_6131_NPCS);
-          // Wait for TDRE flag (Tx Data Register Empty)
-          while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-          // Wait for RDRF flag (Rx Data Register Full)
-          while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-          // Read and discard received data char in Rx buffer
-          dummy = spi->SPI_RDR & 0xFFFF;
+          // ISR used its own Memory Address Pointer and re-enabled the
+          // Memory Address Pointer we were using, so our MAP points to
+          // the next word to be read. Chip select was negated by 
+          // Enter_6131_ISR( ): issue a new SPI op code 0x40 to resume the
+          // multi-word read at the RAM location addressed by the MAP. 
+          spi_start(0x40);
           spi_irq = 0;
         }
-	// Read first byte 
-        read_data[i] = 0;         // clear buffer first
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data byte 0x00 to start receive
-        spi->SPI_TDR = 0x00 | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (dummy=0; dummy<5; dummy++);
-        // Read received data char in Rx buffer
-        data = spi->SPI_RDR;
-        printf("%.2X", (char)data);
-        read_data[i] =  (unsigned int)data << 8;                
-
-       // Get the second byte 
-        
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data to receive lower byte
-        spi->SPI_TDR = (0x00 | SPI_PCS(BOARD_6131_NPCS));
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (dummy=0; dummy<5; dummy++);
-        // Read lower byte
-        data = spi->SPI_RDR;// & 0xFF;
-        printf("%.2X ", (char)data);
-        read_data[i] |=  (unsigned int)data; 
-        printf("%.2X ", (char)data);        
+        // receive next data word
+        read_data[i] = spi_get();
     }
-    // prevent warning: variable dummy was set but never used
-    dummy = dummy;
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    spi_stop();
     spi_busy = 0;
     // re-enable interrupts, if IRQs managed at this level 
     if(irq_mgmt)  __enable_interrupt();	
@@ -1123,7 +1174,7 @@ unsigned char Read_6131_Buffer(unsigned short number_of_words, unsigned char inc
 
 //  This function reads a single 16-bit value from the RAM location pointed to by the 
 //  specified RT1 or RT2 Current Control Word Address register. The function transmits 
-//  an 8-bit op code, then receives the data word as two bytes. The data is returned as 
+//  an 8-bit op code, then receives the data word. The data is returned as 
 //  a word. The function copies the specified RT1 or RT2 Current Control Word Address 
 //  register to the enabled Memory Address Pointer register before reading the word.
 //	The data character received during op code transmission is discarded.
@@ -1138,64 +1189,22 @@ unsigned char Read_6131_Buffer(unsigned short number_of_words, unsigned char inc
 //    param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
 //			  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
 //
-//	The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//	can initialize a new transfer whether/not SPI RxData register has unread
-//	data. To speed up SPI operations by taking advantnage of the WDRBT
-//	option, several statements are commented-out in the function below.
-//
 unsigned short Read_Current_Control_Word(unsigned char rt_num, unsigned char irq_mgmt) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short dummy;
     unsigned char opcode;
-    unsigned short data, i;
-    volatile unsigned char bufferRX[2];
+    unsigned short data;
 
-    // disable interrupts, if IRQs managed at this level
-    if(irq_mgmt)  __disable_interrupt();	 
-        
     if(rt_num == 2) opcode = 0x50;
     else opcode = 0x48;
              
+    // disable interrupts, if IRQs managed at this level
     if(irq_mgmt)  __disable_interrupt();
-    // variable tested by vectored interrupt routine 
-    spi_busy = 1;				
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send SPI op code 
-    spi->SPI_TDR = opcode | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    dummy = spi->SPI_RDR & 0xFFFF;
-                                                     
-    // receive 2 bytes register data, transmit 2 dummy data bytes
-    for (i = 0; i < 2; i++) {
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data byte 0x00 to start receive
-        spi->SPI_TDR = 0x00 | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (dummy=0; dummy<2; dummy++);
-        // Read received data char in Rx buffer
-        bufferRX[i] = spi->SPI_RDR & 0xFFFF;
-    }    
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    // Send SPI op code, then receive data word
+    spi_start(opcode);
+    data = spi_get();
+    spi_stop();
     // re-enable interrupts, if IRQs managed at this level 
     if(irq_mgmt)  __enable_interrupt();	
-    // concantenate (merge) 2 data bytes into 16-bit value
-    data =  (unsigned int)bufferRX[0] << 8;
-    data |= (unsigned int)bufferRX[1];
         
     return data;
 }
@@ -1228,11 +1237,6 @@ unsigned short Read_Current_Control_Word(unsigned char rt_num, unsigned char irq
 //      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
 //	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
 //
-//		The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//		can initialize a new transfer whether/not SPI RxData register has unread
-//		data. To speed up SPI operations by taking advantnage of the WDRBT
-//		option, several statements are commented-out in the function below.
-//
 unsigned short Read_RT1_Control_Word(unsigned char txrx, unsigned char samc, unsigned char number, unsigned char irq_mgmt) {
 
 	unsigned short address = 0, data;
@@ -1266,7 +1270,7 @@ unsigned short Read_RT1_Control_Word(unsigned char txrx, unsigned char samc, uns
 
 	if(irq_mgmt) __disable_interrupt();		// disable interrupts, if IRQs managed at this level 
 
-	data = Read_6131LowReg(RT1_DESC_TBL_BASE_ADDR_REG,0);
+	data = READ_6131_REG(RT1_DESC_TBL_BASE_ADDR_REG,0);
 
 	address += data;		// add table base addr to offset, then load mem addr ptr 
 
@@ -1317,7 +1321,7 @@ unsigned short Read_RT2_Control_Word(unsigned char txrx, unsigned char samc, uns
 
 	if(irq_mgmt) __disable_interrupt();		// disable interrupts, if IRQs managed at this level 
 
-	data = Read_6131LowReg(RT2_DESC_TBL_BASE_ADDR_REG,0);
+	data = READ_6131_REG(RT2_DESC_TBL_BASE_ADDR_REG,0);
 
 	address += data;		// add table base addr to offset, then load mem addr ptr 
 
@@ -1337,7 +1341,7 @@ unsigned short Read_RT2_Control_Word(unsigned char txrx, unsigned char samc, uns
 //  This function reads a single 16-bit value from the RAM location pointed	to by
 //  the enabled Memory Address Pointer, then advances that Memory Address Pointer
 //  value by 4 RAM addresses. The function transmits an 8-bit op code, then 
-//  receives the addressed data word as two bytes. The data is returned as a word.
+//  receives the addressed data word. The data is returned as a word.
 //  The data character received during op code transmission is discarded.
 //
 //  Design Intent: The host can easily read successive descriptor table Control
@@ -1355,55 +1359,18 @@ unsigned short Read_RT2_Control_Word(unsigned char txrx, unsigned char samc, uns
 //  param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
 //	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
 //
-//  The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//  can initialize a new transfer whether/not SPI RxData register has unread
-//  data. To speed up SPI operations by taking advantnage of the WDRBT
-//  option, several statements are commented-out in the function below.
-//
 unsigned short ReadWord_Adv4(unsigned char irq_mgmt) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short data, i;
-    volatile unsigned char bufferRX[2];
+    unsigned short data;
         
     // disable interrupts, if IRQs managed at this level
     if(irq_mgmt)  __disable_interrupt();	 
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send 8-bit SPI op code 0x60
-    spi->SPI_TDR = 0x60 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read received data char in Rx buffer, discard/overwrite below
-    bufferRX[0] = spi->SPI_RDR & 0xFFFF;
-
-    // receive 2 bytes register data, transmit 2 dummy data bytes
-    for (i = 0; i < 2; i++) {
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data to receive next byte
-        spi->SPI_TDR = 0x0 | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (data=0; data<2; data++);
-        // Read received data char in Rx buffer
-        bufferRX[i] = spi->SPI_RDR & 0xFFFF;
-    }    
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    // 8-bit SPI op code 0x60, then receive data word
+    spi_start(0x60);
+    data = spi_get();
+    spi_stop();
     // re-enable interrupts, if IRQs managed at this level 
     if(irq_mgmt)  __enable_interrupt();	
-    // merge 2 data bytes into 16-bit value
-    data =  (unsigned int)bufferRX[0] << 8;
-    data |= (unsigned int)bufferRX[1];
         
     return data;
 }
@@ -1430,8 +1397,8 @@ unsigned short ReadWord_Adv4(unsigned char irq_mgmt) {
 // returning IAW then IIW word pairs, in reverse order of interrupt occurence (last in, first out).
 //
 // This function reads the last Interrupt Address Word (IAW) written to the HI-6131 Interrupt 
-// Log buffer. The function transmits the 8-bit 0x58 op code, then receives the IAW word as two 
-// bytes, returned as a word. Upon return, the memory address pointer points to the IIW Interrupt
+// Log buffer. The function transmits the 8-bit 0x58 op code, then receives the IAW word, 
+// returned as a word. Upon return, the memory address pointer points to the IIW Interrupt
 // Information Word corresponding to the returned IAW. The data character received during op code 
 // transmission is discarded.
 //
@@ -1441,59 +1408,169 @@ unsigned short ReadWord_Adv4(unsigned char irq_mgmt) {
 //      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
 //	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
 //
-//		The MCU's SPI mode register is written with option WDRBT = 0 so Master
-//		can initialize a new transfer whether/not SPI RxData register has unread
-//		data. To speed up SPI operations by taking advantnage of the WDRBT
-//		option, several statements are commented-out in the function below.
-//
 unsigned short Read_Last_Interrupt(unsigned char irq_mgmt) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short data, i;
-    volatile unsigned char bufferRX[2];
+    unsigned short data;
         
     // disable interrupts, if IRQs managed at this level
     if(irq_mgmt)  __disable_interrupt();	 
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send 8-bit SPI op code 
-    spi->SPI_TDR = 0x58 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read received data char in Rx buffer, discard/overwrite below
-    bufferRX[0] = spi->SPI_RDR & 0xFFFF;
-
-    // receive 2 bytes register data, transmit 2 dummy data bytes
-    for (i = 0; i < 2; i++) {
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit dummy data to receive next byte
-        spi->SPI_TDR = 0x0 | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-        while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // without this next delay, the ARM SPI reads wrong value in RDR!
-        // I see good data shifting out from HI-6131 but RxData register value is wrong
-        for (data=0; data<2; data++);
-        // Read received data char in Rx buffer
-        bufferRX[i] = spi->SPI_RDR & 0xFFFF;
-    }    
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
-		
+    // 8-bit SPI op code 0x58, then receive data word
+    spi_start(0x58);
+    data = spi_get();
+    spi_stop();
     // re-enable interrupts, if IRQs managed at this level 
     if(irq_mgmt)  __enable_interrupt();	
-    // merge 2 data bytes into 16-bit value
-    data =  (unsigned int)bufferRX[0] << 8;
-    data |= (unsigned int)bufferRX[1];
     // return last interrupt's IAW, the MAP points to matching IIW    
     return data;
 }
+
+
+
+// This function reads the interrupt management registers into a snapshot with
+// MAP bursts using Read_6131_MAP( ): 4 words (pending registers 0x06-0x09), 5
+// words (adding the Interrupt Count & Log Address register 0x0A), 12 words (the
+// pending registers, then the enable and output enable registers 0x0F-0x16 in
+// a second burst) or 8 words (0x0F-0x16 only). This replaces a MAP load and a
+// read per register, and all pending sources are captured at the same instant.
+//
+// Reading clears the pending registers: bits returned here are no longer
+// pending in the device, and with IRQ_HANDLING the interrupt service would not
+// see them. Reading register 0x0A clears its interrupt count, which the
+// interrupt log drain in 613x_irq.c uses to detect overwritten entries, so only
+// the interrupt service asks for INT_REGS_LOG. INT_REGS_CONFIG clears nothing.
+// The enabled MAP is left pointing past the last register read.
+//
+// An interrupt service routine calls this between Enter_6131_ISR( ) and Exit_6131_ISR( )
+// with irq_mgmt = 0, so the burst uses the ISR's own MAP.
+//
+//	param	regs receives the register values. Members not read are not
+//		written.
+//	param	what is INT_REGS_PENDING, INT_REGS_LOG, INT_REGS_ALL or
+//		INT_REGS_CONFIG
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//	Returns 'F' for an illegal parameter, otherwise 'P'.
+//
+unsigned char Read_6131_IntRegs(INT_6131_REGS *regs, unsigned char what, unsigned char irq_mgmt) {
+
+    unsigned char i;
+    unsigned short words[12];
+
+    if(regs == 0) return('F');	// illegal parameter
+    if(what > INT_REGS_CONFIG) return('F');
+
+    // disable interrupts, if IRQs managed at this level
+    if(irq_mgmt)  __disable_interrupt();
+    switch(what) {
+        case INT_REGS_PENDING:
+            Read_6131_MAP(HDW_PENDING_INT_REG, words, 4, 0);
+            break;
+        case INT_REGS_LOG:
+            Read_6131_MAP(HDW_PENDING_INT_REG, words, 5, 0);
+            break;
+        case INT_REGS_ALL:
+            // pending regs, then 0x0F-0x16 past Int Count & Log Addr and MAP1-4
+            Read_6131_MAP(HDW_PENDING_INT_REG, words, 4, 0);
+            Read_6131_MAP(HDW_INT_ENABLE_REG, words + 4, 8, 0);
+            break;
+        default:    // INT_REGS_CONFIG
+            Read_6131_MAP(HDW_INT_ENABLE_REG, words + 4, 8, 0);
+            break;
+    }
+    // re-enable interrupts, if IRQs managed at this level 
+    if(irq_mgmt)  __enable_interrupt();
+
+    if(what != INT_REGS_CONFIG) {
+        for(i = 0; i < 4; i++) regs->pending[i] = words[i];
+    }
+    if(what == INT_REGS_LOG) regs->count_log = words[4];
+    if((what == INT_REGS_ALL) || (what == INT_REGS_CONFIG)) {
+        for(i = 0; i < 4; i++) {
+            regs->enable[i] = words[4 + i];
+            regs->output[i] = words[8 + i];
+        }
+    }
+    return('P');
+}
+
+
+
+// This function reads N sequential 16-bit words into a caller array through the
+// currently-enabled Memory Address Pointer: the MAP is loaded with the start address,
+// then all N words are read under one 0x40 read op code. There is no MAP switching,
+// no descriptor table handling and no recovery from preempting interrupts, so the 
+// function suits interrupt service routines between Enter_6131_ISR( ) and 
+// Exit_6131_ISR( ), and short reads with interrupts disabled. Use Read_6131_Block( )
+// for long foreground reads.
+//
+// 	param 	address is the HI-6131 address for the first word, stored in dst[0]
+// 	param 	dst is the caller array receiving the words read
+// 	param 	count is the number of words to be read
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//	Returns 'F' for a null array pointer or zero count, otherwise 'P'.
+//
+unsigned char Read_6131_MAP(unsigned short address, unsigned short *dst, unsigned short count, unsigned char irq_mgmt) {
+
+    unsigned short i, map;
+
+    if((dst == 0) || (count == 0)) return('F');	// illegal parameter
+
+    // disable interrupts, if IRQs managed at this level
+    if(irq_mgmt)  __disable_interrupt();
+    // enabled MAP, Master Config bits 11-10
+    map = 0x000B + ((Read_6131_MasterConfig(0) >> 10) & 0x0003);
+    Write_6131LowReg(map, address, 0);
+    // 8-bit SPI op code 0x40, then receive data words
+    spi_start(0x40);
+    for(i = 0; i < count; i++) dst[i] = spi_get();
+    spi_stop();
+    // re-enable interrupts, if IRQs managed at this level 
+    if(irq_mgmt)  __enable_interrupt();
+
+    return('P');
+}
+
+
+// These functions read or write one register or RAM word through the currently-enabled
+// Memory Address Pointer: the MAP is loaded with the address, then one word is read 
+// or written. This is the only path for registers 0x10-0x50 (read) and 0x40-0x50 
+// (write); use the READ_6131_REG( ) and WRITE_6131_REG( ) macros in board_6131.h, 
+// which use the fast access op codes where the register allows it. The enabled MAP
+// is left pointing past the word accessed. Safe in interrupt service routines
+// between Enter_6131_ISR( ) and Exit_6131_ISR( ).
+//
+// 	param 	address is the HI-6131 register or RAM address
+// 	param 	data is the word to be written
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+unsigned short Read_6131_Reg(unsigned short address, unsigned char irq_mgmt) {
+
+    unsigned short data;
+
+    Read_6131_MAP(address, &data, 1, irq_mgmt);
+    return data;
+}
+
+
+unsigned char Write_6131_Reg(unsigned short address, unsigned short data, unsigned char irq_mgmt) {
+
+    // disable interrupts, if IRQs managed at this level
+    if(irq_mgmt)  __disable_interrupt();
+    // enabled MAP, Master Config bits 11-10
+    Write_6131LowReg(0x000B + ((Read_6131_MasterConfig(0) >> 10) & 0x0003), address, 0);
+    // 8-bit SPI op code 0xC0, then data word
+    spi_start(0xC0);
+    spi_put(data);
+    spi_stop();
+    // re-enable interrupts, if IRQs managed at this level 
+    if(irq_mgmt)  __enable_interrupt();
+
+    return('P');
+}
   
 
 	
@@ -1510,15 +1587,15 @@ unsigned short Read_Last_Interrupt(unsigned char irq_mgmt) {
 //  Interrupts are disabled while SPI is in use. 
 //
 //	NOTE: Upper byte of RT Descriptor Table Control Words will not be overwritten
-//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
-//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//  The RAM words are written by Fill_6131_Ranges( ) using DMA. Interrupts are
+//  disabled while the FRAMA bit is changed and between DMA segments.
 //
 void Fill_6131RAM_Offset(void) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
     unsigned short i;
-    unsigned short dummy;
-    volatile unsigned char bufferTX[2];
+    // 32K minus 80 words, each written with its own address
+    static const FILL_RANGE offset_range = { 0x0050, (0x8000 - 0x0050), 0x0050, FILL_INCREMENT };
         	
     __disable_interrupt();
     enaMAP(1);
@@ -1528,54 +1605,11 @@ void Fill_6131RAM_Offset(void) {
     i = Read_6131_1word(0);	 
     Write_6131LowReg(MAP_1,0x004D,0); 
     Write_6131_1word(i|0x1000,0);
+    __enable_interrupt(); 
 
-    // Assert SPI chip select since there was an interrupt
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Issue SPI op code 0xC0: write using existing MAP pointer value.
-    spi->SPI_TDR = 0xC0 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    dummy = spi->SPI_RDR & 0xFFFF;
-
-    // write mem addr pointer with first RAM address
-    Write_6131LowReg(MAP_1,0x0050,0); 
-    // 32K minus 80 words
-    for (i = 0x0050; i < 0x8000; i++) {	 
-	// upper data byte
-	bufferTX[0] = (char)(i >> 8);          
-	// lower data byte
-	bufferTX[1] = (char)i; 
-	// -------------------------------------------		
-        // Wait for TDR and shifter = empty
-        // while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit next byte
-        spi->SPI_TDR = bufferTX[0] | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-	while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-         dummy = spi->SPI_RDR & 0xFFFF;
-	// -------------------------------------------
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit next byte
-        spi->SPI_TDR = bufferTX[1] | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-	while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        dummy = spi->SPI_RDR & 0xFFFF;
-    }
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    Fill_6131_Ranges(&offset_range, 1, 1);
 	
+    __disable_interrupt();
     // read-modify-write Test Control reg 0x004D to reset FRAMA
     Write_6131LowReg(MAP_1,0x004D,0);	
     i = Read_6131_1word(0);	 
@@ -1583,8 +1617,6 @@ void Fill_6131RAM_Offset(void) {
     Write_6131_1word((i & 0x7FFF),0);
 
     __enable_interrupt(); 
-    // prevent warning: variable dummy was set but never used
-    dummy = dummy;
 }
 
 
@@ -1592,8 +1624,8 @@ void Fill_6131RAM_Offset(void) {
 // This function fills a range in HI-6131 RAM space 0x0040-0x7FFF with a specified value.
 // This may be used to clear a range of RAM memory addresses
 //
-// This function should not be used while terminal execution is enabled, 
-// Interrupts are disabled while SPI is in use. 
+// This function should not be used while terminal execution is enabled. 
+// The words are written by Fill_6131_Ranges( ) using DMA. 
 //
 //  param 	addr is first storage address. VALUE MUST EXCEED 0x1F to avoid register space
 //  param 	num_words is the number of 16-bit words to be written, MAXIMUM (0x8000-0x50) = 32688 decimal 
@@ -1601,217 +1633,136 @@ void Fill_6131RAM_Offset(void) {
 ///
 void Fill_6131RAM(unsigned short addr, unsigned short num_words, unsigned short fill_value) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short i;
-    unsigned short dummy;
-    volatile unsigned char bufferTX[2];
-        	
-    __disable_interrupt();
-    enaMAP(1);
-    // write mem addr pointer with first RAM address
-    Write_6131LowReg(MAP_1,addr,0); 
-	
-    // upper data byte
-    bufferTX[0] = (char)(fill_value >> 8);          
-    // lower data byte
-    bufferTX[1] = (char)fill_value; 
+    FILL_RANGE range;
 
-    // Assert SPI chip select since there was an interrupt
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Issue SPI op code 0xC0: write using existing MAP pointer value.
-    spi->SPI_TDR = 0xC0 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    dummy = spi->SPI_RDR & 0xFFFF;
-
-    for (i = num_words; i > 0; i--)	{
-
-	// -------------------------------------------		
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit next byte
-        spi->SPI_TDR = bufferTX[0] | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-	while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        dummy = spi->SPI_RDR & 0xFFFF;
-	// -------------------------------------------
-        // Wait for TDR and shifter = empty
-        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-        // transmit next byte
-        spi->SPI_TDR = bufferTX[1] | SPI_PCS(BOARD_6131_NPCS);
-        // Wait for TDRE flag (Tx Data Register Empty)
-	while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-        // Wait for RDRF flag (Rx Data Register Full)
-        while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-        // Read and discard received data char in Rx buffer
-        dummy = spi->SPI_RDR & 0xFFFF;
+    range.address = addr;
+    range.count = num_words;
+    range.value = fill_value;
+    range.mode = FILL_VALUE;
+    Fill_6131_Ranges(&range, 1, 1);
+}
+
+
+//	This local function writes one FILL_INCREMENT range. Each chunk is built in
+//	one pattern buffer while DMA writes the previous chunk from the other.
+//	Returns 'F' if a burst fails, after the burst in flight has finished.
+//
+static unsigned char fill_increment(const FILL_RANGE *range, unsigned char irq_mgmt) {
+
+    SPI_BURST burst[2];
+    unsigned short address, left, value, n, i;
+    unsigned char b;
+
+    burst[0].done = 1;
+    burst[1].done = 1;
+    address = range->address;
+    left = range->count;
+    value = range->value;
+
+    for(b = 0; left; b ^= 1) {
+        if(left > FILL_CHUNK) n = FILL_CHUNK;
+        else n = left;
+
+        // burst[b] finished before burst[b ^ 1] started, so its buffer is free
+        for(i = 0; i < n; i++) fill_buf[b][i] = value++;
+
+        if(Wait_6131_Burst(&burst[b ^ 1], irq_mgmt) != 'P') return ('F');
+        burst[b].address = address;
+        burst[b].buffer = fill_buf[b];
+        burst[b].count = n;
+        burst[b].direction = BURST_WRITE;
+        burst[b].dtable = 0;
+        burst[b].callback = 0;
+        if(Start_6131_Burst(&burst[b], irq_mgmt) != 'P') {
+            Wait_6131_Burst(&burst[b ^ 1], irq_mgmt);
+            return ('F');
+        }
+
+        address += n;
+        left -= n;
     }
-    // negate slave chip select
-    AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
+    return Wait_6131_Burst(&burst[b ^ 1], irq_mgmt);
+}
 
-    __enable_interrupt(); 
-    // prevent warning: variable dummy was set but never used
-    dummy = dummy;
+
+// 
+// This function fills one or more disjoint HI-6131 RAM ranges in one call, each
+// with a fixed value or an incrementing pattern. Words are streamed by the DMA
+// burst engine through MAP3: a FILL_VALUE range is one burst from a fixed DMA
+// source, a FILL_INCREMENT range is written FILL_CHUNK words per burst. The
+// incoming MAP is re-enabled when finished. 
+//
+// This function should not be used while terminal execution is enabled. The MAP 
+// does not skip descriptor Control Words, so ranges holding RT descriptor tables 
+// need the FRAMA bit set, see Fill_6131RAM_Offset( ).
+//
+//  param 	ranges is an array of num_ranges FILL_RANGE structures
+//  param 	num_ranges is the number of ranges, filled in array order
+//  param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//  Returns 'F' without writing anything if a range has a bad mode or runs past
+//  address 0x7FFF, 'F' if a DMA burst fails, else 'P'.
+///
+unsigned char Fill_6131_Ranges(const FILL_RANGE *ranges, unsigned char num_ranges, unsigned char irq_mgmt) {
+
+    SPI_BURST burst;
+    unsigned short value;
+    unsigned char r;
+
+    if(ranges == 0) return ('F');
+    for(r = 0; r < num_ranges; r++) {
+        if(ranges[r].mode > FILL_INCREMENT) return ('F');
+        if((unsigned long)ranges[r].address + ranges[r].count > 0x8000) return ('F');
+    }
+
+    for(r = 0; r < num_ranges; r++) {
+        if(ranges[r].count == 0) continue;
+
+        if(ranges[r].mode == FILL_INCREMENT) {
+            if(fill_increment(&ranges[r], irq_mgmt) != 'P') return ('F');
+            continue;
+        }
+        value = ranges[r].value;
+        burst.address = ranges[r].address;
+        burst.buffer = &value;
+        burst.count = ranges[r].count;
+        burst.direction = BURST_FILL;
+        burst.dtable = 0;
+        burst.callback = 0;
+        if(Start_6131_Burst(&burst, irq_mgmt) != 'P') return ('F');
+        if(Wait_6131_Burst(&burst, irq_mgmt) != 'P') return ('F');
+    }
+    return ('P');
 }
 
 
 // 
-// This function copies 1024 words from HI-6131 register/RAM address space 
+// This function copies 256 words from HI-6131 register/RAM address space 
 // for console screen display. This only applies for HI-6131 since HI-6130
 // can use Embedded Workbench "Memory Watch Window" for the same purpose. 
 //
-// Press button SW2 to prompt screen refresh, This interrupts C program 
-// execution and uses memory address pointer MAP4. Interrupts will temporarily
-// be disabled during each SPI word transfer. After completion, the incoming 
-// memory address pointer will be re-enabled. If spi_busy = 1 (indicating a 
-// multi-word SPI process was interrupted) flag spi_irq will be set so the
-// interrupted process can resume, assuming interrupted process uses the same
-// interrupt management as this function.
+// The words are first read into a local array by Read_6131_Block( ), which 
+// uses memory address pointer MAP3 and re-enables the incoming memory address 
+// pointer when finished. Interrupts are only disabled during SPI word transfers,
+// not while the screen is printed by print_hex_dump( ). Interrupt service routines
+// that use SPI between words must use Enter_6131_ISR( ) and Exit_6131_ISR( ).
 
 void Memory_watch(unsigned short address) {
 
-    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
-    unsigned short i,j,k,addr;
-    unsigned char savemap, data, mod4=0;
-    unsigned short dummy;
+    unsigned short addr;
+    unsigned short watch_data[256];
 	
-     __disable_interrupt();
-    // we will restore the active MAP when finished
-    savemap = (char)(getMAPaddr() - 0x000A);
-    // use MAP3 
-    enaMAP(3);
     addr = address & 0xFFF0;
-    Write_6131LowReg(MAP_3,addr,0); 
-    
-    // variable tested by vectored interrupt routine 
-    spi_busy = 1;				
-    // Assert SPI chip select
-    AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-    // Wait for TDR and shifter = empty
-    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-    // Send SPI op code 
-    spi->SPI_TDR = 0x40 | SPI_PCS(BOARD_6131_NPCS);
-    // Wait for TDRE flag (Tx Data Register Empty)
-    while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-    // Wait for RDRF flag (Rx Data Register Full)
-    while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-    // Read and discard received data char in Rx buffer
-    dummy = spi->SPI_RDR;// & 0xFFFF;
-                            
-    // 4 groups of 4 lines each
-    for (i = 0; i < 4; i++) { 
-	  // 4 lines preceded by header
-	  printf("\n\rx%.2X%.2X    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F", (char)(addr>>8), (char)addr);
-	  for (j = 0; j < 4; j++) {
-		printf("\n\r");
-		// 16 words / line 
-		for (k = 0; k < 16; k++) {
-                  
-                        // Wait for TDR and shifter = empty
-			while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-			// transmit dummy data to receive upper byte
-			spi->SPI_TDR = (0x00 | SPI_PCS(BOARD_6131_NPCS));
-			// Wait for TDRE flag (Tx Data Register Empty)
-			while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-			// Wait for RDRF flag (Rx Data Register Full)
-			while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-                        // without this next delay, the ARM SPI reads wrong value in RDR!
-                        // I see good data shifting out from HI-6131 but RxData register value is wrong
-                        for (dummy=0; dummy<5; dummy++);
-			// Read upper byte
-			data = spi->SPI_RDR;// & 0xFF;
-			printf("%.2X", (char)data);
-
-                        // Wait for TDR and shifter = empty
-                        while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-			// transmit dummy data to receive lower byte
-			spi->SPI_TDR = (0x00 | SPI_PCS(BOARD_6131_NPCS));
-			// Wait for TDRE flag (Tx Data Register Empty)
-			while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-			// Wait for RDRF flag (Rx Data Register Full)
-			while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-                        // without this next delay, the ARM SPI reads wrong value in RDR!
-                        // I see good data shifting out from HI-6131 but RxData register value is wrong
-                        for (dummy=0; dummy<5; dummy++);
-			// Read lower byte
-			data = spi->SPI_RDR;// & 0xFF;
-			printf("%.2X ", (char)data);
-                                
-                        // this next part provides normal operation when reading RT Descriptor tables.
-                        // MAP does not auto-increment when the next word is a descriptor Control Word.
-                        // every 4th word we reload MAP to force increment, d-table words 4,8,12, etc.
-                        // Behavior applies even when not accessing d-tables, AND ASSUMES RT DESCRIPTOR
-                        // TABLE(S) START AT BASE ADDRESS WITH 4-LSB'S = 0, any 0xNNN0: 0x0400, 0x04F0.
-                        // DESCRIPTOR TABLE START ADDRESS CANNOT EXCEED 0x7E00...
-			addr++;
-                        mod4++;
-                        if (mod4 == 4) {
-                            mod4 = 0;
-                            // negate slave chip select. Below we reload MAP to force increment, 
-                            // then issue a new read op code 0x40 to resume read at next address
-                            AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
-                        }
-			// Before reading the next word, momentarily enable IRQs...
-			__enable_interrupt();
-			// A pending IRQ that occurred since last disable_interrupt() will be recognized here.
-			// Its int.service routine probably used SPI, disrupting our multi-word transfer. As long
-			// as the interrupt routine sets the spi_irq flag, we can recover. When the interrupt is
-                        // finished, execution resumes at this next disable_interrupt() call, ...
-				
-			__disable_interrupt();
-                        
-                        if(spi_irq) enaMAP(4);
-                          
-			if(spi_irq || (mod4==0)) {
-				spi_irq = 0;
-				// Reload MAP4 with the next read address, then issue a new SPI op code 0x40
-                                // to resume our multi-word read process where it left off. This occurs after
-                                // interrupt, or when new mod4 = 0, i.e., addr = 0xXXX0, 0xXXX4,0xXXX8 or 0xXXXC.
-                                Write_6131LowReg(MAP_3,addr,0); 
-				
-				// Wait for TDR and shifter = empty in case spi not idle
-				while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
-				// Negate then assert SPI chip select since there was an interrupt
-				AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; // faster than PIO_Set(pinNss);
-				AT91C_BASE_PIOA->PIO_CODR = SPI_nCS; // faster than PIO_Clear(pinNss); 
-				// Issue SPI op code 0x40: write using existing MAP pointer value.
-				spi->SPI_TDR = 0x40 | SPI_PCS(BOARD_6131_NPCS);
-				// Wait for TDRE flag (Tx Data Register Empty)
-				while ((spi->SPI_SR & AT91C_SPI_TDRE) == 0);
-				// Wait for RDRF flag (Rx Data Register Full)
-				while ((spi->SPI_SR & AT91C_SPI_RDRF) == 0);
-				// Read and discard received data char in Rx buffer
-				dummy = spi->SPI_RDR & 0xFFFF;
-                        } 
-                        
-                }   // end for(k = 0; k < 16; k++)
-	  }         // end for(j = 0; j < 4; j++)
-    }               // end for (i = 0; i < 4; i++)
-    
-	// negate slave chip select
-        AT91C_BASE_PIOA->PIO_SODR = SPI_nCS; 
+    // 256 words, every 4th word may be a descriptor table Control Word
+    Read_6131_Block(addr, watch_data, 256, 1, 1);
 
+    print_hex_dump(addr, watch_data, 256);
+    
 	printf("\n\r===============================================================================");
 	printf("\n\rKeys: (W)atch On/Off  (D)own  (U)p  (R)efresh  (A)ddress  (M)enu  ");
-        printf("0x%.2X%.2X-0x%.2X%.2X", (char)((addr-256)>>8),(char)(addr-256),(char)((addr-1)>>8),(char)(addr-1));
+        printf("0x%.2X%.2X-0x%.2X%.2X", (char)(addr>>8),(char)addr,(char)((addr+255)>>8),(char)(addr+255));
 	printf("\n\r===============================================================================\n\r");
-	//          
-	spi_busy = 0;
-        // prevent warning
-        dummy = dummy;
-        
-	// restore original MAP
-	enaMAP(savemap);
-        
-	__enable_interrupt();
         
 }    // end 
 
@@ -1853,12 +1804,13 @@ void Memory_watch(unsigned short address) {
 
 
 //      This function returns the address of the currently enabled Memory Address Pointer
-//      register, either 0x000B, 0x000C, 0x000D or 0x000E
+//      register, either 0x000B, 0x000C, 0x000D or 0x000E. Usually no SPI access, the
+//      Master Configuration register comes from the host shadow copy
 //
 unsigned short getMAPaddr(void) {
       // bits 11-10 of Master Configuration reg
       unsigned short i;
-      i = Read_6131LowReg(MASTER_CONFIG_REG, 1) >> 10;
+      i = Read_6131_MasterConfig(1) >> 10;
       i = 0x000B + (i & 0x0003);
       return i;
 }
@@ -1866,21 +1818,105 @@ unsigned short getMAPaddr(void) {
 
 
 //      This function enables the Memory Address Pointer specified by the map_num parameter.
+//      The single-byte op code enMAP1-enMAP4 updates Master Configuration bits 11-10 
+//      without a read-modify-write of the register.
 //      param   map_num must be: 1 enables MAP1 at register address 0x000B, 
 //                               2 enables MAP2 at register address 0x000C, 
 //                               3 enables MAP3 at register address 0x000D 
 //                            or 4 enables MAP4 at register address 0x000E
 //
 void enaMAP(unsigned char map_num) {
-      // read-modify-write Master Configuration reg, updating bits 11-10
-      unsigned short i;
-      unsigned short j = (map_num-1) << 10;
-      // j = 0 for MAP1, 0x0400 for MAP2, 0x0800 for MAP3, 0x0C00 for MAP4
-      i = Read_6131LowReg(MASTER_CONFIG_REG, 1) & ~0x0C00;
-      j |= i;
-      Write_6131LowReg(MASTER_CONFIG_REG, j, 1);
+
+      if((map_num < 1) || (map_num > 4)) return;  // illegal parameter
+      SPIopcode(enMAP1 + map_num - 1);
 }
-      
+
+
+
+//      This function returns the Master Configuration register 0 value. The host is the
+//      only writer of this register, so after the first read following reset the value 
+//      comes from a shadow copy with no SPI access. Writes by Write_6131LowReg( ) and MAP 
+//      enable op codes keep the copy current. The BC start bit always reads as 0. 
+//
+//      Call Invalidate_6131_MasterConfig( ) after writing register 0 any other way, 
+//      e.g. through a Memory Address Pointer, or after device reset. If a DMA burst
+//      is running, this function first waits for it to finish.
+//
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+unsigned short Read_6131_MasterConfig(unsigned char irq_mgmt) {
+
+      // a running burst has MAP3 enabled, wait until it re-enables the incoming MAP
+      spi_dma_wait(irq_mgmt);
+      // device read reloads the shadow copy
+      if(!mcfg_valid) return Read_6131LowReg(MASTER_CONFIG_REG, irq_mgmt) & ~MCFG_BCSTRT;
+      return mcfg_shadow;
+}
+
+
+
+//      This function discards the Master Configuration register shadow copy so the next 
+//      Read_6131_MasterConfig( ) reads the device. Called after HI-6131 reset, which also 
+//      covers auto-initialization from serial EEPROM.
+//
+void Invalidate_6131_MasterConfig(void) {
+
+      mcfg_valid = 0;
+}
+
+
+
+//      This function prepares an interrupt service routine for HI-6131 access and enables
+//      the ISR's own Memory Address Pointer: MAP_MSG_ISR for the message interrupt, 
+//      MAP_HDW_ISR for the hardware interrupt. If a foreground multi-word transfer holds 
+//      chip select between words, its op code is ended here and the transfer resumes by 
+//      itself with a new op code, so the ISR needs no other handshake.
+//
+//      Call with interrupts disabled, i.e. from an ISR that cannot be preempted by another
+//      SPI-using ISR. Pass the return value to Exit_6131_ISR( ) before returning.
+//
+//      param   map_num is the ISR's Memory Address Pointer, 1 to 4
+//
+//      Returns the incoming enabled MAP 1-4, or 0 if map_num is illegal or a DMA burst 
+//      owns the SPI. For 0, the ISR must not access the HI-6131 and does not call 
+//      Exit_6131_ISR( ).
+//
+unsigned char Enter_6131_ISR(unsigned char map_num) {
+
+      unsigned char savemap;
+
+      if((map_num < 1) || (map_num > 4)) return 0;   // illegal parameter
+      if(spi_dma_busy) return 0;
+
+      if(spi_busy && !spi_irq) {
+          // end the foreground op code after its last frame
+          spi_stop();
+          spi_irq = 1;
+      }
+      // incoming MAP, Master Config bits 11-10
+      savemap = (unsigned char)((Read_6131_MasterConfig(0) >> 10) & 0x0003) + 1;
+      TRACE_ISR(1);
+      if(savemap != map_num) SPIopcode_noirq(enMAP1 + map_num - 1);
+
+      return savemap;
+}
+
+
+
+//      This function ends ISR access begun by Enter_6131_ISR( ), re-enabling the incoming 
+//      Memory Address Pointer if the ISR left a different one enabled.
+//
+//      param   savemap is the value returned by Enter_6131_ISR( ), 1 to 4
+//
+void Exit_6131_ISR(unsigned char savemap) {
+
+      if((savemap < 1) || (savemap > 4)) return;     // illegal parameter
+      if(savemap != ((Read_6131_MasterConfig(0) >> 10) & 0x0003) + 1)
+          SPIopcode_noirq(enMAP1 + savemap - 1);
+      TRACE_ISR(0);
+}
+      
 
 
 //-----------------------------------------------------------------------------
@@ -1889,8 +1925,6 @@ void enaMAP(unsigned char map_num) {
 
 void Configure_ARM_MCU_SPI(void) {
   
-    volatile unsigned int uDummy;
-      
     // Configure pins
     PIO_Configure(pinsSPI, PIO_LISTSIZE(pinsSPI));
                       
@@ -1909,30 +1943,1038 @@ void Configure_ARM_MCU_SPI(void) {
 
 
     // write SPI chip select reg for NPCS0
-    SPI_ConfigureNPCS(AT91C_BASE_SPI0, 
-                      BOARD_6131_NPCS,
-                      ((0 << 0)  | // CPOL = SCK inactive state = 0
-                       (1 << 1)  | // NCPHA read data SCK leading edge, chg data trailing edge
-                       (0 << 2)  | // CSNAAT = 0
-                       (0 << 3)  | // CSAAT = 0
-                       (0 << 4)  | // BITS = 8 bit transfers
-                       (3 << 8)  | // SCBR gives SCK = MCLK/N = 48MHz/3 = 16MHz 
-                       (12 << 16)| // DLYBS dly between nCS-SCK = N/MCLK = 12/48 = .25uS
-                       (1 << 24) ) // DLYBCT dly between transfers N x 32/MCLK = 32/48 = .67uS
-    );
+    spi_csr = ((0 << 0)  | // CPOL = SCK inactive state = 0
+               (1 << 1)  | // NCPHA read data SCK leading edge, chg data trailing edge
+               (0 << 2)  | // CSNAAT = 0
+               (0 << 3)  | // CSAAT = 0
+               (0 << 4)  | // BITS = 8 bit transfers
+               (3 << 8)  | // SCBR gives SCK = MCLK/N = 48MHz/3 = 16MHz 
+               (12 << 16)| // DLYBS dly between nCS-SCK = N/MCLK = 12/48 = .25uS
+               (1 << 24) );// DLYBCT dly between transfers N x 32/MCLK = 32/48 = .67uS
+    SPI_ConfigureNPCS(AT91C_BASE_SPI0, BOARD_6131_NPCS, spi_csr);
     
     
     SPI_Enable(AT91C_BASE_SPI0);
 
-    for (uDummy=0; uDummy<100000; uDummy++);
+    // no frame is in progress once TDR and shifter are empty. Discard any
+    // received char and clear the status flags, no timed delay is needed
+    while ((AT91C_BASE_SPI0->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
+    (void)AT91C_BASE_SPI0->SPI_RDR;
+    (void)AT91C_BASE_SPI0->SPI_SR;
 
-    uDummy = AT91C_BASE_SPI0->SPI_SR;
-    uDummy = AT91C_BASE_SPI0->SPI_RDR;
+    // DMA channels for burst transfers
+    Configure_6131_DMA();
 
 }   // end Configure_ARM_MCU_SPI()
 
 
 
+//	This function changes the SPI clock and delay fields of the HI-6131 chip select 
+//	register set by Configure_ARM_MCU_SPI( ). Used by the benchmark in 613x_bench.c
+//	to compare settings. Waits for any transfer in progress to finish first.
+//
+//	param	scbr    SCK = MCLK / scbr, 1-255 (3 = 16MHz at 48MHz MCLK)
+//	param	dlybs   delay from nCS to first SCK = dlybs / MCLK
+//	param	dlybct  delay between consecutive transfers = 32 x dlybct / MCLK
+//
+//	Returns 'F' for scbr = 0 (not allowed), otherwise 'P'.
+//
+unsigned char Set_6131_SPI_Timing(unsigned char scbr, unsigned char dlybs, unsigned char dlybct) {
+
+    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
+
+    if(scbr == 0) return ('F');
+
+    spi_csr = (spi_csr & 0x000000FF) | (scbr << 8) | (dlybs << 16) | ((unsigned int)dlybct << 24);
+
+    __disable_interrupt();
+    while ((spi->SPI_SR & AT91C_SPI_TXEMPTY) == 0);
+    spi->SPI_CSR[BOARD_6131_NPCS] = spi_csr;
+    __enable_interrupt();
+
+    return ('P');
+}
+
+
+//	This function returns the current SCBR, DLYBS and DLYBCT settings
+//
+void Get_6131_SPI_Timing(unsigned char *scbr, unsigned char *dlybs, unsigned char *dlybct) {
+
+    *scbr = (unsigned char)(spi_csr >> 8);
+    *dlybs = (unsigned char)(spi_csr >> 16);
+    *dlybct = (unsigned char)(spi_csr >> 24);
+}
+
+
+//	Local function that writes TUNE_PASSES patterns into the calibration RAM range
+//	at the SPI settings in effect and reads each back, by CPU and by DMA burst.
+//	Patterns toggle every data bit: alternating bits, walking one, walking zero,
+//	and an address-based count. Returns 'P' if every word read back correctly.
+//
+static unsigned char tune_check(void) {
+
+    unsigned short i, pass, data;
+
+    for(pass = 0; pass < TUNE_PASSES; pass++) {
+        for(i = 0; i < TUNE_RAM_WORDS; i++) {
+            switch(pass & 3) {
+                case 0:  data = (i & 1) ? 0xAAAA : 0x5555; break;
+                case 1:  data = 1 << ((i + pass) & 15); break;
+                case 2:  data = ~(1 << ((i + pass) & 15)); break;
+                default: data = (TUNE_RAM_ADDR + i) * 0x9E37 + pass; break;
+            }
+            tune_buf[i] = data;
+        }
+        Write_6131_Block(TUNE_RAM_ADDR, tune_buf, TUNE_RAM_WORDS, 0, 1);
+
+        Read_6131_Block(TUNE_RAM_ADDR, tune_read, TUNE_RAM_WORDS, 0, 1);
+        for(i = 0; i < TUNE_RAM_WORDS; i++) if(tune_read[i] != tune_buf[i]) return ('F');
+
+        // a burst that did not run would leave the CPU read-back in tune_read[ ]
+        if(Read_6131_Burst(TUNE_RAM_ADDR, tune_read, TUNE_RAM_WORDS, 0, 1) != 'P') return ('F');
+        for(i = 0; i < TUNE_RAM_WORDS; i++) if(tune_read[i] != tune_buf[i]) return ('F');
+    }
+    return ('P');
+}
+
+
+//	This function calibrates the HI-6131 SPI clock and delays for this board. Each
+//	setting in tune_timing[ ] is tried, fastest first, by writing and reading back
+//	test patterns in HI-6131 RAM TUNE_RAM_ADDR to TUNE_RAM_ADDR + TUNE_RAM_WORDS - 1.
+//	For a safety margin the setting kept is TUNE_MARGIN entries slower than the
+//	fastest one that passed, and must pass too. The RAM range is saved before and
+//	restored after calibration. Call once after HI-6131 reset, before terminals
+//	start and before interrupts using SPI are enabled.
+//
+//	The chosen SCBR, DLYBS and DLYBCT are returned by Get_6131_SPI_Timing( ).
+//
+//	Returns 'P' when a setting was locked in. Returns 'F' if no setting passed, 
+//	with the settings in effect when called restored.
+//
+unsigned char Tune_6131_SPI_Timing(void) {
+
+    unsigned char i, n, scbr, dlybs, dlybct;
+
+    n = sizeof(tune_timing) / sizeof(tune_timing[0]);
+    Get_6131_SPI_Timing(&scbr, &dlybs, &dlybct);
+    // saved at the settings in effect when called
+    Read_6131_Block(TUNE_RAM_ADDR, tune_save, TUNE_RAM_WORDS, 0, 1);
+
+    // fastest passing setting
+    for(i = 0; i < n; i++) {
+        Set_6131_SPI_Timing(tune_timing[i][0], tune_timing[i][1], tune_timing[i][2]);
+        if(tune_check() == 'P') break;
+    }
+    // back off by the margin, to the first slower setting that passes
+    if(i < n) {
+        i = (i + TUNE_MARGIN < n) ? i + TUNE_MARGIN : n - 1;
+        for( ; i < n; i++) {
+            Set_6131_SPI_Timing(tune_timing[i][0], tune_timing[i][1], tune_timing[i][2]);
+            if(tune_check() == 'P') break;
+        }
+    }
+    if(i == n) Set_6131_SPI_Timing(scbr, dlybs, dlybct);
+
+    Write_6131_Block(TUNE_RAM_ADDR, tune_save, TUNE_RAM_WORDS, 0, 1);
+    return (i < n) ? 'P' : 'F';
+}
+
+
+
+//-----------------------------------------------------------------------------
+//                        DMA Burst Engine
+//-----------------------------------------------------------------------------
+//
+// The functions above move every byte under CPU control, polling TXEMPTY/TDRE/RDRF.
+// The burst engine below moves N-word blocks between HI-6131 registers/RAM and a 
+// caller-supplied buffer using two DMA Controller channels, so the CPU only issues 
+// the MAP load and op code for each segment. During data transfer the SPI is switched 
+// to 16-bit frames: each DMA half-word is one HI-6131 word, upper byte first on the 
+// wire, so buffer words need no byte swapping.
+//
+// Descriptor tables: the Memory Address Pointer does not auto-increment when the 
+// next word is a descriptor Control Word. When the burst's dtable member is non-zero, 
+// the transfer is split into segments ending at every 4-word boundary and MAP3 is 
+// reloaded before each segment, the same rule Read_6131( ) follows with its mod4 
+// reload. As there, RT DESCRIPTOR TABLE(S) MUST START AT A BASE ADDRESS 0xNNN0.
+//
+// While a burst is running the SPI belongs to the DMA. Global spi_dma_busy is set, 
+// and vectored interrupts that use SPI must defer their HI-6131 accesses until it 
+// clears. Foreground accesses wait for it in spi_start( ), so the CPU is only free 
+// while the burst runs if it does not touch the HI-6131. The burst uses MAP3 and 
+// re-enables the incoming MAP when finished.
+
+
+//	This function enables the DMA controller and the two channels used by the
+//	burst engine, and enables the DMAC interrupt that completes bursts.
+//	Called at the end of Configure_ARM_MCU_SPI( ).
+//
+void Configure_6131_DMA(void) {
+
+    volatile unsigned int status;
+
+    PMC_EnablePeripheral(AT91C_ID_HDMA);
+    // enable the DMA controller
+    AT91C_BASE_HDMA->HDMA_EN = 1;
+    // both burst channels idle, interrupts off, discard old status
+    AT91C_BASE_HDMA->HDMA_CHDR = (1 << BOARD_6131_DMA_TX_CH) | (1 << BOARD_6131_DMA_RX_CH);
+    AT91C_BASE_HDMA->HDMA_EBCIDR = 0xFFFFFFFF;
+    status = AT91C_BASE_HDMA->HDMA_EBCISR;
+    // prevent warning: variable status was set but never used
+    status = status;
+
+    burst_active = 0;
+    spi_dma_busy = 0;
+
+    IRQ_ConfigureIT(AT91C_ID_HDMA, 0);
+    IRQ_EnableIT(AT91C_ID_HDMA);
+}
+
+
+
+
+
+//	This local function starts one burst segment: it reloads MAP3 with the next 
+//	address, sends the read or write op code as an 8-bit frame, switches SPI to 
+//	16-bit frames and hands the data words to the DMA controller. The segment 
+//	ends at the next 4-word boundary in d-table mode, otherwise it is as long as 
+//	the DMAC allows. Interrupts must be disabled, or called from DMAC interrupt.
+//
+static void burst_segment(void) {
+
+    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
+#if (HOST_MODEL != YES)
+    AT91PS_HDMA_CH ch;
+#endif
+    unsigned short n;
+
+    // MAP does not auto-increment onto a descriptor Control Word, so stop 
+    // the segment where the next 4-word descriptor block begins
+    if(burst_active->dtable) n = 4 - (burst_addr & 0x0003);
+    else n = BURST_MAX_SEGMENT;
+    if(n > burst_left) n = burst_left;
+    burst_seg = n;
+
+    // write MAP3 with the segment start address
+    burst_spi = 1;
+    Write_6131LowReg(MAP_REG(MAP_BULK), burst_addr, 0);
+
+    // Send SPI op code 0x40 read or 0xC0 write or fill, using MAP current value.
+    // Chip select stays asserted for the data words
+    if(burst_active->direction == BURST_READ) spi_start(0x40);
+    else spi_start(0xC0);
+    burst_spi = 0;
+    TRACE_DMA(n);
+
+    // 16-bit frames for the data words
+    spi->SPI_CSR[BOARD_6131_NPCS] = spi_csr | SPI_CSR_BITS16;
+
+#if (HOST_MODEL == YES)
+    // host build has no DMA controller: move the segment through the simulated
+    // SPI now, then report buffer transfer complete as the DMAC would
+    for(n = 0; n < burst_seg; n++) {
+        if(burst_active->direction == BURST_READ) burst_ptr[n] = sim_6131_frame(0x0000, 16);
+        else if(burst_active->direction == BURST_FILL) sim_6131_frame(burst_ptr[0], 16);
+        else sim_6131_frame(burst_ptr[n], 16);
+    }
+    if(burst_active->direction == BURST_READ)
+        AT91C_BASE_HDMA->HDMA_EBCISR = 1 << BOARD_6131_DMA_RX_CH;
+    else
+        AT91C_BASE_HDMA->HDMA_EBCISR = 1 << BOARD_6131_DMA_TX_CH;
+#else
+    if(burst_active->direction == BURST_READ) {
+        // receive channel: SPI RDR to caller buffer
+        ch = &AT91C_BASE_HDMA->HDMA_CH[BOARD_6131_DMA_RX_CH];
+        ch->HDMA_SADDR = (unsigned int)&spi->SPI_RDR;
+        ch->HDMA_DADDR = (unsigned int)burst_ptr;
+        ch->HDMA_DSCR  = 0;
+        ch->HDMA_CTRLA = n | DMA_CTRLA_HALFWORD;
+        ch->HDMA_CTRLB = DMA_CTRLB_RX;
+        ch->HDMA_CFG   = DMA_CFG_RX;
+        // transmit channel clocks out dummy 0x0000 words
+        ch = &AT91C_BASE_HDMA->HDMA_CH[BOARD_6131_DMA_TX_CH];
+        ch->HDMA_SADDR = (unsigned int)&burst_dummy;
+        ch->HDMA_DADDR = (unsigned int)&spi->SPI_TDR;
+        ch->HDMA_DSCR  = 0;
+        ch->HDMA_CTRLA = n | DMA_CTRLA_HALFWORD;
+        ch->HDMA_CTRLB = DMA_CTRLB_TX_FIXED;
+        ch->HDMA_CFG   = DMA_CFG_TX;
+        // burst segment completes when the last word is received
+        AT91C_BASE_HDMA->HDMA_EBCIER = 1 << BOARD_6131_DMA_RX_CH;
+        // start receiver first so no word is missed
+        AT91C_BASE_HDMA->HDMA_CHER = 1 << BOARD_6131_DMA_RX_CH;
+        AT91C_BASE_HDMA->HDMA_CHER = 1 << BOARD_6131_DMA_TX_CH;
+    }
+    else {
+        // transmit channel: caller buffer to SPI TDR, received chars are ignored.
+        // A fill sends buffer[0] again and again
+        ch = &AT91C_BASE_HDMA->HDMA_CH[BOARD_6131_DMA_TX_CH];
+        ch->HDMA_SADDR = (unsigned int)burst_ptr;
+        ch->HDMA_DADDR = (unsigned int)&spi->SPI_TDR;
+        ch->HDMA_DSCR  = 0;
+        ch->HDMA_CTRLA = n | DMA_CTRLA_HALFWORD;
+        if(burst_active->direction == BURST_FILL) ch->HDMA_CTRLB = DMA_CTRLB_TX_FIXED;
+        else ch->HDMA_CTRLB = DMA_CTRLB_TX;
+        ch->HDMA_CFG   = DMA_CFG_TX;
+        AT91C_BASE_HDMA->HDMA_EBCIER = 1 << BOARD_6131_DMA_TX_CH;
+        AT91C_BASE_HDMA->HDMA_CHER = 1 << BOARD_6131_DMA_TX_CH;
+    }
+#endif
+}
+
+
+
+//	This function starts the DMA burst described by the caller's SPI_BURST structure
+//	and returns without waiting, leaving the CPU free while the DMA controller moves
+//	the words. Completion is signalled by burst->done = 1 and, if not null, by a call
+//	to burst->callback( ). The structure and buffer must stay valid until then.
+//
+//	Meanwhile the SPI belongs to the burst: a foreground HI-6131 access waits in
+//	spi_start( ) until the burst is finished, and SPI-using interrupts defer, see
+//	Enter_6131_ISR( ). A burst already running is finished first. Call from the
+//	foreground only, not from an interrupt or a burst callback.
+//
+//	The callback is called from the DMAC interrupt, or from the function that found
+//	the burst finished while polling, with interrupts disabled. It must not access
+//	the HI-6131.
+//
+//	param	burst->address   first HI-6131 register or RAM address
+//	param	burst->buffer    words read are stored here, or words to write, buffer[0] first.
+//	                         BURST_FILL writes buffer[0] to every word
+//	param	burst->count     number of 16-bit words, 1 or more
+//	param	burst->direction BURST_READ, BURST_WRITE or BURST_FILL
+//	param	burst->dtable    non-zero if the range contains RT descriptor table(s)
+//	param	burst->callback  null, or function called at completion
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//	Returns 'F' for a bad parameter, else 'P'.
+//
+unsigned char Start_6131_Burst(SPI_BURST *burst, unsigned char irq_mgmt) {
+
+    if((burst == 0) || (burst->buffer == 0) || (burst->count == 0)) return ('F');
+    if(burst->direction > BURST_FILL) return ('F');
+
+    // disable interrupts, if IRQs managed at this level
+    if(irq_mgmt)  __disable_interrupt();
+    spi_dma_wait(0);
+
+    // we will restore the active MAP when finished, Master Config bits 11-10 
+    burst_savemap = (unsigned char)((Read_6131_MasterConfig(0) >> 10) & 0x0003);
+    // use our MAP, enabled by single op code
+    SPIopcode_noirq(enMAP1 + MAP_BULK - 1);
+
+    spi_dma_busy = 1;
+    burst->done = 0;
+    burst_active = burst;
+    burst_addr = burst->address;
+    burst_ptr  = burst->buffer;
+    burst_left = burst->count;
+
+    burst_segment();
+    // re-enable interrupts, if IRQs managed at this level 
+    if(irq_mgmt)  __enable_interrupt();
+
+    return ('P');
+}
+
+
+
+//	This local function advances the running burst when the DMA controller reports
+//	the current segment complete: chip select is negated, SPI returns to 8-bit 
+//	frames, and the next segment is started. After the last segment the incoming 
+//	MAP is re-enabled, the done flag is set and the callback (if any) is called.
+//
+//	Called from the DMAC interrupt handler below, or by spi_dma_wait( ) with 
+//	interrupts disabled. Reading the DMAC status register clears it, so only one
+//	caller handles each segment completion.
+//
+static void burst_service(void) {
+
+    AT91S_SPI *spi = BOARD_6131_SPI_BASE;
+    SPI_BURST *burst = burst_active;
+    unsigned int status;
+    unsigned char ch;
+
+    if(!spi_dma_busy || (burst == 0)) return;
+
+    if(burst->direction == BURST_READ) ch = BOARD_6131_DMA_RX_CH;
+    else ch = BOARD_6131_DMA_TX_CH;
+
+    // buffer transfer complete for the channel that ends the segment?
+    status = AT91C_BASE_HDMA->HDMA_EBCISR;
+    if((status & (1 << ch)) == 0) return;
+
+    // negate slave chip select after the last word leaves the shifter, 
+    // ends the op code. Back to 8-bit frames
+    spi_stop();
+    spi->SPI_CSR[BOARD_6131_NPCS] = spi_csr;
+
+    burst_addr += burst_seg;
+    if(burst->direction != BURST_FILL) burst_ptr += burst_seg;
+    burst_left -= burst_seg;
+
+    if(burst_left) {
+        burst_segment();
+        return;
+    }
+
+    // finished, the SPI is free again
+    AT91C_BASE_HDMA->HDMA_EBCIDR = (1 << BOARD_6131_DMA_TX_CH) | (1 << BOARD_6131_DMA_RX_CH);
+    burst_active = 0;
+    spi_dma_busy = 0;
+    // restore original MAP
+    SPIopcode_noirq(enMAP1 + burst_savemap);
+    burst->done = 1;
+    if(burst->callback) burst->callback(burst->buffer, burst->count);
+}
+
+
+
+//	DMA controller interrupt, completes burst segments
+//
+void HDMA_IrqHandler(void) {
+
+    burst_service();
+}
+
+
+
+//	This function waits until a burst started by Start_6131_Burst( ) completes.
+//	The DMAC status is also polled here, so bursts complete with interrupts
+//	disabled. Returns 'P', or 'F' if burst was never started.
+//
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, interrupts are disabled only while polling.
+//
+unsigned char Wait_6131_Burst(SPI_BURST *burst, unsigned char irq_mgmt) {
+
+    if((burst != burst_active) && !burst->done) return ('F');
+
+    while(!burst->done) {
+        if(irq_mgmt)  __disable_interrupt();
+        burst_service();
+        if(irq_mgmt)  __enable_interrupt();
+    }
+    return ('P');
+}
+
+
+
+//	These functions perform a complete DMA burst with Start_6131_Burst( ) and
+//	Wait_6131_Burst( ), and return when finished. Words are read into, or
+//	written from, the caller's buffer.
+//
+//	param	address   first HI-6131 register or RAM address
+//	param	buffer    caller buffer, buffer[0] is the word at address
+//	param	count     number of 16-bit words
+//	param	dtable    non-zero if the range contains RT descriptor table(s)
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//	Returns 'P' when complete, or 'F' if burst could not start.
+//
+unsigned char Read_6131_Burst(unsigned short address, unsigned short *buffer, unsigned short count, unsigned char dtable, unsigned char irq_mgmt) {
+
+    SPI_BURST burst;
+
+    burst.address = address;
+    burst.buffer = buffer;
+    burst.count = count;
+    burst.direction = BURST_READ;
+    burst.dtable = dtable;
+    burst.callback = 0;
+
+    if(Start_6131_Burst(&burst, irq_mgmt) != 'P') return ('F');
+    return Wait_6131_Burst(&burst, irq_mgmt);
+}
+
+
+unsigned char Write_6131_Burst(unsigned short address, unsigned short *buffer, unsigned short count, unsigned char dtable, unsigned char irq_mgmt) {
+
+    SPI_BURST burst;
+
+    burst.address = address;
+    burst.buffer = buffer;
+    burst.count = count;
+    burst.direction = BURST_WRITE;
+    burst.dtable = dtable;
+    burst.callback = 0;
+
+    if(Start_6131_Burst(&burst, irq_mgmt) != 'P') return ('F');
+    return Wait_6131_Burst(&burst, irq_mgmt);
+}
+
+
+
+//-----------------------------------------------------------------------------
+/// SPI transaction trace
+//-----------------------------------------------------------------------------
+
+//	This function clears the trace ring and starts recording every op code: op code,
+//	enabled MAP, address, word count, cycle stamps at chip select assertion and
+//	negation, and whether the op code was resumed after an interrupt, issued by an 
+//	interrupt routine or moved its words by DMA. The ring keeps the last 
+//	SPI_TRACE_SIZE op codes. Recording costs a few cycles per op code and one per 
+//	data word, so it can be left running. Cycles come from the DWT cycle counter, 
+//	started here, or the modeled bus time in the host build.
+//
+//	With SPI_TRACE = NO in 613x_initialization.h this function does nothing.
+//
+void Start_6131_Trace(void) {
+
+#if (SPI_TRACE == YES)
+    __disable_interrupt();
+#if (HOST_MODEL != YES)
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+    trace_head = 0;
+    trace_total = 0;
+    trace_open = 0;
+    trace_on = 1;
+    __enable_interrupt();
+#endif
+}
+
+
+
+//	This function stops recording. The ring is kept for Get_6131_Trace( ) and
+//	Dump_6131_Trace( ).
+//
+void Stop_6131_Trace(void) {
+
+#if (SPI_TRACE == YES)
+    __disable_interrupt();
+    // a record still open is kept
+    if(trace_open) trace_stop();
+    trace_on = 0;
+    __enable_interrupt();
+#endif
+}
+
+
+
+//	This function copies up to max of the most recent trace records, oldest first.
+//
+// 	param 	dst is the caller array receiving the records
+// 	param 	max is the size of the caller array, records
+//
+//	Returns the number of records copied.
+//
+unsigned short Get_6131_Trace(SPI_TRACE_REC *dst, unsigned short max) {
+
+#if (SPI_TRACE == YES)
+    unsigned short n, i, first;
+
+    if(dst == 0) return 0;
+
+    __disable_interrupt();
+    n = (trace_total < SPI_TRACE_SIZE) ? (unsigned short)trace_total : SPI_TRACE_SIZE;
+    if(n > max) n = max;
+    first = (trace_head - n) & (SPI_TRACE_SIZE - 1);
+    for(i = 0; i < n; i++) dst[i] = spi_trace[(first + i) & (SPI_TRACE_SIZE - 1)];
+    __enable_interrupt();
+
+    return n;
+#else
+    dst = dst;
+    max = max;
+    return 0;
+#endif
+}
+
+
+
+//	This function prints the trace ring, oldest record first. Recording is stopped
+//	while printing so console traffic is not traced, then restored.
+//
+//	Text lines are comma-separated like the benchmark output:
+//	TRACE,n,opcode,map,address,words,start,cycles,flags
+//	where cycles is end - start and flags is R (resumed), I (ISR), D (DMA) or -.
+//
+//	The binary stream is 'S','T', the record count (2 bytes), then each record's
+//	16 bytes in SPI_TRACE_REC order, all little-endian, for capture by a PC tool.
+//
+// 	param 	binary is non-zero for the binary stream, zero for text
+//
+void Dump_6131_Trace(unsigned char binary) {
+
+#if (SPI_TRACE == YES)
+    SPI_TRACE_REC rec;
+    unsigned short n, i, first;
+    unsigned char was_on, j;
+    const unsigned char *b;
+
+    __disable_interrupt();
+    was_on = trace_on;
+    if(trace_open) trace_stop();
+    trace_on = 0;
+    __enable_interrupt();
+
+    n = (trace_total < SPI_TRACE_SIZE) ? (unsigned short)trace_total : SPI_TRACE_SIZE;
+    first = (trace_head - n) & (SPI_TRACE_SIZE - 1);
+
+    if(binary) {
+        putchar('S');
+        putchar('T');
+        putchar(n & 0xFF);
+        putchar(n >> 8);
+    }
+    else printf("\r\nTRACE,n,opcode,map,address,words,start,cycles,flags\r\n");
+
+    for(i = 0; i < n; i++) {
+        rec = spi_trace[(first + i) & (SPI_TRACE_SIZE - 1)];
+        if(binary) {
+            b = (const unsigned char *)&rec;
+            for(j = 0; j < sizeof(rec); j++) putchar(b[j]);
+        }
+        else {
+            printf("TRACE,%u,0x%02X,%u,0x%04X,%u,%lu,%lu,%c%c%c\r\n", i, rec.opcode, rec.map,
+                   rec.address, rec.words, (unsigned long)rec.start, (unsigned long)(rec.end - rec.start),
+                   (rec.flags & SPI_TRACE_RESUMED) ? 'R' : '-',
+                   (rec.flags & SPI_TRACE_ISR) ? 'I' : '-',
+                   (rec.flags & SPI_TRACE_DMA) ? 'D' : '-');
+        }
+    }
+
+    trace_on = was_on;
+#else
+    binary = binary;
+#endif
+}
+
+
+
+//-----------------------------------------------------------------------------
+//                        SPI Transaction Batch
+//-----------------------------------------------------------------------------
+//
+// Sequences such as "load MAP, read word, write register, write register" cost a
+// function call, an interrupt disable and enable and a MAP save and restore per 
+// access when written with the single-access functions above. A batch lists the 
+// accesses first, in a caller SPI_BATCH_OP array, then Run_6131_Batch( ) performs
+// them back to back: interrupts are disabled once, MAP3 is enabled once, MAP3 is
+// loaded only when a read or write does not continue where the last one ended, 
+// and read data lands directly in the caller buffers.
+//
+// Each op is its own chip select cycle, as the HI-6131 requires, so a batch is not
+// one DMA transfer; reads and writes of BATCH_DMA_WORDS or more go to the DMA 
+// burst engine when the batch is run with irq_mgmt non-zero. Batches are not for
+// RT descriptor tables, where MAP3 must be reloaded every 4 words: use
+// Read_6131_Block( ) or Write_6131_Block( ) with dtable = 1.
+//
+// Example, two RAM-mapped registers read with one call:
+//
+//	SPI_BATCH_OP ops[2];
+//	SPI_BATCH batch;
+//
+//	Init_6131_Batch(&batch, ops, 2);
+//	Batch_6131_Read(&batch, RT1_1553_STATUS_BITS_REG, &rt1, 1);
+//	Batch_6131_Read(&batch, RT2_1553_STATUS_BITS_REG, &rt2, 1);
+//	Run_6131_Batch(&batch, 1);
+
+
+//	Local function that appends one op, or marks the batch overflowed
+//
+static SPI_BATCH_OP *batch_add(SPI_BATCH *batch, unsigned char type) {
+
+    SPI_BATCH_OP *op;
+
+    if(batch->count >= batch->size) {
+        batch->overflow = 1;
+        return 0;
+    }
+    op = &batch->ops[batch->count++];
+    op->type = type;
+    op->code = 0;
+    op->value = 0;
+    op->count = 0;
+    op->data = 0;
+    return op;
+}
+
+
+//	Local function that appends a BATCH_READ or BATCH_WRITE op, preceded by a MAP3
+//	load unless the address continues from the last read or write in the batch.
+//	Run_6131_Batch( ) skips the load when the op goes by DMA burst, which loads
+//	MAP3 itself.
+//
+static unsigned char batch_add_rw(SPI_BATCH *batch, unsigned char type, unsigned short address,
+                                  unsigned short *data, unsigned short count) {
+
+    SPI_BATCH_OP *op;
+
+    if((data == 0) || (count == 0)) return ('F');
+    if(!batch->next_valid || (batch->next != address)) {
+        op = batch_add(batch, BATCH_LOAD_MAP);
+        if(op == 0) return ('F');
+        op->value = address;
+    }
+    op = batch_add(batch, type);
+    if(op == 0) return ('F');
+    op->value = address;
+    op->count = count;
+    op->data = data;
+    batch->next = address + count;
+    batch->next_valid = 1;
+    return ('P');
+}
+
+
+//	This function starts an empty batch. The batch keeps a pointer to the caller's
+//	ops[ ] array, which must stay valid until Run_6131_Batch( ) returns. Calling it
+//	again clears the batch for reuse.
+//
+//	param	batch   caller batch
+//	param	ops     caller array of size entries
+//	param	size    number of ops the array holds
+//
+void Init_6131_Batch(SPI_BATCH *batch, SPI_BATCH_OP *ops, unsigned short size) {
+
+    batch->ops = ops;
+    batch->size = size;
+    batch->count = 0;
+    batch->next_valid = 0;
+    batch->overflow = 0;
+}
+
+
+//	These functions append one op to a batch. Nothing is sent until Run_6131_Batch( ).
+//	Each returns 'F' if the batch is full (Run_6131_Batch( ) will then refuse the 
+//	batch) or a parameter is illegal, otherwise 'P'.
+//
+//	Batch_6131_Opcode( ) sends a single op code: MAPadd1, MAPadd2, MAPadd4 or enMAP1-4.
+//	Batch_6131_WriteReg( ) writes register 0-63 directly, like Write_6131LowReg( ).
+//	Batch_6131_ReadReg( ) reads register 0-15 directly into *dst, like Read_6131LowReg( ).
+//	Batch_6131_Read( ) reads count words from address onward into dst[ ].
+//	Batch_6131_Write( ) writes count words from src[ ] to address onward.
+//
+//	Reads and writes use MAP3, any register or RAM address. The caller's buffers
+//	must stay valid until Run_6131_Batch( ) returns.
+//
+unsigned char Batch_6131_Opcode(SPI_BATCH *batch, unsigned char opcode) {
+
+    SPI_BATCH_OP *op;
+
+    if((opcode != MAPadd1) && (opcode != MAPadd2) && (opcode != MAPadd4) &&
+       ((opcode < enMAP1) || (opcode > enMAP4))) return ('F');
+    op = batch_add(batch, BATCH_OPCODE);
+    if(op == 0) return ('F');
+    op->code = opcode;
+    // MAP3 may have moved or been disabled
+    batch->next_valid = 0;
+    return ('P');
+}
+
+
+unsigned char Batch_6131_WriteReg(SPI_BATCH *batch, unsigned char reg_number, unsigned short data) {
+
+    SPI_BATCH_OP *op;
+
+    if(reg_number > 63) return ('F');
+    op = batch_add(batch, BATCH_WRITE_REG);
+    if(op == 0) return ('F');
+    op->code = reg_number;
+    op->value = data;
+    // writing MAP3 or Master Config moves or disables MAP3
+    if((reg_number == MAP_REG(MAP_BULK)) || (reg_number == MASTER_CONFIG_REG)) batch->next_valid = 0;
+    return ('P');
+}
+
+
+unsigned char Batch_6131_ReadReg(SPI_BATCH *batch, unsigned char reg_number, unsigned short *dst) {
+
+    SPI_BATCH_OP *op;
+
+    if((reg_number > 15) || (dst == 0)) return ('F');
+    op = batch_add(batch, BATCH_READ_REG);
+    if(op == 0) return ('F');
+    op->code = reg_number;
+    op->data = dst;
+    return ('P');
+}
+
+
+unsigned char Batch_6131_Read(SPI_BATCH *batch, unsigned short address, unsigned short *dst, unsigned short count) {
+
+    return batch_add_rw(batch, BATCH_READ, address, dst, count);
+}
+
+
+unsigned char Batch_6131_Write(SPI_BATCH *batch, unsigned short address, const unsigned short *src, unsigned short count) {
+
+    return batch_add_rw(batch, BATCH_WRITE, address, (unsigned short *)src, count);
+}
+
+
+//	This function performs every op in a batch, in order, back to back. The incoming
+//	enabled MAP is re-enabled when finished, so the caller's MAP is undisturbed.
+//	The batch is unchanged and may be run again.
+//
+//	If parameter irq_mgmt is non-zero, IRQs are momentarily enabled between ops, so 
+//	interrupt latency is about one op. An spi-using interrupt recognized there must
+//	bracket its accesses with Enter_6131_ISR( ) and Exit_6131_ISR( ) using its own
+//	MAP. Reads and writes of BATCH_DMA_WORDS or more then use the DMA burst engine.
+//	With irq_mgmt zero the caller manages interrupts and every op uses the CPU.
+//
+//	param	batch     built by Init_6131_Batch( ) and the Batch_6131_xxx( ) functions
+//      param	irq_mgmt. if zero, the calling routine manages irq enable/disable.
+//	                  if non-zero, this function calls __disable_interrupt() and __enable_interrupt() locally.
+//
+//	Returns 'F' for an empty or overflowed batch, or a DMA burst that could not 
+//	start, otherwise 'P'.
+//
+unsigned char Run_6131_Batch(SPI_BATCH *batch, unsigned char irq_mgmt) {
+
+    SPI_BATCH_OP *op;
+    unsigned short i, j;
+    unsigned char savemap, result = 'P';
+
+    if(batch->overflow || (batch->count == 0)) return ('F');
+
+    // disable interrupts, if IRQs managed at this level
+    if(irq_mgmt)  __disable_interrupt();
+    // we will restore the active MAP when finished, Master Config bits 11-10
+    savemap = (unsigned char)((Read_6131_MasterConfig(0) >> 10) & 0x0003);
+
+    for(i = 0, op = batch->ops; i < batch->count; i++, op++) {
+
+        switch(op->type) {
+
+            case BATCH_OPCODE:
+                SPIopcode_noirq(op->code);
+                break;
+
+            case BATCH_WRITE_REG:
+                spi_start(0x80 + op->code);
+                spi_put(op->value);
+                spi_stop();
+                TRACE_MAP(op->code, op->value);
+                if(op->code == MASTER_CONFIG_REG) {
+                    mcfg_shadow = op->value & ~MCFG_BCSTRT;
+                    mcfg_valid = 1;
+                }
+                break;
+
+            case BATCH_READ_REG:
+                spi_start(op->code << 2);
+                *op->data = spi_get();
+                spi_stop();
+                if(op->code == MASTER_CONFIG_REG) {
+                    mcfg_shadow = *op->data & ~MCFG_BCSTRT;
+                    mcfg_valid = 1;
+                }
+                break;
+
+            case BATCH_LOAD_MAP:
+                // a DMA burst next loads MAP3 itself
+                if((i + 1 < batch->count) && BATCH_BY_DMA(op + 1, irq_mgmt)) break;
+                // MAP3 enable op code only when another MAP is enabled
+                if(((Read_6131_MasterConfig(0) >> 10) & 0x0003) != MAP_BULK - 1)
+                    SPIopcode_noirq(enMAP1 + MAP_BULK - 1);
+                spi_start(0x80 + MAP_REG(MAP_BULK));
+                spi_put(op->value);
+                spi_stop();
+                TRACE_MAP(MAP_REG(MAP_BULK), op->value);
+                break;
+
+            case BATCH_READ:
+            case BATCH_WRITE:
+                if(BATCH_BY_DMA(op, irq_mgmt)) {
+                    // the burst loads MAP3 itself and leaves it past the last word,
+                    // but re-enables the MAP that was enabled before it
+                    __enable_interrupt();
+                    if(op->type == BATCH_READ) j = Read_6131_Burst(op->value, op->data, op->count, 0, 1);
+                    else j = Write_6131_Burst(op->value, op->data, op->count, 0, 1);
+                    __disable_interrupt();
+                    if(j != 'P') result = 'F';
+                    break;
+                }
+                // after a burst MAP3 may hold the address but not be enabled
+                if(((Read_6131_MasterConfig(0) >> 10) & 0x0003) != MAP_BULK - 1)
+                    SPIopcode_noirq(enMAP1 + MAP_BULK - 1);
+                if(op->type == BATCH_READ) {
+                    spi_start(0x40);
+                    for(j = 0; j < op->count; j++) op->data[j] = spi_get();
+                    spi_stop();
+                }
+                else {
+                    spi_start(0xC0);
+                    for(j = 0; j < op->count; j++) spi_put(op->data[j]);
+                    spi_stop();
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        if(irq_mgmt) {
+            // Chip select is negated between ops. An interrupt service routine
+            // recognized here re-enables MAP3 on exit, which still holds our address.
+            __enable_interrupt();
+            __disable_interrupt();
+        }
+    }
+
+    // restore original MAP by single op code
+    if(((Read_6131_MasterConfig(0) >> 10) & 0x0003) != savemap) SPIopcode_noirq(enMAP1 + savemap);
+    // re-enable interrupts, if IRQs managed at this level 
+    if(irq_mgmt)  __enable_interrupt();
+
+    return result;
+}
+
+
+
+//-----------------------------------------------------------------------------
+//                        RAM Image Verification
+//-----------------------------------------------------------------------------
+//
+// Host initialization writes descriptor tables, illegalization tables, BC message
+// blocks and the BC instruction list from arrays built at run time. Right after 
+// each table is written, Record_6131_Image( ) keeps the CRC of every VERIFY_BLOCK 
+// words of the source array. After initialization Verify_6131_Images( ) reads 
+// each table back by DMA burst and compares the CRCs, so a table that did not 
+// land correctly is found without keeping a copy of it. Run before terminals 
+// start: the device itself updates Control Words, message blocks and buffers.
+//
+// With RAM_VERIFY = NO in 613x_initialization.h nothing is recorded.
+
+
+//	This function continues a CRC-16-CCITT (polynomial 0x1021, not reflected) over
+//	count 16-bit words, high byte first. Start with crc = CRC_6131_INIT. Two table
+//	lookups per word.
+//
+unsigned short Crc_6131(unsigned short crc, const unsigned short *data, unsigned short count) {
+
+    unsigned short w;
+
+    while(count--) {
+        w = *data++;
+        crc = (crc << 8) ^ crc_table[((crc >> 8) ^ (w >> 8)) & 0xFF];
+        crc = (crc << 8) ^ crc_table[((crc >> 8) ^ w) & 0xFF];
+    }
+    return crc;
+}
+
+
+
+//	This function forgets all recorded images. Called before host initialization.
+//
+void Reset_6131_Verify(void) {
+
+#if (RAM_VERIFY == YES)
+    verify_regions = 0;
+    verify_crcs = 0;
+    verify_overflow = 0;
+#endif
+}
+
+
+
+//	This function records a table just written to HI-6131 RAM, for checking by
+//	Verify_6131_Images( ). The parameters are those given to Write_6131_Block( ).
+//	Only CRCs are kept, the caller's array may be discarded.
+//
+//	param	address   first HI-6131 RAM address of the table
+//	param	src       the words written, src[0] at address
+//	param	count     number of 16-bit words
+//	param	dtable    non-zero if the range contains RT descriptor table(s)
+//
+//	Returns 'F' for a bad parameter or if the image does not fit, else 'P'. An
+//	image that does not fit makes Verify_6131_Images( ) fail.
+//
+unsigned char Record_6131_Image(unsigned short address, const unsigned short *src, unsigned short count, unsigned char dtable) {
+
+#if (RAM_VERIFY == YES)
+    unsigned short i, n;
+
+    if((src == 0) || (count == 0)) return ('F');
+
+    n = (count + VERIFY_BLOCK - 1) / VERIFY_BLOCK;
+    if((verify_regions >= VERIFY_REGIONS) || (verify_crcs + n > VERIFY_CRCS)) {
+        verify_overflow = 1;
+        return ('F');
+    }
+    verify_region[verify_regions].address = address;
+    verify_region[verify_regions].count = count;
+    verify_region[verify_regions].first = verify_crcs;
+    verify_region[verify_regions].dtable = dtable;
+    verify_regions++;
+
+    for(i = 0; i < count; i += n) {
+        n = count - i;
+        if(n > VERIFY_BLOCK) n = VERIFY_BLOCK;
+        verify_crc[verify_crcs++] = Crc_6131(CRC_6131_INIT, &src[i], n);
+    }
+#else
+    address = address;
+    src = src;
+    count = count;
+    dtable = dtable;
+#endif
+    return ('P');
+}
+
+
+
+//	This function reads back every image recorded since Reset_6131_Verify( ) with
+//	Read_6131_Burst( ), VERIFY_CHUNK words at a time, and compares block CRCs. It 
+//	stops at the first mismatch. No console output, so it can run at every boot.
+//	Like Read_6131_Burst( ) with irq_mgmt = 1, it returns with interrupts enabled.
+//
+//	param	bad_address  if not null, receives the first address of the first
+//	                     mismatching VERIFY_BLOCK-word block, or of the burst that
+//	                     could not start, or VERIFY_OVERFLOW
+//
+//	Returns 'P' if every image matches, else 'F'.
+//
+unsigned char Verify_6131_Images(unsigned short *bad_address) {
+
+#if (RAM_VERIFY == YES)
+    unsigned short address, left, n, m, i, k;
+    unsigned char r;
+
+    if(verify_overflow) {
+        if(bad_address) *bad_address = VERIFY_OVERFLOW;
+        return ('F');
+    }
+
+    for(r = 0; r < verify_regions; r++) {
+        address = verify_region[r].address;
+        left = verify_region[r].count;
+        k = verify_region[r].first;
+
+        while(left) {
+            if(left > VERIFY_CHUNK) n = VERIFY_CHUNK;
+            else n = left;
+
+            if(Read_6131_Burst(address, verify_buf, n, verify_region[r].dtable, 1) != 'P') {
+                if(bad_address) *bad_address = address;
+                return ('F');
+            }
+            for(i = 0; i < n; i += m) {
+                m = n - i;
+                if(m > VERIFY_BLOCK) m = VERIFY_BLOCK;
+                if(Crc_6131(CRC_6131_INIT, &verify_buf[i], m) != verify_crc[k++]) {
+                    if(bad_address) *bad_address = address + i;
+                    return ('F');
+                }
+            }
+            address += n;
+            left -= n;
+        }
+    }
+#else
+    bad_address = bad_address;
+#endif
+    return ('P');
+}
+
+
+
 /*
 //	next function was created specifically to demonstrate a method for
 //	SPI interrupt management. The function performs a 32-word sequential
@@ -108,6 +108,259 @@
 #define MAPadd4    0xD4     //  Add 4 to currently-enabled Memory Address Pointer value
 
 
+// Memory Address Pointer ownership. Each execution context that reads or writes 
+// through a Memory Address Pointer uses only its own MAP, so an interrupt never 
+// changes the pointer value of the transfer it preempted. An SPI-using interrupt 
+// service routine brackets its HI-6131 accesses with Enter_6131_ISR( ) and 
+// Exit_6131_ISR( ), which end and re-enable the preempted transfer's MAP.
+
+#define MAP_CONSOLE     1   // console, initialization and single word functions
+#define MAP_HDW_ISR     2   // hardware interrupt service
+#define MAP_BULK        3   // foreground block and burst transfers
+#define MAP_MSG_ISR     4   // message interrupt service
+
+// register address of Memory Address Pointer map_num 1-4, 0x000B-0x000E
+#define MAP_REG(map_num)    (0x0B + (map_num) - 1)
+
+
+
+//------------------------------------------------------------------------------
+//               DMA Burst Engine Definitions
+//------------------------------------------------------------------------------
+
+/// On the SAM3U the SPI0 peripheral is served by the DMA Controller (DMAC)
+/// using hardware handshaking. Two DMAC channels are used for HI-6131 bursts:
+/// one feeds SPI TDR, the other empties SPI RDR. The handshake interface
+/// numbers are from the SAM3U datasheet DMAC channel definition table.
+
+#define BOARD_6131_DMA_TX_CH        0   // DMAC channel feeding SPI0 TDR
+#define BOARD_6131_DMA_RX_CH        1   // DMAC channel emptying SPI0 RDR
+#define BOARD_6131_DMA_TX_PER       1   // DMAC hardware interface: SPI0 transmit
+#define BOARD_6131_DMA_RX_PER       2   // DMAC hardware interface: SPI0 receive
+
+// largest DMAC buffer transfer (12-bit BTSIZE field), 16-bit words
+#define BURST_MAX_SEGMENT           0x0FFF
+
+// burst direction
+#define BURST_READ      0
+#define BURST_WRITE     1
+#define BURST_FILL      2   // buffer[0] written to every word, DMA source fixed
+
+// optional completion callback, see Start_6131_Burst( )
+typedef void (*BURST_CALLBACK)(unsigned short *buffer, unsigned short count);
+
+// one burst request. The caller owns the structure and the data buffer
+// until the done flag is set (or the callback is called).
+typedef struct {
+    unsigned short  address;        // first HI-6131 register or RAM address
+    unsigned short *buffer;         // caller-supplied buffer, buffer[0] is first word
+    unsigned short  count;          // number of 16-bit words
+    unsigned char   direction;      // BURST_READ, BURST_WRITE or BURST_FILL
+    unsigned char   dtable;         // non-zero: reload MAP at every 4-word boundary
+    BURST_CALLBACK  callback;       // null, or called at completion
+    volatile unsigned char done;    // set to 1 at completion
+} SPI_BURST;
+
+
+
+
+//------------------------------------------------------------------------------
+//               RAM Fill Definitions
+//------------------------------------------------------------------------------
+
+// Fill_6131_Ranges( ) range patterns
+#define FILL_VALUE      0   // every word = value
+#define FILL_INCREMENT  1   // first word = value, then value+1, value+2 ...
+
+// FILL_INCREMENT words are built this many at a time in one of two buffers,
+// the next chunk is built while DMA writes the previous one
+#define FILL_CHUNK      256
+
+// one range to fill. An address-derived pattern, as written by 
+// Fill_6131RAM_Offset( ), is FILL_INCREMENT with value = address
+typedef struct {
+    unsigned short  address;        // first HI-6131 RAM address
+    unsigned short  count;          // number of 16-bit words, zero skips the range
+    unsigned short  value;          // fill value, or first value for FILL_INCREMENT
+    unsigned char   mode;           // FILL_VALUE or FILL_INCREMENT
+} FILL_RANGE;
+
+
+
+//------------------------------------------------------------------------------
+//               Interrupt Register Snapshot
+//------------------------------------------------------------------------------
+
+// Interrupt management registers 0x06-0x16 read by one MAP burst. The four
+// pending, enable and output enable registers share the same order, so one
+// index selects a terminal in each array. Reading a pending register clears it.
+
+#define INT_HDW     0   // Hardware interrupt regs 0x06, 0x0F, 0x13
+#define INT_BC      1   // Bus Controller interrupt regs 0x07, 0x10, 0x14
+#define INT_MT      2   // Bus Monitor interrupt regs 0x08, 0x11, 0x15
+#define INT_RT      3   // RT1-2 interrupt regs 0x09, 0x12, 0x16
+
+// Read_6131_IntRegs( ) param what. Only the interrupt service should read
+// register 0x0A: reading it clears the interrupt count the log drain relies on
+#define INT_REGS_PENDING    0   // pending regs 0x06-0x09
+#define INT_REGS_LOG        1   // pending regs and Int Count & Log Addr reg 0x0A
+#define INT_REGS_ALL        2   // pending regs and regs 0x0F-0x16, 0x0A is skipped
+#define INT_REGS_CONFIG     3   // enable and output enable regs 0x0F-0x16 only
+
+typedef struct {
+    unsigned short pending[4];      // 0x06-0x09 Pending Interrupt regs
+    unsigned short count_log;       // 0x0A Interrupt Count & Log Addr Pointer
+    unsigned short enable[4];       // 0x0F-0x12 Interrupt Enable regs
+    unsigned short output[4];       // 0x13-0x16 Interrupt Output Enable regs
+} INT_6131_REGS;
+
+
+
+//------------------------------------------------------------------------------
+//               SPI Transaction Trace Definitions
+//------------------------------------------------------------------------------
+
+// Cortex-M3 Data Watchpoint and Trace cycle counter
+#define DEMCR               (*(volatile unsigned int *)0xE000EDFC)
+#define DEMCR_TRCENA        (1u << 24)
+#define DWT_CTRL            (*(volatile unsigned int *)0xE0001000)
+#define DWT_CTRL_CYCCNTENA  (1u << 0)
+#define DWT_CYCCNT          (*(volatile unsigned int *)0xE0001004)
+
+// trace ring size, records, power of 2
+#define SPI_TRACE_SIZE      128
+
+// SPI_TRACE_REC flags
+#define SPI_TRACE_RESUMED   0x01    // op code re-sent after an interrupt ended the last one
+#define SPI_TRACE_ISR       0x02    // issued between Enter_6131_ISR( ) and Exit_6131_ISR( )
+#define SPI_TRACE_DMA       0x04    // data words moved by the DMA burst engine
+
+// SPI_TRACE_REC address when the device loads the MAP itself (op codes 0x48-0x78, 0xE8-0xF8)
+#define SPI_TRACE_NOADDR    0xFFFF
+
+// one op code: chip select assertion to negation. 16 bytes.
+typedef struct {
+    unsigned int   start;           // cycle count at chip select assertion
+    unsigned int   end;             // cycle count at chip select negation
+    unsigned short address;         // register for 0x00-0xBF, else first MAP address
+    unsigned short words;           // data words after the op code
+    unsigned char  opcode;
+    unsigned char  map;             // enabled Memory Address Pointer 1-4
+    unsigned char  flags;           // SPI_TRACE_RESUMED, SPI_TRACE_ISR, SPI_TRACE_DMA
+    unsigned char  reserved;
+} SPI_TRACE_REC;
+
+
+//------------------------------------------------------------------------------
+//               SPI Timing Calibration Definitions
+//------------------------------------------------------------------------------
+
+// HI-6131 RAM written and read back by Tune_6131_SPI_Timing( ). Contents are
+// saved before and restored after calibration.
+#define TUNE_RAM_ADDR       0x7F00
+#define TUNE_RAM_WORDS      64
+
+// patterns checked at each candidate setting
+#define TUNE_PASSES         8
+
+// candidate settings between the fastest passing one and the one kept
+#define TUNE_MARGIN         1
+
+
+//------------------------------------------------------------------------------
+//               RAM Image Verification Definitions
+//------------------------------------------------------------------------------
+
+// CRC-16-CCITT, polynomial 0x1021, initial value for Crc_6131( )
+#define CRC_6131_INIT       0xFFFF
+
+// Record_6131_Image( ) keeps one CRC per VERIFY_BLOCK words of each image, so a
+// mismatch is located to one block. Sized for the tables written by this program.
+#define VERIFY_REGIONS      32      // images recorded
+#define VERIFY_BLOCK        16      // words per CRC
+#define VERIFY_CRCS         256     // CRCs for all images
+
+// Verify_6131_Images( ) reads this many words per burst, multiple of VERIFY_BLOCK
+#define VERIFY_CHUNK        256
+
+// Verify_6131_Images( ) bad address when more images were recorded than fit
+#define VERIFY_OVERFLOW     0xFFFF
+
+
+
+//------------------------------------------------------------------------------
+//               SPI Transaction Batch Definitions
+//------------------------------------------------------------------------------
+
+// SPI_BATCH_OP type
+#define BATCH_OPCODE        0   // single op code: MAPadd1, MAPadd2, MAPadd4, enMAPn
+#define BATCH_WRITE_REG     1   // write register 0-63
+#define BATCH_READ_REG      2   // read register 0-15
+#define BATCH_LOAD_MAP      3   // load MAP3, added by Batch_6131_Read( ) and Batch_6131_Write( )
+#define BATCH_READ          4   // read N words at MAP3
+#define BATCH_WRITE         5   // write N words at MAP3
+
+// reads and writes of this many words or more use the DMA burst engine
+// when the batch is run with irq_mgmt non-zero
+#define BATCH_DMA_WORDS     32
+
+// one queued SPI op code and its data words
+typedef struct {
+    unsigned char  type;            // BATCH_xxx
+    unsigned char  code;            // op code, or register number
+    unsigned short value;           // register data, or HI-6131 address
+    unsigned short count;           // data words, BATCH_READ and BATCH_WRITE
+    unsigned short *data;           // caller buffer read into or written from
+} SPI_BATCH_OP;
+
+// a list of ops in a caller array, built by the Batch_6131_xxx( ) functions
+typedef struct {
+    SPI_BATCH_OP   *ops;
+    unsigned short size;            // ops[ ] entries
+    unsigned short count;           // ops in the batch
+    unsigned short next;            // MAP3 address after the last read or write
+    unsigned char  next_valid;      // non-zero if next is known
+    unsigned char  overflow;        // non-zero if an op did not fit
+} SPI_BATCH;
+
+
+//------------------------------------------------------------------------------
+//               Register Access Macros
+//------------------------------------------------------------------------------
+
+// HI-6131 register access classes, by address (see device_6131.h):
+//   0x00-0x0F  fast access read and write, op code only
+//   0x10-0x3F  fast access write, read through a Memory Address Pointer
+//   0x40-0x50  read and write through a Memory Address Pointer
+#define REG_LAST                0x50
+#define REG_FAST_READ(reg)      ((reg) <= 0x0F)
+#define REG_FAST_WRITE(reg)     ((reg) <= 0x3F)
+
+// compile error unless cond is a true integer constant expression: a bit-field
+// width must be a constant, and a negative width is illegal. (An array size
+// would not do, a variable one is a legal C99 VLA.)
+#define REG_ASSERT(cond)        ((void)sizeof(struct { int reg_ok : (cond) ? 1 : -1; }))
+
+// Register read and write by the cheapest SPI sequence. reg must be a constant
+// register address such as RT1_CONFIG_REG; the compiler keeps only one branch.
+// A variable address, or one outside 0x00-0x50, does not compile. MAP accesses
+// load the enabled MAP, overwriting its address: in interrupt service routines
+// use these only between Enter_6131_ISR( ) and Exit_6131_ISR( ), like
+// Read_6131_Reg( ).
+#define READ_6131_REG(reg, irq_mgmt) \
+    (REG_ASSERT((reg) <= REG_LAST), REG_FAST_READ(reg) ? \
+     Read_6131LowReg((reg), (irq_mgmt)) : Read_6131_Reg((reg), (irq_mgmt)))
+
+#define WRITE_6131_REG(reg, data, irq_mgmt) \
+    (REG_ASSERT((reg) <= REG_LAST), REG_FAST_WRITE(reg) ? \
+     Write_6131LowReg((reg), (data), (irq_mgmt)) : Write_6131_Reg((reg), (data), (irq_mgmt)))
+
+// Fast access only: does not compile for a register that needs a MAP
+#define READ_6131_FAST(reg, irq_mgmt) \
+    (REG_ASSERT(REG_FAST_READ(reg)), Read_6131LowReg((reg), (irq_mgmt)))
+
+#define WRITE_6131_FAST(reg, data, irq_mgmt) \
+    (REG_ASSERT(REG_FAST_WRITE(reg)), Write_6131LowReg((reg), (data), (irq_mgmt)))
 
 
 
@@ -120,23 +373,57 @@ unsigned char Write_6131LowReg(unsigned char reg_number, unsigned short data, un
 unsigned short Read_6131LowReg(unsigned char reg_number, unsigned char irq_mgmt) ;
 void Write_6131_1word(unsigned short data, unsigned char irq_mgmt) ;
 unsigned short Read_6131_1word(unsigned char irq_mgmt) ;
-void Write_6131(unsigned short write_data[], unsigned char inc_pointer_first, unsigned char irq_mgmt) ;
+void Write_6131(unsigned short write_data[], unsigned short number_of_words, unsigned char inc_pointer_first, unsigned char irq_mgmt) ;
 //void Read_6131(unsigned short number_of_words, unsigned char irq_mgmt) ;
-unsigned char Write_6131_Buffer(unsigned short write_data[], unsigned char inc_pointer_first, unsigned char irq_mgmt) ;
+unsigned char Write_6131_Buffer(unsigned short write_data[], unsigned short number_of_words, unsigned char inc_pointer_first, unsigned char irq_mgmt) ;
+unsigned char Write_6131_Block(unsigned short address, const unsigned short *src, unsigned short count, unsigned char dtable, unsigned char irq_mgmt) ;
 unsigned char Read_6131_Buffer(unsigned short number_of_words, unsigned char inc_pointer_first, unsigned char irq_mgmt) ;
 unsigned short Read_Current_Control_Word(unsigned char rt_num, unsigned char irq_mgmt) ;
 unsigned short getMAPaddr(void) ;
 void enaMAP(unsigned char map_num) ;
+unsigned short Read_6131_MasterConfig(unsigned char irq_mgmt) ;
+unsigned char Enter_6131_ISR(unsigned char map_num) ;
+void Exit_6131_ISR(unsigned char savemap) ;
+void Invalidate_6131_MasterConfig(void) ;
 unsigned short Read_Current_Control_Word(unsigned char rt_num, unsigned char irq_mgmt);
 unsigned short Read_RT1_Control_Word(unsigned char txrx, unsigned char samc, unsigned char number, unsigned char irq_mgmt);
 unsigned short Read_RT2_Control_Word(unsigned char txrx, unsigned char samc, unsigned char number, unsigned char irq_mgmt);
 unsigned short ReadWord_Adv4(unsigned char irq_mgmt) ;
 unsigned short Read_Last_Interrupt(unsigned char irq_mgmt) ;
+unsigned char Read_6131_IntRegs(INT_6131_REGS *regs, unsigned char what, unsigned char irq_mgmt) ;
+unsigned char Read_6131_MAP(unsigned short address, unsigned short *dst, unsigned short count, unsigned char irq_mgmt) ;
+unsigned short Read_6131_Reg(unsigned short address, unsigned char irq_mgmt) ;
+unsigned char Write_6131_Reg(unsigned short address, unsigned short data, unsigned char irq_mgmt) ;
 void Fill_6131RAM_Offset(void) ;
 void Fill_6131RAM(unsigned short addr, unsigned short num_words, unsigned short fill_value) ;
+unsigned char Fill_6131_Ranges(const FILL_RANGE *ranges, unsigned char num_ranges, unsigned char irq_mgmt) ;
 void Memory_watch(unsigned short address);
 void Configure_ARM_MCU_SPI(void);
+unsigned char Set_6131_SPI_Timing(unsigned char scbr, unsigned char dlybs, unsigned char dlybct);
+void Get_6131_SPI_Timing(unsigned char *scbr, unsigned char *dlybs, unsigned char *dlybct);
+unsigned char Tune_6131_SPI_Timing(void);
 void Read_6131(unsigned short address, unsigned short number_of_words);
+unsigned char Read_6131_Block(unsigned short address, unsigned short *dst, unsigned short count, unsigned char dtable, unsigned char irq_mgmt);
+void Start_6131_Trace(void);
+void Stop_6131_Trace(void);
+unsigned short Get_6131_Trace(SPI_TRACE_REC *dst, unsigned short max);
+void Dump_6131_Trace(unsigned char binary);
+void Init_6131_Batch(SPI_BATCH *batch, SPI_BATCH_OP *ops, unsigned short size);
+unsigned char Batch_6131_Opcode(SPI_BATCH *batch, unsigned char opcode);
+unsigned char Batch_6131_WriteReg(SPI_BATCH *batch, unsigned char reg_number, unsigned short data);
+unsigned char Batch_6131_ReadReg(SPI_BATCH *batch, unsigned char reg_number, unsigned short *dst);
+unsigned char Batch_6131_Read(SPI_BATCH *batch, unsigned short address, unsigned short *dst, unsigned short count);
+unsigned char Batch_6131_Write(SPI_BATCH *batch, unsigned short address, const unsigned short *src, unsigned short count);
+unsigned char Run_6131_Batch(SPI_BATCH *batch, unsigned char irq_mgmt);
+unsigned short Crc_6131(unsigned short crc, const unsigned short *data, unsigned short count);
+void Reset_6131_Verify(void);
+unsigned char Record_6131_Image(unsigned short address, const unsigned short *src, unsigned short count, unsigned char dtable);
+unsigned char Verify_6131_Images(unsigned short *bad_address);
+void Configure_6131_DMA(void);
+unsigned char Start_6131_Burst(SPI_BURST *burst, unsigned char irq_mgmt);
+unsigned char Wait_6131_Burst(SPI_BURST *burst, unsigned char irq_mgmt);
+unsigned char Read_6131_Burst(unsigned short address, unsigned short *buffer, unsigned short count, unsigned char dtable, unsigned char irq_mgmt);
+unsigned char Write_6131_Burst(unsigned short address, unsigned short *buffer, unsigned short count, unsigned char dtable, unsigned char irq_mgmt);
 
 
 // end of file
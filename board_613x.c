@@ -86,6 +86,8 @@ void reset_613x(void) {
     
     // wait for HI-613x READY assertion, then return
     while (!PIO_Get(&pinREADY));		
+    // registers were reset or auto-initialized, discard host shadow copy
+    Invalidate_6131_MasterConfig();
 }
 
 //------------------------------------------------------------------------------
@@ -174,7 +176,7 @@ void initialize_613x_shared(void) {
         // HI-6130 uses host bus interface, HI-6131 uses host SPI interface. From 
 	// here, we use bus interface to initialize HI-6130 registers and RAM tables,
 	// or we use SPI to initialize HI-6131 registers and RAM tables     
-                unsigned short j = Read_6131LowReg(MASTER_CONFIG_REG, 0);
+                unsigned short j = Read_6131_MasterConfig(0);
   
 		// Select common configuration options that apply to all
 		// BC,MT,RT1,RT2. Terminal-specific options are initialized 
@@ -44,10 +44,12 @@
 #include "613x_mt.h"
 #include "613x_initialization.h"
 #include "console.h"
+#include "613x_bench.h"
 
 ///#if (!HOST_BUS_INTERFACE) // spi
 #include "device_6131.h"
 #include "board_6131.h"
+#include "613x_irq.h"
 
 //------------------------------------------------------------------------------
 //         Global variables
@@ -56,6 +58,15 @@
 static unsigned short waddr = 0;
 static unsigned char watch = 0;
 
+// words read by Read_6131( ) and Read_6131_Buffer( ), declared in board_6131.c
+extern unsigned short read_data[];
+
+#if (IRQ_HANDLING != YES)
+// pending interrupt bits read for one terminal's list but not yet displayed
+// by the other terminal lists, indexed INT_HDW, INT_BC, INT_MT, INT_RT
+static unsigned short int_pending_seen[4];
+#endif
+
 
 
 //------------------------------------------------------------------------------
@@ -149,6 +160,9 @@ void show_menu(void) {
     printf(" Press '9' to list MT interrupt status...\n\r");
   #endif
     printf(" Press 'W' for HI-6131 Memory Watch window...\n\r");
+    printf(" Press 'B' to run SPI benchmark (terminals disabled)...\n\r");
+    printf(" Press 'S' to list the SPI transaction trace...\n\r");
+    printf(" Press 'V' to run SPI read stress test (terminals disabled)...\n\r");
 
     printf(" NOTE: Options 6-9 clear the accessed Pending Interrupt Register!\n\r"); 
     print_line();
@@ -184,8 +198,7 @@ void bc_last_msg_console(void) {
     // enable Memory Address Pointer 1
     enaMAP(1);
 	// read block address for the last message, indirectly using MAP
-	Write_6131LowReg(MAP_1, BC_LAST_MSG_BLOCK_ADDR_REG, 1);
-	addr = Read_6131_1word(1);
+	addr = READ_6131_REG(BC_LAST_MSG_BLOCK_ADDR_REG, 1);
 	// write block addr to MAP then read block's first 2 words
 	Write_6131LowReg(MAP_1, addr, 1);	
 	// read BC Control Word, MAP auto incrementts 
@@ -316,8 +329,7 @@ void bc_last_msg_console(void) {
     
     // read Condition Code & General Purpose Flag register
 
-	Write_6131LowReg(MAP_1, BC_CCODE_AND_GPF_REG, 1);
-	j = Read_6131_1word(1);
+	j = READ_6131_REG(BC_CCODE_AND_GPF_REG, 1);
     
   }       // end rtrt
         
@@ -330,8 +342,7 @@ void bc_last_msg_console(void) {
             
             // read Condition Code & General Purpose Flag register
 
-		Write_6131LowReg(MAP_1, BC_CCODE_AND_GPF_REG, 1);
-		j = Read_6131_1word(1);
+		j = READ_6131_REG(BC_CCODE_AND_GPF_REG, 1);
 
 	    // check broadcast 
 	    if (bcast) printf("SW not applicable\n\n\r");
@@ -514,8 +525,7 @@ void list_bc_config (void) {
 	unsigned short int i, j;
 
 
-	Write_6131LowReg(MAP_1, BC_CONFIG_REG, 1);
-	i = Read_6131_1word(1);
+	i = READ_6131_REG(BC_CONFIG_REG, 1);
 
 	
 	// formfeed 
@@ -574,8 +584,7 @@ void list_bc_config (void) {
 	if(i & (1<<0)) printf("BCR Mask Enabled, BCRME = 1");
 	else printf("BCR Mask Disabled, BCRME = 0");
 	printf("\n\n\r");
-	Write_6131LowReg(MAP_1, TTAG_CONFIG_REG, 1);
-	i = Read_6131_1word(1);
+	i = READ_6131_REG(TTAG_CONFIG_REG, 1);
 
 	printf("Timetag Config Register 0x%.2X%.2X  ",(char)(i>>8),(char)i);
 
@@ -609,8 +618,7 @@ void list_bc_ccgpf_reg(void) {
 
 	unsigned short int i;
 
-	Write_6131LowReg(MAP_1, BC_CCODE_AND_GPF_REG, 1);
-	i = Read_6131_1word(1);
+	i = READ_6131_REG(BC_CCODE_AND_GPF_REG, 1);
 
 	// formfeed
 	putchar(12); 	
@@ -647,6 +655,41 @@ void list_bc_ccgpf_reg(void) {
 
 
 
+//-------------------------------------------------------------
+//      this function reads the interrupt enable, output enable
+//	and pending registers for one terminal (INT_HDW, INT_BC,
+//	INT_MT or INT_RT) using a single register snapshot. The
+//	Interrupt Count & Log Address register is not read, so
+//	the interrupt log count is left for the interrupt service.
+//	With IRQ_HANDLING the pending bits are those the interrupt
+//	service found, and the pending registers are left to it.
+//	Otherwise the snapshot clears all four pending registers,
+//	so bits for the other terminals are kept until their list
+//	is shown.
+//-------------------------------------------------------------
+static void read_int_regs(unsigned char terminal, unsigned short *enable, unsigned short *output, unsigned short *pending) {
+
+	INT_6131_REGS regs;
+
+	#if (IRQ_HANDLING == YES)
+	Read_6131_IntRegs(&regs, INT_REGS_CONFIG, 1);
+	*pending = Get_6131_IRQ_History(HDW_PENDING_INT_REG + terminal);
+	#else
+	unsigned char n;
+
+	Read_6131_IntRegs(&regs, INT_REGS_ALL, 1);
+	for(n = 0; n < 4; n++) int_pending_seen[n] |= regs.pending[n];
+	*pending = int_pending_seen[terminal];
+	int_pending_seen[terminal] = 0;
+	#endif
+
+	*enable = regs.enable[terminal];
+	*output = regs.output[terminal];
+}
+
+
+
+
 #if (BC_ena) 
 //-------------------------------------------------------------
 //      this function lists bus controller interrupt 
@@ -665,12 +708,7 @@ unsigned short int list_bc_ints_console (void) {
 	#if(!BC_ena) 
 	printf("Bus Controller Is Not Enabled!\n\n\r"); 
 	#endif
-	Write_6131LowReg(MAP_1, BC_INT_ENABLE_REG, 1);
-	i = Read_6131_1word(1);
-	Write_6131LowReg(MAP_1, BC_INT_OUTPUT_ENABLE_REG, 1);
-	j = Read_6131_1word(1);
-	Write_6131LowReg(MAP_1, BC_PENDING_INT_REG, 1);
-	k = Read_6131_1word(1);
+	read_int_regs(INT_BC, &i, &j, &k);
 
 		
 	printf("\n\r Bus Controller Ints   Enabled?   Pin Output?   Pending?\n\r");
@@ -910,8 +948,7 @@ void list_mt_config (void) {
 	char smt = 0;
 
 
-	Write_6131LowReg(MAP_1, MT_CONFIG_REG, 1);
-	i = Read_6131_1word(1);
+	i = READ_6131_REG(MT_CONFIG_REG, 1);
 
 	// IRIG monitor (imt) or Simple monitor (smt)? 
 	if(i & 1) smt = 1;
@@ -1011,8 +1048,7 @@ void mt_last_msg_console(void) {
 		printf("\n\rLast Message Recorded by ");
 
 		// fetch Bus Monitor config word 
-		Write_6131LowReg(MAP_1, MT_CONFIG_REG, 1);
-		i = Read_6131_1word(1);
+		i = READ_6131_REG(MT_CONFIG_REG, 1);
 		// extended message status flags enabled? 
 		if(i & 2) xmf = 1;
 		// Simple monitor (smt)? 
@@ -1021,11 +1057,9 @@ void mt_last_msg_console(void) {
 			smt = 1;
 			//--------------------------------------------------------------
 				// for smt, msg block start addr for last msg is in reg 0x31 
-				Write_6131LowReg(MAP_1, MT_LAST_MSG_STACK_ADDR_REG, 1);
-				addr = Read_6131_1word(1);
+				addr = READ_6131_REG(MT_LAST_MSG_STACK_ADDR_REG, 1);
 				// j = address list offset 
-				Write_6131LowReg(MAP_1, MT_ADDR_LIST_POINTER, 1);
-				j = Read_6131_1word(1);
+				j = READ_6131_REG(MT_ADDR_LIST_POINTER, 1);
 
 				if(!(i&2)) {
 					// smt with 16-bit ttag 
@@ -1083,8 +1117,7 @@ void mt_last_msg_console(void) {
 			printf("IMT:   ");
 			bswo = 4;
 			// the last msg block addr is in register 0x31 
-				Write_6131LowReg(MAP_1, MT_LAST_MSG_STACK_ADDR_REG, 1);
-				addr = Read_6131_1word(1);
+				addr = READ_6131_REG(MT_LAST_MSG_STACK_ADDR_REG, 1);
 
 			// the stored data starts at the 8th word  
 			dbp = addr+7;
@@ -1102,8 +1135,7 @@ void mt_last_msg_console(void) {
 			printf("IMT:   ");
 			bswo = 4;
 			// last msg block addr is stored in 5th word of MT addr list 
-				Write_6131LowReg(MAP_1, MT_ADDR_LIST_POINTER, 1);
-				i = 4 + Read_6131_1word(1);
+				i = 4 + READ_6131_REG(MT_ADDR_LIST_POINTER, 1);
 				Write_6131LowReg(MAP_1, i, 1);
 				addr = Read_6131_1word(1);
 				// the stored data starts at the 8th word  
@@ -1293,15 +1325,9 @@ unsigned short int list_mt_ints_console(void) {
 	unsigned short i, j, k=0;
 	char smt = 0;
 
-		Write_6131LowReg(MAP_1, MT_CONFIG_REG, 1);
-		i = Read_6131_1word(1);
+		i = READ_6131_REG(MT_CONFIG_REG, 1);
 		if(i & 1) smt = 1;
-		Write_6131LowReg(MAP_1, MT_INT_ENABLE_REG, 1);
-		i = Read_6131_1word(1);
-		Write_6131LowReg(MAP_1, MT_INT_OUTPUT_ENABLE_REG, 1);
-		j = Read_6131_1word(1);
-		Write_6131LowReg(MAP_1, MT_PENDING_INT_REG, 1);
-		k = Read_6131_1word(1);
+		read_int_regs(INT_MT, &i, &j, &k);
 	//#endif
 	
 
@@ -1627,12 +1653,7 @@ unsigned short int list_hw_ints_console (void) {
 	printf("\n\r Hardware Interrupts   Enabled?   Pin Output?   Pending?\n\r");
 	print_line();
 
-		Write_6131LowReg(MAP_1, HDW_INT_ENABLE_REG, 1);
-		i = Read_6131_1word(1);
-		Write_6131LowReg(MAP_1, HDW_INT_OUTPUT_ENABLE_REG, 1);
-		j = Read_6131_1word(1);
-		Write_6131LowReg(MAP_1, HDW_PENDING_INT_REG, 1);
-		k = Read_6131_1word(1);
+		read_int_regs(INT_HDW, &i, &j, &k);
 		printf("HI-6131 Host SPI Error");
 		if(!(i & (1<<15))) {	
 			// int disabled 
@@ -1884,12 +1905,7 @@ unsigned short int list_rt_ints_console (void) {
             // formfeed 
             putchar(12); 	
 
-                    Write_6131LowReg(MAP_1, RT_INT_ENABLE_REG, 1);
-                    i = Read_6131_1word(1);
-                    Write_6131LowReg(MAP_1, RT_INT_OUTPUT_ENABLE_REG, 1);
-                    j = Read_6131_1word(1);
-                    Write_6131LowReg(MAP_1, RT_PENDING_INT_REG, 1);
-                    k = Read_6131_1word(1);
+                    read_int_regs(INT_RT, &i, &j, &k);
          //   #endif
     
             printf("\n\r Remote Terminal Ints  Enabled?   Pin Output?   Pending?\n\r");
@@ -2106,6 +2122,23 @@ unsigned short int list_rt_ints_console (void) {
 
 
 
+//-------------------------------------------------------------
+//      this function returns non-zero if BC, RT1, RT2 and MT are
+//	all disabled in Master Config. The benchmark and stress test
+//	overwrite HI-6131 RAM 0x4000-0x4FFF, which holds RT2 transmit
+//	buffers, and step through untested SPI timings while the nIRQ
+//	service and coalescing tick would use the SPI, so they only
+//	run with every terminal stopped. Otherwise a note is printed.
+//-------------------------------------------------------------
+static unsigned char terminals_stopped(void) {
+
+	if((Read_6131_MasterConfig(1) & (BCENA|MTENA|RT2ENA|RT1ENA)) == 0) return 1;
+	printf("\n\r Disable BC, RT1, RT2 and MT first: this test writes RAM 0x4000-0x4FFF\n\r");
+	return 0;
+}
+
+
+
 //---------------------------------------------------------------------------
 //   brief	this function checks for keyboard input and
 //		decodes it, acts on it, when it occurs
@@ -2225,14 +2258,38 @@ void chk_key_input(void) {
                     Memory_watch(waddr);
                 break;
                 
+                case 'b':
+                case 'B':
+                    // SPI throughput benchmark, comma-separated results
+                    if(terminals_stopped()) Bench_6131();
+                    print_menuprompt();
+                break;
+
+                case 's':
+                case 'S':
+                    // last SPI op codes recorded by Start_6131_Trace( )
+                    Dump_6131_Trace(0);
+                    print_menuprompt();
+                break;
+
+                case 'v':
+                case 'V':
+                    // read every SPI read path at every timing, comma-separated results
+                    if(terminals_stopped()) printf("\n\r %lu read errors\n\r", Stress_6131(STRESS_PASSES));
+                    print_menuprompt();
+                break;
+
                 case 't':
                 case 'T':                  
                     // New section to test Read_6131(...)
                   {                  
                     Read_6131(0x0000, 18);   // parms: address, word count                
+                    print_hex_dump(0x0000, read_data, 18);
                     printf("\n\rRead1 done\n\r");     
                     
                   Read_6131_Buffer(16, 0, 0);
+                    // buffer words, address column shows offset into buffer
+                    print_hex_dump(0x0000, read_data, 16);
                     printf("\n\rRead2 done\n\r");                   
                     
                   }
@@ -2347,6 +2404,32 @@ unsigned char ascii2int(char ch) {
                                        
                                        
                                        
+// This function prints words previously read from HI-6131 register/RAM space,
+// 16 words per line. Each group of 64 words (4 lines) is preceded by a header 
+// line showing the group start address and column offsets 1 thru F. Only the 
+// MCU copy is printed, so the SPI is not in use and interrupts stay enabled.
+//
+//  param   address is the HI-6131 address of data[0], shown in group headers
+//  param   data is the array holding the words to display
+//  param   count is the number of words to display
+//
+void print_hex_dump(unsigned short address, const unsigned short *data, unsigned short count) {
+
+    unsigned short i;
+
+    for (i = 0; i < count; i++) {
+        if((i & 0x3F) == 0) {
+            // 4 lines preceded by header
+            printf("\n\rx%.2X%.2X    1    2    3    4    5    6    7    8    9    A    B    C    D    E    F", 
+                    (char)((address+i)>>8), (char)(address+i));
+        }
+        // 16 words / line 
+        if((i & 0x0F) == 0) printf("\n\r");
+        printf("%.4X ", data[i]);
+    }
+}
+
+
 //-----------------------------------------------------------------
 //    these functions give printf for text strings used
 //    many times. reduces ROM needed for text storage
@@ -42,6 +42,9 @@ unsigned short int list_mt_ints_console(void);
 
 unsigned char ascii2int(char ch);
 
+// hex display of words already read from HI-6131 into MCU memory
+void print_hex_dump(unsigned short address, const unsigned short *data, unsigned short count);
+
 // primitive console functions that "printf"
 // redundant char strings to reduce program size
 void print_null(void);
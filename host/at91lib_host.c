@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/at91lib_host.c
+ *    brief     Host build replacements for the Atmel at91lib functions used
+ *              by this project, and the SAM3U register blocks declared in
+ *              host/board.h. Register blocks are plain memory: writes are kept,
+ *              reads return the last value written or the initial value below.
+ *
+ *              Initial values let polling loops finish: SPI status shows the
+ *              transmitter empty and a character received, timer status shows
+ *              the RC compare reached, and the HI-613x READY input is high.
+ */
+
+#include <stdio.h>
+#include <intrinsics.h>
+#include <board.h>
+#include <pio/pio.h>
+#include <pio/pio_it.h>
+#include <spi/spi.h>
+#include <pmc/pmc.h>
+#include <irq/irq.h>
+#include <tc/tc.h>
+#include <usart/usart.h>
+
+
+//------------------------------------------------------------------------------
+//         Register Blocks
+//------------------------------------------------------------------------------
+
+AT91S_SPI  host_spi0 = { .SPI_SR = AT91C_SPI_RDRF | AT91C_SPI_TDRE | AT91C_SPI_TXEMPTY };
+AT91S_PIO  host_pioa;
+AT91S_PIO  host_piob = { .PIO_PDSR = 1 << 2 };     // PIN_READY high
+AT91S_PIO  host_pioc;
+AT91S_TC   host_tc0 = { .TC_SR = AT91C_TC_CPCS };
+AT91S_TC   host_tc1 = { .TC_SR = AT91C_TC_CPCS };
+AT91S_HDMA host_hdma;
+AT91S_RSTC host_rstc;
+
+
+//------------------------------------------------------------------------------
+//         Interrupts
+//------------------------------------------------------------------------------
+
+// simulated interrupt, see host/intrinsics.h. The handler may set host_irq_after
+// again to be called repeatedly
+void (*host_irq_handler)(void);
+unsigned long host_irq_after;
+
+void host_enable_interrupt(void) {
+
+    if(host_irq_after && (--host_irq_after == 0) && host_irq_handler) host_irq_handler();
+}
+
+
+//------------------------------------------------------------------------------
+//         PIO
+//------------------------------------------------------------------------------
+
+unsigned char PIO_Configure(const Pin *list, unsigned int size) {
+
+    for(; size; size--, list++) {
+        if(list->type == PIO_OUTPUT_1) list->pio->PIO_ODSR |= list->mask;
+        else if(list->type == PIO_OUTPUT_0) list->pio->PIO_ODSR &= ~list->mask;
+    }
+    return 1;
+}
+
+void PIO_Set(const Pin *pin) { pin->pio->PIO_ODSR |= pin->mask; }
+void PIO_Clear(const Pin *pin) { pin->pio->PIO_ODSR &= ~pin->mask; }
+
+// inputs read PIO_PDSR, which the host program sets to model DIP switches
+unsigned char PIO_Get(const Pin *pin) {
+
+    if(pin->type == PIO_OUTPUT_0 || pin->type == PIO_OUTPUT_1)
+        return (pin->pio->PIO_ODSR & pin->mask) != 0;
+    return (pin->pio->PIO_PDSR & pin->mask) != 0;
+}
+
+void PIO_InitializeInterrupts(unsigned int priority) { (void)priority; }
+void PIO_ConfigureIt(const Pin *pPin, void (*handler)(const Pin *)) { (void)pPin; (void)handler; }
+void PIO_EnableIt(const Pin *pPin) { (void)pPin; }
+void PIO_DisableIt(const Pin *pPin) { (void)pPin; }
+
+
+//------------------------------------------------------------------------------
+//         SPI, PMC, IRQ, TC
+//------------------------------------------------------------------------------
+
+void SPI_Configure(AT91S_SPI *spi, unsigned int id, unsigned int configuration) {
+
+    (void)id;
+    spi->SPI_MR = configuration;
+}
+
+void SPI_ConfigureNPCS(AT91S_SPI *spi, unsigned int npcs, unsigned int configuration) {
+
+    spi->SPI_CSR[npcs] = configuration;
+}
+
+void SPI_Enable(AT91S_SPI *spi) { (void)spi; }
+
+void PMC_EnablePeripheral(unsigned int id) { (void)id; }
+
+void IRQ_ConfigureIT(unsigned int source, unsigned int priority) { (void)source; (void)priority; }
+void IRQ_EnableIT(unsigned int source) { (void)source; }
+void IRQ_DisableIT(unsigned int source) { (void)source; }
+
+void TC_Configure(AT91S_TC *pTc, unsigned int mode) { pTc->TC_CMR = mode; }
+void TC_Start(AT91S_TC *pTc) { (void)pTc; }
+void TC_Stop(AT91S_TC *pTc) { (void)pTc; }
+
+
+//------------------------------------------------------------------------------
+//         USART (console)
+//------------------------------------------------------------------------------
+
+void USART_Configure(void *usart, unsigned int mode, unsigned int baudrate, unsigned int masterClock) {
+
+    (void)usart; (void)mode; (void)baudrate; (void)masterClock;
+}
+
+void USART_SetTransmitterEnabled(void *usart, unsigned char enabled) { (void)usart; (void)enabled; }
+void USART_SetReceiverEnabled(void *usart, unsigned char enabled) { (void)usart; (void)enabled; }
+
+void USART_Write(void *usart, unsigned short data, volatile unsigned int timeOut) {
+
+    (void)usart; (void)timeOut;
+    putchar(data);
+}
+
+// console input is not used by the host program
+unsigned char USART_IsRxReady(void *usart) { (void)usart; return 0; }
+unsigned char USART_GetChar(void *usart) { (void)usart; return 0; }
+
+// end of file
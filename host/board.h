@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/board.h
+ *    brief     Host build replacement for the Atmel at91lib board.h. Declares
+ *              the SAM3U peripheral register blocks used by this project as
+ *              ordinary memory so the HI-6131 driver compiles and runs on a
+ *              Linux PC against the simulated HI-6131 in host/hi6131_sim.c.
+ *
+ *              Only the registers, bit masks and peripheral IDs referenced by
+ *              the Holt project files are defined. Values match the SAM3U.
+ *
+ *              See host/host_main.c for the host build command.
+ *
+ *	   	HOLT DISCLAIMER
+ *      	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+ *      	KIND, EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ *      	WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ *      	PURPOSE AND NONINFRINGEMENT.
+ *      	IN NO EVENT SHALL HOLT, INC BE LIABLE FOR ANY CLAIM, DAMAGES
+ *      	OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ *      	OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *      	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ *              Copyright (C) 2009-2011 by  HOLT, Inc.
+ *              All Rights Reserved
+ */
+
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+
+//------------------------------------------------------------------------------
+//         Peripheral Register Blocks
+//------------------------------------------------------------------------------
+
+typedef volatile unsigned int AT91_REG;
+
+typedef struct {
+    AT91_REG SPI_CR, SPI_MR, SPI_RDR, SPI_TDR, SPI_SR, SPI_IER, SPI_IDR, SPI_IMR;
+    AT91_REG Reserved0[4];
+    AT91_REG SPI_CSR[4];
+} AT91S_SPI, *AT91PS_SPI;
+
+typedef struct {
+    AT91_REG PIO_PER, PIO_PDR, PIO_PSR, PIO_SODR, PIO_CODR, PIO_ODSR, PIO_PDSR;
+    AT91_REG PIO_IER, PIO_IDR, PIO_IMR, PIO_ISR;
+} AT91S_PIO, *AT91PS_PIO;
+
+typedef struct {
+    AT91_REG TC_CCR, TC_CMR, TC_CV, TC_RA, TC_RB, TC_RC, TC_SR, TC_IER, TC_IDR, TC_IMR;
+} AT91S_TC, *AT91PS_TC;
+
+typedef struct {
+    AT91_REG HDMA_SADDR, HDMA_DADDR, HDMA_DSCR, HDMA_CTRLA, HDMA_CTRLB, HDMA_CFG;
+    AT91_REG HDMA_SPIP, HDMA_DPIP, Reserved0[2];
+} AT91S_HDMA_CH, *AT91PS_HDMA_CH;
+
+typedef struct {
+    AT91_REG HDMA_GCFG, HDMA_EN, HDMA_SREQ, HDMA_CREQ, HDMA_LAST, Reserved0;
+    AT91_REG HDMA_EBCIER, HDMA_EBCIDR, HDMA_EBCIMR, HDMA_EBCISR;
+    AT91_REG HDMA_CHER, HDMA_CHDR, HDMA_CHSR, Reserved1[2];
+    AT91S_HDMA_CH HDMA_CH[4];
+} AT91S_HDMA, *AT91PS_HDMA;
+
+typedef struct {
+    AT91_REG RSTC_RCR, RSTC_RSR, RSTC_RMR;
+} AT91S_RSTC, *AT91PS_RSTC;
+
+// register block instances, defined in host/at91lib_host.c
+extern AT91S_SPI  host_spi0;
+extern AT91S_PIO  host_pioa, host_piob, host_pioc;
+extern AT91S_TC   host_tc0, host_tc1;
+extern AT91S_HDMA host_hdma;
+extern AT91S_RSTC host_rstc;
+
+#define AT91C_BASE_SPI0     (&host_spi0)
+#define AT91C_BASE_PIOA     (&host_pioa)
+#define AT91C_BASE_PIOB     (&host_piob)
+#define AT91C_BASE_PIOC     (&host_pioc)
+#define AT91C_BASE_TC0      (&host_tc0)
+#define AT91C_BASE_TC1      (&host_tc1)
+#define AT91C_BASE_HDMA     (&host_hdma)
+#define AT91C_BASE_RSTC     (&host_rstc)
+#define AT91C_BASE_US1      ((void *)0)
+
+//------------------------------------------------------------------------------
+//         Peripheral IDs and Bit Definitions
+//------------------------------------------------------------------------------
+
+#define AT91C_ID_DBGU       8
+#define AT91C_ID_PIOA       10
+#define AT91C_ID_PIOB       11
+#define AT91C_ID_PIOC       12
+#define AT91C_ID_US1        14
+#define AT91C_ID_SPI0       20
+#define AT91C_ID_TC0        22
+#define AT91C_ID_TC1        23
+#define AT91C_ID_HDMA       28
+
+#define AT91C_SPI_RDRF      (1u << 0)
+#define AT91C_SPI_TDRE      (1u << 1)
+#define AT91C_SPI_OVRES     (1u << 3)
+#define AT91C_SPI_TXEMPTY   (1u << 9)
+#define SPI_PCS(npcs)       ((~(1 << npcs) & 0xF) << 16)
+
+#define AT91C_TC_CLKEN      (1u << 0)
+#define AT91C_TC_CLKDIS     (1u << 1)
+#define AT91C_TC_SWTRG      (1u << 2)
+#define AT91C_TC_CPCS       (1u << 4)
+#define AT91C_TC_CPCSTOP    (1u << 6)
+#define AT91C_TC_WAVESEL_UP_AUTO        (2u << 13)
+#define AT91C_TC_WAVE       (1u << 15)
+#define AT91C_TC_CLKS_TIMER_DIV1_CLOCK  0
+#define AT91C_TC_CLKS_TIMER_DIV2_CLOCK  1
+#define AT91C_TC_CLKS_TIMER_DIV3_CLOCK  2
+#define AT91C_TC_CLKS_TIMER_DIV4_CLOCK  3
+
+//------------------------------------------------------------------------------
+//         Board Definitions
+//------------------------------------------------------------------------------
+
+#define BOARD_MCK           48000000
+#define BOARD_USART_BASE    AT91C_BASE_US1
+#define BOARD_ID_USART      AT91C_ID_US1
+
+#endif // HOST_BOARD_H
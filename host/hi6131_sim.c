@@ -0,0 +1,494 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/hi6131_sim.c
+ *    brief     Simulated HI-6131 SPI slave for the host build.
+ *
+ *              Each chip select assertion begins an op code. The first 8 bits
+ *              shifted in are the op code, then data words follow, upper byte
+ *              first. 16-bit frames are handled as two bytes, so the model
+ *              does not care whether the driver uses 8-bit or 16-bit frames.
+ *
+ *              Op codes modeled:
+ *
+ *              0x00-0x3C   fast read, register (op code >> 2), 0-15
+ *              0x40        read at enabled MAP, MAP auto-increments
+ *              0x48/0x50   copy RT1/RT2 Current Control Word Address to MAP, read
+ *              0x58        MAP = Interrupt Log Address - 1, read, MAP decrements
+ *              0x60        read at enabled MAP, then MAP += 4
+ *              0x68-0x78   MAP += 0,1,2 then MAP = RAM[MAP], read buffer
+ *              0x80-0xBF   fast write, register (op code - 0x80), 0-63
+ *              0xC0        write at enabled MAP, MAP auto-increments
+ *              0xC8        MAP += 1, then write as 0xC0
+ *              0xD0-0xD4   add 1, 2 or 4 to enabled MAP
+ *              0xD8-0xDB   enable MAP1-MAP4 (Master Config bits 11-10)
+ *              0xE8-0xF8   MAP += 0,1,2 then MAP = RAM[MAP], write buffer
+ *
+ *              Auto-increment does not advance the MAP onto an RT Descriptor
+ *              Table Control Word (every 4th word of the 512-word table at the
+ *              RT1 or RT2 Descriptor Table Base Address, when non-zero) unless
+ *              the FRAMA bit is set in the Test Control register. The driver
+ *              must reload the MAP there, as it does on the device.
+ *
+ *              Reading a pending interrupt register (0x06-0x09) clears it, and
+ *              the Hardware Pending register's RTIP, MTIP and BCIP bits show
+ *              whether the RT, MT and BC pending registers are non-zero.
+ *              Reading register 0x0A clears its interrupt count, bits 15-9.
+ *              sim_6131_log_interrupt( ) logs an interrupt as the device does.
+ *              Other register side effects (status bits, time tags) are not
+ *              modeled.
+ */
+
+#include <board.h>
+#include "613x_initialization.h"
+#include "board_6131.h"
+#include "device_6131.h"
+#include "hi6131_sim.h"
+
+
+//------------------------------------------------------------------------------
+//         Local Definitions
+//------------------------------------------------------------------------------
+
+#define SIM_ADDR_MASK       0x7FFF      // 32K word address space
+#define SIM_DTABLE_SIZE     512         // words in an RT Descriptor Table
+#define SIM_ILOG_FIRST      0x0180      // Interrupt Log buffer
+#define SIM_RT1_DTABLE      0x0400      // RT1 Descriptor Table base after reset
+#define SIM_RT2_DTABLE      0x0600      // RT2 Descriptor Table base after reset
+#define SIM_ILOG_LAST       0x01BF
+#define SIM_FRAMA           0x1000      // Test Control reg: RAM writes unrestricted
+
+// data phase behavior of the op code in progress
+#define OP_NONE         0   // op code only, any data clocked is ignored
+#define OP_READ_REG     1   // fast read, same register every word
+#define OP_WRITE_REG    2   // fast write, first word only
+#define OP_READ_MAP     3   // read at MAP, auto-increment
+#define OP_READ_ADV4    4   // read at MAP, MAP += 4
+#define OP_READ_DEC     5   // read at MAP, MAP decrements in Interrupt Log
+#define OP_WRITE_MAP    6   // write at MAP, auto-increment
+
+
+//------------------------------------------------------------------------------
+//         Local Variables
+//------------------------------------------------------------------------------
+
+// registers 0x0000-0x003F and RAM share one address space
+static unsigned short sim_mem[SIM_ADDR_MASK + 1];
+
+static unsigned char  selected;     // chip select asserted
+static unsigned char  have_opcode;  // op code byte received since select
+static unsigned char  op;           // OP_xxx for the op code in progress
+static unsigned char  reg;          // register for fast read/write
+static unsigned char  byte_count;   // data bytes received for this op code
+static unsigned char  hi_byte;      // first byte of a data word being written
+static unsigned short out_word;     // data word being shifted out
+
+static SIM_6131_STATS stats;
+// modeled SPI bus time since reset, not cleared with the statistics
+static double total_ns;
+// fastest SCBR and shortest DLYBCT this board reads reliably, 0 = no limit
+static unsigned char min_scbr, min_dlybct;
+
+
+//------------------------------------------------------------------------------
+//         Local Functions
+//------------------------------------------------------------------------------
+
+// the enabled Memory Address Pointer register address, 0x000B-0x000E
+static unsigned short map_reg(void) {
+
+    return (MAP_1) + ((sim_mem[(MASTER_CONFIG_REG)] >> 10) & 0x0003);
+}
+
+
+// non-zero if address is a Control Word in the RT1 or RT2 Descriptor Table
+static unsigned char is_control_word(unsigned short address) {
+
+    unsigned short base;
+
+    if(sim_mem[(TEST_CONTROL_REG)] & SIM_FRAMA) return 0;
+
+    base = sim_mem[(RT1_DESC_TBL_BASE_ADDR_REG)];
+    if(base && (address >= base) && (address < base + SIM_DTABLE_SIZE)
+        && (((address - base) & 0x0003) == 0)) return 1;
+
+    base = sim_mem[(RT2_DESC_TBL_BASE_ADDR_REG)];
+    if(base && (address >= base) && (address < base + SIM_DTABLE_SIZE)
+        && (((address - base) & 0x0003) == 0)) return 1;
+
+    return 0;
+}
+
+
+// auto-increment the enabled MAP, except onto a descriptor Control Word
+static void map_increment(void) {
+
+    unsigned short next = (sim_mem[map_reg()] + 1) & SIM_ADDR_MASK;
+
+    if(!is_control_word(next)) sim_mem[map_reg()] = next;
+}
+
+
+// buffer op codes: advance MAP by 0, 1 or 2, then load MAP from the addressed word
+static void map_indirect(unsigned char adjust) {
+
+    unsigned short m = map_reg();
+
+    sim_mem[m] = (sim_mem[m] + adjust) & SIM_ADDR_MASK;
+    sim_mem[m] = sim_mem[sim_mem[m]] & SIM_ADDR_MASK;
+}
+
+
+// decode op code byte, perform any MAP setup
+static void start_opcode(unsigned char opcode) {
+
+    unsigned short m = map_reg();
+
+    op = OP_NONE;
+
+    if(opcode < 0x40) {
+        if(opcode & 0x03) stats.bad_opcodes++;
+        else {
+            op = OP_READ_REG;
+            reg = opcode >> 2;
+        }
+    }
+    else if((opcode >= 0x80) && (opcode < 0xC0)) {
+        op = OP_WRITE_REG;
+        reg = opcode - 0x80;
+    }
+    else switch(opcode) {
+
+        case 0x40:
+            op = OP_READ_MAP;
+            break;
+        case 0x48:
+            sim_mem[m] = sim_mem[(RT1_CURR_CTRL_WORD_ADDR_REG)] & SIM_ADDR_MASK;
+            op = OP_READ_MAP;
+            break;
+        case 0x50:
+            sim_mem[m] = sim_mem[(RT2_CURR_CTRL_WORD_ADDR_REG)] & SIM_ADDR_MASK;
+            op = OP_READ_MAP;
+            break;
+        case 0x58:
+            // Interrupt Log Address points to the next IIW, back up to last IAW
+            sim_mem[m] = sim_mem[(INT_COUNT_AND_LOG_ADDR_REG)] & 0x01FF;
+            if(sim_mem[m] <= SIM_ILOG_FIRST) sim_mem[m] = SIM_ILOG_LAST;
+            else sim_mem[m]--;
+            op = OP_READ_DEC;
+            break;
+        case 0x60:
+            op = OP_READ_ADV4;
+            break;
+        case 0x68:
+        case 0x70:
+        case 0x78:
+            map_indirect((opcode - 0x68) >> 3);
+            op = OP_READ_MAP;
+            break;
+        case 0xC8:
+            sim_mem[m] = (sim_mem[m] + 1) & SIM_ADDR_MASK;
+            // fall through
+        case 0xC0:
+            op = OP_WRITE_MAP;
+            break;
+        case 0xD0:
+        case 0xD2:
+        case 0xD4:
+            sim_mem[m] = (sim_mem[m] + (1 << ((opcode - 0xD0) >> 1))) & SIM_ADDR_MASK;
+            break;
+        case 0xD8:
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+            sim_mem[(MASTER_CONFIG_REG)] = (sim_mem[(MASTER_CONFIG_REG)] & ~0x0C00)
+                                         | ((opcode - 0xD8) << 10);
+            break;
+        case 0xE8:
+        case 0xF0:
+        case 0xF8:
+            map_indirect((opcode - 0xE8) >> 3);
+            op = OP_WRITE_MAP;
+            break;
+        default:
+            stats.bad_opcodes++;
+            break;
+    }
+}
+
+
+// read a register or RAM word, with pending interrupt register side effects
+static unsigned short mem_read(unsigned short address) {
+
+    unsigned short data = sim_mem[address];
+
+    if((address >= (HDW_PENDING_INT_REG)) && (address <= (RT_PENDING_INT_REG))) {
+        sim_mem[address] = 0;
+        if(address == (HDW_PENDING_INT_REG)) {
+            data &= ~0x0007;
+            if(sim_mem[(RT_PENDING_INT_REG)]) data |= 0x0004;   // RTIP
+            if(sim_mem[(MT_PENDING_INT_REG)]) data |= 0x0002;   // MTIP
+            if(sim_mem[(BC_PENDING_INT_REG)]) data |= 0x0001;   // BCIP
+        }
+    }
+    else if(address == (INT_COUNT_AND_LOG_ADDR_REG)) sim_mem[address] &= 0x01FF;
+    return data;
+}
+
+
+// fetch the next word shifted out for a read op code
+static unsigned short read_word(void) {
+
+    unsigned short m = map_reg();
+    unsigned short data = 0xFFFF;
+
+    switch(op) {
+        case OP_READ_REG:
+            data = mem_read(reg);
+            break;
+        case OP_READ_MAP:
+            data = mem_read(sim_mem[m] & SIM_ADDR_MASK);
+            map_increment();
+            break;
+        case OP_READ_ADV4:
+            data = sim_mem[sim_mem[m] & SIM_ADDR_MASK];
+            sim_mem[m] = (sim_mem[m] + 4) & SIM_ADDR_MASK;
+            break;
+        case OP_READ_DEC:
+            data = sim_mem[sim_mem[m] & SIM_ADDR_MASK];
+            if(sim_mem[m] <= SIM_ILOG_FIRST) sim_mem[m] = SIM_ILOG_LAST;
+            else sim_mem[m]--;
+            break;
+        default:
+            return data;
+    }
+    stats.words_read++;
+    return data;
+}
+
+
+// store a complete word received for a write op code
+static void write_word(unsigned short data) {
+
+    unsigned short m = map_reg();
+
+    switch(op) {
+        case OP_WRITE_REG:
+            // fast write stores the first data word only
+            if(byte_count == 2) {
+                sim_mem[reg] = data;
+                stats.words_written++;
+            }
+            break;
+        case OP_WRITE_MAP:
+            sim_mem[sim_mem[m] & SIM_ADDR_MASK] = data;
+            map_increment();
+            stats.words_written++;
+            break;
+        default:
+            break;
+    }
+}
+
+
+// SPI timing fields from the chip select register the driver programmed
+static unsigned int csr_field(unsigned char shift) {
+
+    return (AT91C_BASE_SPI0->SPI_CSR[BOARD_6131_NPCS] >> shift) & 0xFF;
+}
+
+
+// one byte shifted each way while chip select is asserted
+static unsigned char shift_byte(unsigned char mosi) {
+
+    unsigned char miso = 0;
+
+    if(!selected) return 0xFF;
+
+    if(!have_opcode) {
+        have_opcode = 1;
+        start_opcode(mosi);
+        return 0;
+    }
+
+    byte_count++;
+    if(op == OP_WRITE_REG || op == OP_WRITE_MAP) {
+        if(byte_count & 1) hi_byte = mosi;
+        else write_word((hi_byte << 8) | mosi);
+    }
+    else if(op != OP_NONE) {
+        if(byte_count & 1) {
+            out_word = read_word();
+            miso = out_word >> 8;
+        }
+        else miso = out_word & 0xFF;
+        // timing faster than the board allows: a data bit is sampled late
+        if((csr_field(8) < min_scbr) || (csr_field(24) < min_dlybct)) miso ^= 0x01;
+    }
+    return miso;
+}
+
+
+//------------------------------------------------------------------------------
+//         Functions
+//------------------------------------------------------------------------------
+
+//	This function clears all registers and RAM, enables MAP1 and clears the
+//	statistics, like a HI-6131 master reset without auto-initialization.
+//
+void sim_6131_reset(void) {
+
+    unsigned int i;
+
+    for(i = 0; i <= SIM_ADDR_MASK; i++) sim_mem[i] = 0;
+    sim_mem[(INT_COUNT_AND_LOG_ADDR_REG)] = SIM_ILOG_FIRST;
+    sim_mem[(RT1_DESC_TBL_BASE_ADDR_REG)] = SIM_RT1_DTABLE;
+    sim_mem[(RT2_DESC_TBL_BASE_ADDR_REG)] = SIM_RT2_DTABLE;
+    selected = 0;
+    have_opcode = 0;
+    op = OP_NONE;
+    total_ns = 0;
+    min_scbr = 0;
+    min_dlybct = 0;
+    sim_6131_clear_stats();
+}
+
+
+//	Chip select asserted: the next 8 bits are an op code
+//
+void sim_6131_select(void) {
+
+    selected = 1;
+    have_opcode = 0;
+    byte_count = 0;
+    op = OP_NONE;
+    stats.selects++;
+    // DLYBS, delay from chip select to first SCK edge
+    stats.bus_ns += csr_field(16) * 1e9 / BOARD_MCK;
+    total_ns += csr_field(16) * 1e9 / BOARD_MCK;
+}
+
+
+//	Chip select negated: any op code in progress ends
+//
+void sim_6131_deselect(void) {
+
+    selected = 0;
+    op = OP_NONE;
+}
+
+
+//	This function shifts one 8-bit or 16-bit SPI frame, most significant bit
+//	first, and returns the frame received from the HI-6131.
+//
+//	param	mosi is the frame transmitted by the MCU
+//	param	bits is the frame size, 8 or 16
+//
+unsigned short sim_6131_frame(unsigned short mosi, unsigned char bits) {
+
+    unsigned int scbr = csr_field(8);
+    unsigned short miso;
+    double ns;
+
+    if(scbr == 0) scbr = 1;
+    // SCK clocks then DLYBCT delay between consecutive transfers
+    ns = (bits * scbr + 32 * csr_field(24)) * 1e9 / BOARD_MCK;
+    stats.bus_ns += ns;
+    total_ns += ns;
+
+    if(bits == 16) {
+        stats.frames16++;
+        miso = shift_byte(mosi >> 8) << 8;
+        miso |= shift_byte(mosi & 0xFF);
+    }
+    else {
+        stats.frames8++;
+        miso = shift_byte(mosi & 0xFF);
+    }
+    return miso;
+}
+
+
+//	These functions access the model's register/RAM space directly, without
+//	SPI activity, so tests can set up or check contents independently of the
+//	driver functions being tested.
+//
+unsigned short sim_6131_peek(unsigned short address) {
+
+    return sim_mem[address & SIM_ADDR_MASK];
+}
+
+
+void sim_6131_poke(unsigned short address, unsigned short data) {
+
+    sim_mem[address & SIM_ADDR_MASK] = data;
+}
+
+
+//	This function logs one interrupt like the device: the IIW/IAW pair is
+//	written at the Interrupt Log Address, which advances around the 0x0180-
+//	0x01BF ring, and the interrupt count in register 0x0A bits 15-9 is
+//	incremented, saturating at 127. Pending registers are not changed.
+//
+void sim_6131_log_interrupt(unsigned short iiw, unsigned short iaw) {
+
+    unsigned short reg = sim_mem[(INT_COUNT_AND_LOG_ADDR_REG)];
+    unsigned short addr = reg & 0x01FF;
+    unsigned short count = reg >> 9;
+
+    sim_mem[addr] = iiw;
+    sim_mem[addr + 1] = iaw;
+    addr += 2;
+    if(addr > SIM_ILOG_LAST) addr = SIM_ILOG_FIRST;
+    if(count < 127) count++;
+    sim_mem[(INT_COUNT_AND_LOG_ADDR_REG)] = (count << 9) | addr;
+}
+
+
+//	This function models a board with marginal SPI timing: while SCBR is below
+//	min_scbr or DLYBCT is below min_dlybct, bit 0 of every data byte the
+//	HI-6131 shifts out is received inverted. Zero for both removes the limit.
+//
+void sim_6131_set_limits(unsigned char scbr, unsigned char dlybct) {
+
+    min_scbr = scbr;
+    min_dlybct = dlybct;
+}
+
+
+//	returns the enabled Memory Address Pointer number, 1-4
+//
+unsigned char sim_6131_map(void) {
+
+    return (unsigned char)(map_reg() - (MAP_1) + 1);
+}
+
+
+void sim_6131_get_stats(SIM_6131_STATS *s) {
+
+    *s = stats;
+}
+
+
+//	returns modeled SPI bus time since reset in MCLK cycles, the host build's
+//	stand-in for the DWT cycle counter. CPU time between frames is not included.
+//
+unsigned long sim_6131_cycles(void) {
+
+    return (unsigned long)(total_ns * (BOARD_MCK / 1e9));
+}
+
+
+void sim_6131_clear_stats(void) {
+
+    stats.selects = 0;
+    stats.frames8 = 0;
+    stats.frames16 = 0;
+    stats.words_read = 0;
+    stats.words_written = 0;
+    stats.bad_opcodes = 0;
+    stats.bus_ns = 0;
+}
+
+// end of file
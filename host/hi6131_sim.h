@@ -0,0 +1,53 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/hi6131_sim.h
+ *    brief     Simulated HI-6131 SPI slave for the host build. In a host build
+ *              (HOST_MODEL = YES) the SPI frame functions in board_6131.c pass
+ *              every chip select edge and SPI frame to this model instead of
+ *              the SAM3U SPI0 and PIOA registers.
+ *
+ *              The model holds the 64 fast-access registers and 32K words of
+ *              RAM as one 0x0000-0x7FFF address space, the four Memory Address
+ *              Pointers selected by Master Config bits 11-10, and decodes the
+ *              HI-6131 SPI op codes. Modeled SPI bus time is accumulated from
+ *              the SCBR, DLYBS and DLYBCT fields the driver programs into
+ *              SPI_CSR[BOARD_6131_NPCS].
+ *
+ *              See host/host_main.c for the host build command.
+ */
+
+#ifndef HI6131_SIM_H
+#define HI6131_SIM_H
+
+// SPI bus activity counted since the last sim_6131_clear_stats( )
+typedef struct {
+    unsigned long selects;          // chip select assertions (one per op code)
+    unsigned long frames8;          // 8-bit SPI frames
+    unsigned long frames16;         // 16-bit SPI frames
+    unsigned long words_read;       // data words shifted out by the HI-6131
+    unsigned long words_written;    // data words stored by the HI-6131
+    unsigned long bad_opcodes;      // undefined op codes received
+    double        bus_ns;           // modeled SCK + delay time, nanoseconds
+} SIM_6131_STATS;
+
+
+//------------------------------------------------------------------------------
+//      Global Function Prototypes
+//------------------------------------------------------------------------------
+
+void sim_6131_reset(void);
+void sim_6131_select(void);
+void sim_6131_deselect(void);
+unsigned short sim_6131_frame(unsigned short mosi, unsigned char bits);
+unsigned short sim_6131_peek(unsigned short address);
+void sim_6131_poke(unsigned short address, unsigned short data);
+void sim_6131_log_interrupt(unsigned short iiw, unsigned short iaw);
+void sim_6131_set_limits(unsigned char scbr, unsigned char dlybct);
+unsigned char sim_6131_map(void);
+void sim_6131_get_stats(SIM_6131_STATS *stats);
+void sim_6131_clear_stats(void);
+unsigned long sim_6131_cycles(void);
+
+#endif // HI6131_SIM_H
@@ -0,0 +1,1123 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/host_main.c
+ *    brief     Host program that runs the HI-6131 SPI driver (board_6131.c)
+ *              and the BC, RT and MT initialization files against the
+ *              simulated HI-6131 in host/hi6131_sim.c, on a Linux PC.
+ *
+ *              Every transfer primitive is checked against the model's RAM
+ *              and register contents, then each initialization routine is
+ *              run. For each step the program prints host run time, SPI bus
+ *              activity and the SPI bus time modeled from the SPI_CSR timing
+ *              programmed by Configure_ARM_MCU_SPI( ). Exit status is the
+ *              number of failed checks.
+ *
+ *              "hi6131_host bench" instead runs the 613x_bench.c benchmark
+ *              and prints its comma-separated results. "hi6131_host stress
+ *              [passes]" runs the 613x_bench.c read stress test.
+ *
+ *              Build and run from the project directory:
+ *
+ *              gcc -std=gnu99 -O2 -DHOST_MODEL=1 -DBC_ena=1 -DRT1_ena=1 \
+ *                  -DRT2_ena=1 -DSMT_ena=1 -DIMT_ena=0 -Ihost -I. \
+ *                  host/host_main.c host/hi6131_sim.c host/at91lib_host.c \
+ *                  board_6131.c board_613x.c console.c \
+ *                  613x_bc.c 613x_rt.c 613x_mt.c 613x_bench.c 613x_irq.c \
+ *                  -o hi6131_host
+ *              ./hi6131_host
+ *
+ *              main.c, board_lowlevel.c and printf_usart.c are target-only.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <intrinsics.h>
+#include <board.h>
+#include "613x_initialization.h"
+#include "613x_regs.h"
+#include "613x_bc.h"
+#include "613x_rt.h"
+#include "613x_mt.h"
+#include "board_613x.h"
+#include "board_6131.h"
+#include "device_6131.h"
+#include "613x_bench.h"
+#include "613x_irq.h"
+#include "hi6131_sim.h"
+
+
+//------------------------------------------------------------------------------
+//         Local Variables
+//------------------------------------------------------------------------------
+
+extern unsigned short read_data[];
+
+static unsigned short buf_a[4096], buf_b[4096];
+static int failures;
+static struct timespec t_start;
+static unsigned short isr_count;
+static unsigned short irq_seen[IRQ_SOURCES];
+// interrupt log entries passed to the handlers: IAW, and source in upper bits
+static unsigned short ilog_seen[64];
+static unsigned short ilog_seen_count;
+
+
+//------------------------------------------------------------------------------
+//         Local Functions
+//------------------------------------------------------------------------------
+
+// begin a timed step: clear model statistics, note host time
+static void step_begin(void) {
+
+    sim_6131_clear_stats();
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+}
+
+
+// end a timed step: print one result line
+static void step_end(const char *name, int ok) {
+
+    struct timespec t;
+    SIM_6131_STATS s;
+    double host_us;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    sim_6131_get_stats(&s);
+    host_us = (t.tv_sec - t_start.tv_sec) * 1e6 + (t.tv_nsec - t_start.tv_nsec) / 1e3;
+    if(s.bad_opcodes) ok = 0;
+    if(!ok) failures++;
+
+    printf("%-30s %4s %10.1f %8lu %8lu %8lu %8lu %8lu %12.1f\n", name, ok ? "PASS" : "FAIL",
+           host_us, s.selects, s.frames8, s.frames16, s.words_read, s.words_written, s.bus_ns / 1e3);
+}
+
+
+// non-zero if model RAM/registers at address match data[0..count-1]
+static int model_matches(unsigned short address, const unsigned short *data, unsigned short count) {
+
+    unsigned short i;
+
+    for(i = 0; i < count; i++)
+        if(sim_6131_peek(address + i) != data[i]) return 0;
+    return 1;
+}
+
+
+// fill buffer with a pattern that differs for each seed and word
+static void make_pattern(unsigned short *data, unsigned short count, unsigned short seed) {
+
+    unsigned short i;
+
+    for(i = 0; i < count; i++) data[i] = (unsigned short)(seed * 0x1021 + i * 0x9E37);
+}
+
+
+// burst completion callback: the count of the last burst finished
+static unsigned short burst_cb_count;
+
+static void burst_cb(unsigned short *buffer, unsigned short count) {
+
+    (void)buffer;
+    burst_cb_count = count;
+}
+
+
+// message interrupt model: writes one word through its own MAP, then re-arms
+// for the 7th following interrupt window
+static void test_isr(void) {
+
+    unsigned char savemap = Enter_6131_ISR(MAP_MSG_ISR);
+
+    if(savemap) {
+        Write_6131LowReg(MAP_REG(MAP_MSG_ISR), 0x6000 + isr_count, 0);
+        Write_6131_1word(0xC000 + isr_count, 0);
+        Exit_6131_ISR(savemap);
+        isr_count++;
+    }
+    host_irq_after = 7;
+}
+
+
+// HI-6131 interrupt callbacks, record the pending bits passed
+static void cb_hw(unsigned short pending)  { irq_seen[IRQ_HW] |= pending; }
+static void cb_bc(unsigned short pending)  { irq_seen[IRQ_BC] |= pending; }
+static void cb_rt1(unsigned short pending) { irq_seen[IRQ_RT1] |= pending; }
+static void cb_rt2(unsigned short pending) { irq_seen[IRQ_RT2] |= pending; }
+
+// MT callback also reads a word, from the main loop like console code
+static void cb_mt(unsigned short pending) {
+
+    irq_seen[IRQ_MT] |= pending;
+    Write_6131LowReg(MAP_REG(MAP_CONSOLE), 0x6100, 1);
+    if(Read_6131_1word(1) != 0x1234) irq_seen[IRQ_MT] = 0;
+}
+
+
+// interrupt log handlers, record the IAW tagged with the handler's source
+static void ilog_record(unsigned char source, unsigned short iaw) {
+
+    if(ilog_seen_count < 64) ilog_seen[ilog_seen_count] = (source << 12) | (iaw & 0x0FFF);
+    ilog_seen_count++;
+}
+
+static void ilog_bc(unsigned short iiw, unsigned short iaw)  { ilog_record(IRQ_BC, iaw); }
+static void ilog_rt1(unsigned short iiw, unsigned short iaw) { ilog_record(IRQ_RT1, iaw); }
+static void ilog_rt2(unsigned short iiw, unsigned short iaw) { ilog_record(IRQ_RT2, iaw); }
+static void ilog_mt(unsigned short iiw, unsigned short iaw)  { ilog_record(IRQ_MT, iaw); }
+
+// log n interrupts cycling through RT1, RT2, MT and BC, IAW = first_iaw + i
+static void ilog_generate(unsigned short n, unsigned short first_iaw) {
+
+    static const unsigned short iiw[4] = { (RTIP) | (RT1_IWA), (RTIP) | (RT2_IWA), (MTIP) | 0x0010, (BCIP) | (BCEOM) };
+    unsigned short i;
+
+    for(i = 0; i < n; i++) sim_6131_log_interrupt(iiw[(first_iaw + i) & 3], first_iaw + i);
+}
+
+// non-zero if handlers saw IAW first_iaw through first_iaw + n - 1 in order
+static int ilog_matches(unsigned short n, unsigned short first_iaw) {
+
+    static const unsigned char source[4] = { IRQ_RT1, IRQ_RT2, IRQ_MT, IRQ_BC };
+    unsigned short i, iaw;
+
+    if(ilog_seen_count != n) return 0;
+    for(i = 0; i < n; i++) {
+        iaw = first_iaw + i;
+        if(ilog_seen[i] != ((source[iaw & 3] << 12) | (iaw & 0x0FFF))) return 0;
+    }
+    return 1;
+}
+
+
+//------------------------------------------------------------------------------
+//         Transfer Primitive Checks
+//------------------------------------------------------------------------------
+
+static void check_primitives(void) {
+
+    unsigned short i, w;
+    SIM_6131_STATS stats;
+    int ok;
+
+    step_begin();
+    ok = 1;
+    for(i = 0; i < 16; i++) {
+        if((i == MASTER_CONFIG_REG) || ((i >= MAP_1) && (i <= MAP_4))) continue;
+        // pending interrupt registers clear when read
+        if((i >= HDW_PENDING_INT_REG) && (i <= RT_PENDING_INT_REG)) continue;
+        Write_6131LowReg(i, 0xA500 + i, 1);
+        if(Read_6131LowReg(i, 1) != 0xA500 + i) ok = 0;
+    }
+    step_end("Write/Read_6131LowReg", ok);
+
+    step_begin();
+    enaMAP(2);
+    ok = (sim_6131_map() == 2) && (getMAPaddr() == MAP_2);
+    enaMAP(1);
+    ok = ok && (sim_6131_map() == 1);
+    step_end("enaMAP/getMAPaddr", ok);
+
+    // Master Config shadow: one device read after invalidate, MAP changes are one op code
+    step_begin();
+    Invalidate_6131_MasterConfig();
+    sim_6131_clear_stats();
+    ok = (Read_6131_MasterConfig(1) == sim_6131_peek(MASTER_CONFIG_REG));
+    enaMAP(3);
+    ok = ok && (getMAPaddr() == MAP_3) && (sim_6131_map() == 3);
+    Write_6131LowReg(MASTER_CONFIG_REG, Read_6131_MasterConfig(1) | (1 << 13), 1);
+    ok = ok && ((Read_6131_MasterConfig(1) & (1 << 13)) == 0);
+    enaMAP(1);
+    ok = ok && (Read_6131_MasterConfig(1) == (sim_6131_peek(MASTER_CONFIG_REG) & ~(1 << 13)));
+    sim_6131_get_stats(&stats);
+    ok = ok && (stats.selects == 4);
+    Write_6131LowReg(MASTER_CONFIG_REG, Read_6131_MasterConfig(1), 1);
+    step_end("Master Config shadow", ok);
+
+    make_pattern(buf_a, 4096, 1);
+    step_begin();
+    Write_6131_Block(0x1000, buf_a, 4096, 0, 1);
+    ok = model_matches(0x1000, buf_a, 4096) && (sim_6131_map() == 1);
+    step_end("Write_6131_Block 4096", ok);
+
+    step_begin();
+    Read_6131_Block(0x1000, buf_b, 4096, 0, 1);
+    ok = model_matches(0x1000, buf_b, 4096) && (sim_6131_map() == 1);
+    step_end("Read_6131_Block 4096", ok);
+
+    // interrupts between words use MAP4, transfers resume with a new op code
+    make_pattern(buf_a, 1000, 7);
+    isr_count = 0;
+    host_irq_handler = test_isr;
+    host_irq_after = 7;
+    step_begin();
+    Write_6131_Block(0x5000, buf_a, 1000, 0, 1);
+    Read_6131_Block(0x5000, buf_b, 1000, 0, 1);
+    Write_6131LowReg(MAP_1, 0x5400, 1);
+    Write_6131(buf_a, 100, 0, 1);
+    ok = model_matches(0x5000, buf_a, 1000) && !memcmp(buf_a, buf_b, 2000) &&
+         model_matches(0x5400, buf_a, 100) && (sim_6131_map() == 1) && (isr_count > 200);
+    for(i = 0; i < isr_count; i++) if(sim_6131_peek(0x6000 + i) != 0xC000 + i) ok = 0;
+    host_irq_handler = 0;
+    host_irq_after = 0;
+    step_end("Block/Write_6131 preempted", ok);
+
+    step_begin();
+    Read_6131(0x1100, 256);
+    ok = model_matches(0x1100, read_data, 256);
+    step_end("Read_6131 256", ok);
+
+    make_pattern(buf_a, 64, 2);
+    step_begin();
+    Write_6131LowReg(MAP_1, 0x2000, 1);
+    Write_6131(buf_a, 64, 0, 1);
+    ok = model_matches(0x2000, buf_a, 64);
+    Write_6131LowReg(MAP_1, 0x2000, 1);
+    for(i = 0; i < 64; i++) if(Read_6131_1word(1) != buf_a[i]) ok = 0;
+    step_end("Write_6131/Read_6131_1word", ok);
+
+    step_begin();
+    Write_6131LowReg(MAP_1, 0x2100, 1);
+    Write_6131_1word(0x1234, 1);
+    Write_6131_1word(0x5678, 1);
+    ok = (sim_6131_peek(0x2100) == 0x1234) && (sim_6131_peek(0x2101) == 0x5678);
+    step_end("Write_6131_1word", ok);
+
+    // buffer op codes: MAP addresses a Control Word, pointers A, B, broadcast follow
+    sim_6131_poke(0x2201, 0x2300);
+    sim_6131_poke(0x2202, 0x2340);
+    sim_6131_poke(0x2203, 0x2380);
+    make_pattern(buf_a, 32, 3);
+    step_begin();
+    ok = 1;
+    for(i = 0; i < 3; i++) {
+        Write_6131LowReg(MAP_1, 0x2201, 1);
+        Write_6131_Buffer(buf_a, 32, i, 1);
+        if(!model_matches(0x2300 + (i << 6), buf_a, 32)) ok = 0;
+        Write_6131LowReg(MAP_1, 0x2201, 1);
+        Read_6131_Buffer(32, i, 1);
+        if(!model_matches(0x2300 + (i << 6), read_data, 32)) ok = 0;
+    }
+    step_end("Write/Read_6131_Buffer", ok);
+
+    step_begin();
+    for(i = 0; i < 8; i++) sim_6131_poke(0x2400 + (i << 2), 0x8000 + i);
+    Write_6131LowReg(MAP_1, 0x2400, 1);
+    ok = 1;
+    for(i = 0; i < 8; i++) if(ReadWord_Adv4(1) != 0x8000 + i) ok = 0;
+    step_end("ReadWord_Adv4", ok);
+
+    step_begin();
+    sim_6131_poke(RT1_CURR_CTRL_WORD_ADDR_REG, 0x2410);
+    sim_6131_poke(RT2_CURR_CTRL_WORD_ADDR_REG, 0x2414);
+    ok = (Read_Current_Control_Word(1, 1) == 0x8004) && (Read_Current_Control_Word(2, 1) == 0x8005);
+    step_end("Read_Current_Control_Word", ok);
+
+    // interrupt log: IIW/IAW pairs, log address register points past the last pair
+    step_begin();
+    sim_6131_poke(0x0184, 0x0011);
+    sim_6131_poke(0x0185, 0x0422);
+    sim_6131_poke(INT_COUNT_AND_LOG_ADDR_REG, 0x0186);
+    w = Read_Last_Interrupt(1);
+    ok = (w == 0x0422) && (Read_6131_1word(1) == 0x0011);
+    step_end("Read_Last_Interrupt", ok);
+
+    step_begin();
+    Fill_6131RAM(0x3000, 1000, 0xBEEF);
+    ok = 1;
+    for(i = 0; i < 1000; i++) if(sim_6131_peek(0x3000 + i) != 0xBEEF) ok = 0;
+    step_end("Fill_6131RAM 1000", ok);
+
+    // disjoint ranges: a fill longer than one DMA segment, an incrementing
+    // pattern over several chunks, and an empty range. Neighbours untouched
+    step_begin();
+    {
+        FILL_RANGE ranges[3] = {
+            { 0x4000, 5000, 0x5A5A, FILL_VALUE },
+            { 0x6001, 700, 0x1234, FILL_INCREMENT },
+            { 0x7000, 0, 0xFFFF, FILL_VALUE }
+        };
+
+        sim_6131_poke(0x3FFF, 0x1111);
+        sim_6131_poke(0x4000 + 5000, 0x2222);
+        sim_6131_poke(0x6000, 0x3333);
+        sim_6131_poke(0x6001 + 700, 0x4444);
+        sim_6131_poke(0x7000, 0x5555);
+        ok = (Fill_6131_Ranges(ranges, 3, 1) == 'P');
+        for(i = 0; i < 5000; i++) if(sim_6131_peek(0x4000 + i) != 0x5A5A) ok = 0;
+        for(i = 0; i < 700; i++) if(sim_6131_peek(0x6001 + i) != (unsigned short)(0x1234 + i)) ok = 0;
+        ok = ok && (sim_6131_peek(0x3FFF) == 0x1111) && (sim_6131_peek(0x4000 + 5000) == 0x2222)
+                && (sim_6131_peek(0x6000) == 0x3333) && (sim_6131_peek(0x6001 + 700) == 0x4444)
+                && (sim_6131_peek(0x7000) == 0x5555);
+        // a range past the end of RAM is refused before anything is written
+        ranges[0].value = 0x0000;
+        ranges[2].address = 0x7FF0;
+        ranges[2].count = 0x20;
+        ok = ok && (Fill_6131_Ranges(ranges, 3, 1) == 'F') && (sim_6131_peek(0x4000) == 0x5A5A);
+        // irq_mgmt = 0 leaves interrupts to the caller: none are re-enabled
+        ranges[2].count = 0;
+        host_irq_after = 1000000;
+        ok = ok && (Fill_6131_Ranges(ranges, 3, 0) == 'P') && (host_irq_after == 1000000)
+                && (sim_6131_peek(0x4000) == 0x0000);
+        host_irq_after = 0;
+    }
+    step_end("Fill_6131_Ranges", ok);
+
+    // descriptor table: MAP does not auto-increment onto a Control Word
+    make_pattern(buf_a, 512, 4);
+    Write_6131LowReg(RT1_DESC_TBL_BASE_ADDR_REG, 0x0400, 1);
+    step_begin();
+    Write_6131_Block(0x0400, buf_a, 512, 1, 1);
+    ok = model_matches(0x0400, buf_a, 512);
+    Read_6131_Block(0x0400, buf_b, 512, 1, 1);
+    ok = ok && model_matches(0x0400, buf_b, 512);
+    step_end("Block d-table 512", ok);
+
+    step_begin();
+    make_pattern(buf_a, 512, 5);
+    Write_6131_Burst(0x0400, buf_a, 512, 1, 1);
+    ok = model_matches(0x0400, buf_a, 512);
+    Read_6131_Burst(0x0400, buf_b, 512, 1, 1);
+    ok = ok && model_matches(0x0400, buf_b, 512) && (sim_6131_map() == 1);
+    step_end("Burst d-table 512", ok);
+    // back to the reset value, as the init routines expect
+    Write_6131LowReg(RT1_DESC_TBL_BASE_ADDR_REG, RT1_DESCRIP_TABLE_BASE_ADDR, 1);
+
+    make_pattern(buf_a, 4096, 6);
+    step_begin();
+    Write_6131_Burst(0x4000, buf_a, 4096, 0, 1);
+    ok = model_matches(0x4000, buf_a, 4096);
+    Read_6131_Burst(0x4000, buf_b, 4096, 0, 1);
+    ok = ok && model_matches(0x4000, buf_b, 4096) && (sim_6131_map() == 1);
+    step_end("Write/Read_6131_Burst 4096", ok);
+
+    // irq_mgmt = 0: the caller's interrupts stay disabled throughout
+    isr_count = 0;
+    host_irq_handler = test_isr;
+    host_irq_after = 1;
+    step_begin();
+    ok = (Write_6131_Burst(0x4000, buf_a, 64, 0, 0) == 'P') && (Read_6131_Burst(0x4000, buf_b, 64, 0, 0) == 'P');
+    ok = ok && (isr_count == 0) && model_matches(0x4000, buf_b, 64);
+    host_irq_handler = 0;
+    host_irq_after = 0;
+    step_end("Burst irq_mgmt 0", ok);
+
+    // non-blocking start: returns before completion. A foreground access then
+    // waits for the burst and finds the caller's MAP re-enabled
+    {
+        SPI_BURST burst;
+
+        burst.address = 0x4000;
+        burst.buffer = buf_b;
+        burst.count = 512;
+        burst.direction = BURST_READ;
+        burst.dtable = 0;
+        burst.callback = burst_cb;
+        burst_cb_count = 0;
+        memset(buf_b, 0, 1024);
+        step_begin();
+        ok = (Start_6131_Burst(&burst, 1) == 'P') && !burst.done && !burst_cb_count;
+        ok = ok && (Read_6131_Reg(0x4010, 1) == buf_a[16]) && burst.done && (burst_cb_count == 512)
+                && (sim_6131_map() == 1) && (Wait_6131_Burst(&burst, 1) == 'P')
+                && (memcmp(buf_a, buf_b, 1024) == 0);
+        step_end("Start_6131_Burst", ok);
+    }
+}
+
+
+//------------------------------------------------------------------------------
+//         SPI Transaction Trace Checks
+//------------------------------------------------------------------------------
+
+static void check_trace(void) {
+
+    static SPI_TRACE_REC rec[SPI_TRACE_SIZE];
+#if (SPI_TRACE == YES)
+    unsigned short n, i, words = 0, next = 0x5000;
+    int ok, resumed = 0, isr = 0, dma = 0;
+
+    // preempted block read: resumed op codes continue at the right address
+    isr_count = 0;
+    host_irq_handler = test_isr;
+    host_irq_after = 7;
+    step_begin();
+    Start_6131_Trace();
+    Read_6131_Block(0x5000, buf_b, 20, 0, 1);
+    host_irq_handler = 0;
+    host_irq_after = 0;
+    Read_6131_Burst(0x4000, buf_b, 16, 0, 1);
+    Stop_6131_Trace();
+    n = Get_6131_Trace(rec, SPI_TRACE_SIZE);
+
+    ok = (n > 0) && (n < SPI_TRACE_SIZE);
+    for(i = 0; i < n; i++) {
+        if(rec[i].end < rec[i].start) ok = 0;
+        if(rec[i].flags & SPI_TRACE_ISR) isr++;
+        if((rec[i].flags & SPI_TRACE_DMA) && (rec[i].address == 0x4000) && (rec[i].words == 16)) dma++;
+        if((rec[i].opcode != 0x40) || (rec[i].map != MAP_BULK) || (rec[i].flags & SPI_TRACE_DMA)) continue;
+        if(rec[i].address != next) ok = 0;
+        if(rec[i].flags & SPI_TRACE_RESUMED) resumed++;
+        next = rec[i].address + rec[i].words;
+        words += rec[i].words;
+    }
+    ok = ok && (words == 20) && resumed && (resumed <= isr_count) && isr && (dma == 1);
+    // stopped: nothing more is recorded
+    Read_6131LowReg(MASTER_CONFIG_REG, 1);
+    ok = ok && (Get_6131_Trace(rec, SPI_TRACE_SIZE) == n);
+    step_end("SPI trace", ok);
+#else
+    // trace compiled out: nothing is ever recorded
+    step_begin();
+    Start_6131_Trace();
+    Read_6131_Block(0x5000, buf_b, 20, 0, 1);
+    Stop_6131_Trace();
+    step_end("SPI trace off", Get_6131_Trace(rec, SPI_TRACE_SIZE) == 0);
+#endif
+}
+
+
+//------------------------------------------------------------------------------
+//         SPI Transaction Batch Checks
+//------------------------------------------------------------------------------
+
+static void check_batch(void) {
+
+    static SPI_BATCH_OP ops[8];
+    SPI_BATCH batch;
+    SIM_6131_STATS s, s1, s2;
+    unsigned short i, reg = 0;
+    int ok;
+
+    for(i = 0; i < 64; i++) buf_a[i] = 0x7100 + i;
+    step_begin();
+    enaMAP(2);
+    Init_6131_Batch(&batch, ops, 8);
+    ok = (Batch_6131_WriteReg(&batch, MAP_REG(MAP_CONSOLE), 0x1234) == 'P') &&
+         (Batch_6131_ReadReg(&batch, MAP_REG(MAP_CONSOLE), &reg) == 'P') &&
+         (Batch_6131_Write(&batch, 0x5100, buf_a, 8) == 'P') &&
+         (Batch_6131_Write(&batch, 0x5108, buf_a + 8, 56) == 'P') &&
+         (Batch_6131_Read(&batch, 0x5100, buf_b, 64) == 'P') &&
+         (Batch_6131_Opcode(&batch, 0x40) == 'F');
+    // one MAP load for the contiguous writes, one for the read
+    ok = ok && (batch.count == 7);
+    // DMA for the 56-word write and 64-word read, then all by CPU
+    for(i = 0; i < 2; i++) {
+        memset(buf_b, 0, 128);
+        sim_6131_poke(0x5100, 0);
+        ok = ok && (Run_6131_Batch(&batch, !i) == 'P') && (reg == 0x1234) &&
+             model_matches(0x5100, buf_a, 64) && (memcmp(buf_a, buf_b, 128) == 0) &&
+             (sim_6131_map() == 2);
+    }
+    // a DMA read in a batch sends no MAP load of its own. A CPU read continuing
+    // from it re-enables MAP3: the burst's op codes, then MAP3 enable, the read
+    // and the MAP restore
+    Init_6131_Batch(&batch, ops, 8);
+    ok = ok && (Batch_6131_Read(&batch, 0x5100, buf_b, 60) == 'P') &&
+         (Batch_6131_Read(&batch, 0x513C, buf_b + 60, 4) == 'P') && (batch.count == 3);
+    sim_6131_get_stats(&s1);
+    ok = ok && (Read_6131_Burst(0x5100, buf_b, 60, 0, 1) == 'P');
+    sim_6131_get_stats(&s2);
+    memset(buf_b, 0, 128);
+    ok = ok && (Run_6131_Batch(&batch, 1) == 'P');
+    sim_6131_get_stats(&s);
+    ok = ok && (memcmp(buf_a, buf_b, 128) == 0) && (sim_6131_map() == 2) &&
+         (s.selects - s2.selects == s2.selects - s1.selects + 3);
+    // overflow: the batch is refused
+    Init_6131_Batch(&batch, ops, 1);
+    ok = ok && (Batch_6131_WriteReg(&batch, MAP_REG(MAP_CONSOLE), 0) == 'P') &&
+         (Batch_6131_WriteReg(&batch, MAP_REG(MAP_CONSOLE), 0) == 'F') &&
+         (Run_6131_Batch(&batch, 1) == 'F');
+    enaMAP(1);
+    step_end("Run_6131_Batch", ok);
+}
+
+
+//------------------------------------------------------------------------------
+//         SPI Timing Calibration Checks
+//------------------------------------------------------------------------------
+
+// calibrate with the model limited to SCBR >= min_scbr and DLYBCT >= min_dlybct,
+// non-zero if the expected setting was locked in and, for 'P', the RAM range
+// restored. For 'F' the RAM range was saved at failing settings.
+static int tune_case(unsigned char min_scbr, unsigned char min_dlybct, unsigned char result,
+                     unsigned char scbr, unsigned char dlybs, unsigned char dlybct) {
+
+    unsigned short i;
+    unsigned char s, b, c;
+    int ok;
+
+    for(i = 0; i < TUNE_RAM_WORDS; i++) {
+        buf_a[i] = 0xD000 + i;
+        sim_6131_poke(TUNE_RAM_ADDR + i, buf_a[i]);
+    }
+    sim_6131_set_limits(min_scbr, min_dlybct);
+    ok = (Tune_6131_SPI_Timing() == result);
+    sim_6131_set_limits(0, 0);
+    Get_6131_SPI_Timing(&s, &b, &c);
+    return ok && (s == scbr) && (b == dlybs) && (c == dlybct) &&
+           ((result == 'F') || model_matches(TUNE_RAM_ADDR, buf_a, TUNE_RAM_WORDS));
+}
+
+
+static void check_tune(void) {
+
+    int ok;
+
+    step_begin();
+    // good board: fastest setting passes, one step slower is kept
+    ok = tune_case(0, 0, 'P', 3, 6, 0);
+    // marginal board: default 16MHz with DLYBCT = 1 is fastest passing
+    Set_6131_SPI_Timing(3, 12, 1);
+    ok = ok && tune_case(3, 1, 'P', 4, 12, 1);
+    // nothing passes: settings in effect are kept
+    Set_6131_SPI_Timing(3, 12, 1);
+    ok = ok && tune_case(13, 0, 'F', 3, 12, 1);
+    Set_6131_SPI_Timing(3, 12, 1);
+    step_end("Tune_6131_SPI_Timing", ok);
+}
+
+
+//------------------------------------------------------------------------------
+//         Interrupt Service Checks
+//------------------------------------------------------------------------------
+
+static void check_irq(void) {
+
+    int ok, i;
+    INT_6131_REGS regs;
+
+    // interrupt register snapshot: two MAP bursts that skip register 0x0A, so
+    // its interrupt count is kept. The enables alone clear no pending bits
+    for(i = 0; i < 4; i++) {
+        sim_6131_poke(HDW_INT_ENABLE_REG + i, 0x0100 + i);
+        sim_6131_poke(HDW_INT_OUTPUT_ENABLE_REG + i, 0x0200 + i);
+    }
+    sim_6131_poke(BC_PENDING_INT_REG, BCEOM);
+    sim_6131_poke(INT_COUNT_AND_LOG_ADDR_REG, 0x0586);
+    step_begin();
+    memset(&regs, 0, sizeof(regs));
+    ok = (Read_6131_IntRegs(&regs, INT_REGS_CONFIG, 1) == 'P') && !regs.pending[INT_BC]
+         && (sim_6131_peek(BC_PENDING_INT_REG) == BCEOM) && (regs.output[INT_RT] == 0x0203);
+    ok = ok && (Read_6131_IntRegs(&regs, INT_REGS_ALL, 1) == 'P');
+    for(i = 0; i < 4; i++)
+        if((regs.enable[i] != 0x0100 + i) || (regs.output[i] != 0x0200 + i)) ok = 0;
+    ok = ok && (regs.pending[INT_BC] == BCEOM) && (regs.pending[INT_HDW] == (BCIP))
+         && !regs.pending[INT_MT] && !regs.pending[INT_RT] && (regs.count_log == 0)
+         && !sim_6131_peek(BC_PENDING_INT_REG)
+         && (sim_6131_peek(INT_COUNT_AND_LOG_ADDR_REG) == 0x0586);
+    step_end("Read_6131_IntRegs", ok);
+    sim_6131_poke(INT_COUNT_AND_LOG_ADDR_REG, 0x0186);
+    for(i = 0; i < 8; i++) sim_6131_poke(HDW_INT_ENABLE_REG + i, 0);
+
+    Configure_6131_IRQ();
+    Set_6131_IRQ_Callback(IRQ_HW, cb_hw);
+    Set_6131_IRQ_Callback(IRQ_BC, cb_bc);
+    Set_6131_IRQ_Callback(IRQ_RT1, cb_rt1);
+    Set_6131_IRQ_Callback(IRQ_RT2, cb_rt2);
+    Set_6131_IRQ_Callback(IRQ_MT, cb_mt);
+    sim_6131_poke(0x6100, 0x1234);
+
+    // BC and MT pending, summary bits are not passed to the hardware callback
+    memset(irq_seen, 0, sizeof(irq_seen));
+    sim_6131_poke(HDW_PENDING_INT_REG, LBFA);
+    sim_6131_poke(BC_PENDING_INT_REG, BCEOM);
+    sim_6131_poke(MT_PENDING_INT_REG, 0x0010);
+    step_begin();
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    ok = (irq_seen[IRQ_HW] == LBFA) && (irq_seen[IRQ_BC] == BCEOM) && (irq_seen[IRQ_MT] == 0x0010)
+         && !irq_seen[IRQ_RT1] && !irq_seen[IRQ_RT2] && (sim_6131_map() == 1)
+         && !sim_6131_peek(BC_PENDING_INT_REG) && !sim_6131_peek(MT_PENDING_INT_REG);
+    step_end("Service_6131_IRQ BC+MT", ok);
+
+    // RT pending register splits into RT1 and RT2
+    memset(irq_seen, 0, sizeof(irq_seen));
+    sim_6131_poke(RT_PENDING_INT_REG, RT2_IWA | RT1_IXEQZ);
+    step_begin();
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    ok = (irq_seen[IRQ_RT1] == (RT1_IXEQZ)) && (irq_seen[IRQ_RT2] == (RT2_IWA)) && !irq_seen[IRQ_HW];
+    ok = ok && (Get_6131_IRQ_History(RT_PENDING_INT_REG) == (RT2_IWA | RT1_IXEQZ))
+         && (Get_6131_IRQ_History(RT_PENDING_INT_REG) == 0);
+    step_end("Service_6131_IRQ RT1+RT2", ok);
+
+    // nothing pending: one pending register burst, no callbacks
+    step_begin();
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    step_end("Service_6131_IRQ idle", 1);
+
+    // interrupt log: three messages in one service, handlers called in order
+    Set_6131_ILog_Handler(IRQ_BC, ilog_bc);
+    Set_6131_ILog_Handler(IRQ_RT1, ilog_rt1);
+    Set_6131_ILog_Handler(IRQ_RT2, ilog_rt2);
+    Set_6131_ILog_Handler(IRQ_MT, ilog_mt);
+    ilog_seen_count = 0;
+    ilog_generate(3, 0x100);
+    step_begin();
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    step_end("interrupt log 3", ilog_matches(3, 0x100) && (sim_6131_map() == 1));
+
+    // wraps around the end of the log ring: two bursts
+    ilog_seen_count = 0;
+    ilog_generate(30, 0x200);
+    step_begin();
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    step_end("interrupt log 30, ring wrap", ilog_matches(30, 0x200));
+
+    // 40 logged, the oldest 8 overwritten before the service
+    ilog_seen_count = 0;
+    ilog_generate(40, 0x300);
+    step_begin();
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    step_end("interrupt log overrun", ilog_matches(32, 0x308) && (Get_6131_ILog_Lost() == 8));
+
+    // top half without bottom half: events queue until Poll_6131_IRQ( )
+    memset(irq_seen, 0, sizeof(irq_seen));
+    ilog_seen_count = 0;
+    ilog_generate(10, 0x500);
+    sim_6131_poke(BC_PENDING_INT_REG, BCEOM);
+    step_begin();
+    Service_6131_IRQ();
+    ok = (ilog_seen_count == 0) && !irq_seen[IRQ_BC];
+    Poll_6131_IRQ();
+    ok = ok && ilog_matches(10, 0x500) && (irq_seen[IRQ_BC] == BCEOM);
+    step_end("event queue, deferred handlers", ok);
+
+    // queue full: pending bits go to the backlog, later log entries are lost
+    memset(irq_seen, 0, sizeof(irq_seen));
+    ilog_seen_count = 0;
+    ilog_generate(30, 0x600);
+    Service_6131_IRQ();
+    ilog_generate(30, 0x600 + 30);
+    Service_6131_IRQ();
+    ilog_generate(30, 0x600 + 60);
+    Service_6131_IRQ();
+    sim_6131_poke(MT_PENDING_INT_REG, 0x0010);
+    step_begin();
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    ok = ilog_matches(IRQ_EVENT_RING - 1, 0x600) && (irq_seen[IRQ_MT] == 0x0010)
+         && (Get_6131_ILog_Lost() == 90 - (IRQ_EVENT_RING - 1));
+    step_end("event queue full", ok);
+
+    // polled drain, nothing left afterwards
+    ilog_seen_count = 0;
+    ilog_generate(2, 0x400);
+    step_begin();
+    ok = (Drain_6131_ILog() == 2) && ilog_matches(2, 0x400) && (Drain_6131_ILog() == 0);
+    step_end("Drain_6131_ILog", ok && (sim_6131_map() == 1));
+
+    // coalescing: per-message output enables removed, tick services the log
+    sim_6131_poke(MT_INT_OUTPUT_ENABLE_REG, (MT_EOM) | (STKADRSS));
+    sim_6131_poke(RT_INT_OUTPUT_ENABLE_REG, (RT1_IWA) | (RT1_IXEQZ) | (RT2_IWA));
+    ilog_seen_count = 0;
+    step_begin();
+    Configure_6131_Coalescing(IRQ_COALESCE_ON, IRQ_COALESCE_TICK_US);
+    ok = (sim_6131_peek(MT_INT_OUTPUT_ENABLE_REG) == (STKADRSS))
+         && (sim_6131_peek(RT_INT_OUTPUT_ENABLE_REG) == (RT1_IXEQZ))
+         && (host_tc1.TC_RC == IRQ_COALESCE_TICK_US * (BOARD_MCK / 32000) / 1000)
+         && (Get_6131_Coalescing() == IRQ_COALESCE_ON);
+    ilog_generate(20, 0x700);
+    TC1_IrqHandler();
+    Poll_6131_IRQ();
+    ok = ok && ilog_matches(20, 0x700) && (sim_6131_map() == 1);
+    step_end("coalescing, batch tick", ok);
+
+    // AUTO: busy tick enters batch servicing, idle tick leaves it
+    ilog_seen_count = 0;
+    step_begin();
+    Configure_6131_Coalescing(IRQ_COALESCE_AUTO, IRQ_COALESCE_TICK_US);
+    ok = (sim_6131_peek(MT_INT_OUTPUT_ENABLE_REG) == ((MT_EOM) | (STKADRSS)))
+         && (Get_6131_Coalescing() == IRQ_COALESCE_OFF);
+    ilog_generate(IRQ_COALESCE_HIGH, 0x800);
+    Service_6131_IRQ();
+    TC1_IrqHandler();
+    ok = ok && (Get_6131_Coalescing() == IRQ_COALESCE_ON)
+         && (sim_6131_peek(RT_INT_OUTPUT_ENABLE_REG) == (RT1_IXEQZ));
+    ilog_generate(2, 0x800 + IRQ_COALESCE_HIGH);
+    TC1_IrqHandler();
+    ok = ok && (Get_6131_Coalescing() == IRQ_COALESCE_ON);
+    TC1_IrqHandler();
+    ok = ok && (Get_6131_Coalescing() == IRQ_COALESCE_OFF)
+         && (sim_6131_peek(RT_INT_OUTPUT_ENABLE_REG) == ((RT1_IWA) | (RT1_IXEQZ) | (RT2_IWA)));
+    Poll_6131_IRQ();
+    ok = ok && ilog_matches(IRQ_COALESCE_HIGH + 2, 0x800);
+    step_end("coalescing, adaptive", ok);
+
+    Configure_6131_Coalescing(IRQ_COALESCE_OFF, 0);
+    sim_6131_poke(MT_INT_OUTPUT_ENABLE_REG, 0);
+    sim_6131_poke(RT_INT_OUTPUT_ENABLE_REG, 0);
+
+    for(ok = 0; ok < IRQ_SOURCES; ok++) Set_6131_ILog_Handler(ok, 0);
+    for(ok = 0; ok < IRQ_SOURCES; ok++) Set_6131_IRQ_Callback(ok, 0);
+    Get_6131_IRQ_History(HDW_PENDING_INT_REG);
+    Get_6131_IRQ_History(BC_PENDING_INT_REG);
+    Get_6131_IRQ_History(MT_PENDING_INT_REG);
+}
+
+
+//------------------------------------------------------------------------------
+//         Initialization Routines
+//------------------------------------------------------------------------------
+
+// Read-back check of the RAM tables recorded by the init routines: all pass,
+// then one corrupted word is found in its 16-word block, descriptor table
+// and plain table alike. With RAM_VERIFY = NO nothing is recorded and the
+// read-back always passes
+static void check_verify(void) {
+
+    unsigned short bad;
+#if (RAM_VERIFY == YES)
+    unsigned short a, w;
+#endif
+    unsigned char ok;
+
+    step_begin();
+    bad = 0x1234;
+    ok = (Verify_6131_Images(&bad) == 'P') && (bad == 0x1234);
+    step_end("Verify_6131_Images", ok);
+
+#if (RAM_VERIFY == YES)
+#if (RT1_ena)
+    // a descriptor table word
+    a = sim_6131_peek(RT1_DESC_TBL_BASE_ADDR_REG) + 0x0025;
+    w = sim_6131_peek(a);
+    sim_6131_poke(a, w ^ 0x0100);
+    step_begin();
+    ok = (Verify_6131_Images(&bad) == 'F') && (bad == (a & ~(VERIFY_BLOCK - 1)));
+    sim_6131_poke(a, w);
+    ok = ok && (Verify_6131_Images(&bad) == 'P');
+    step_end("Verify_6131_Images d-table", ok);
+#endif
+
+#if (SMT_ena || IMT_ena)
+    // last word of the MT filter table
+    a = 0x0100 + 127;
+    w = sim_6131_peek(a);
+    sim_6131_poke(a, w ^ 0x8000);
+    step_begin();
+    ok = (Verify_6131_Images(&bad) == 'F') && (bad == 0x0100 + 112);
+    sim_6131_poke(a, w);
+    step_end("Verify_6131_Images MT table", ok);
+#endif
+#endif  // RAM_VERIFY
+
+    // CRC-16-CCITT of the bytes "12345678", high byte of each word first
+    {
+        static const unsigned short check[] = { 0x3132, 0x3334, 0x3536, 0x3738 };
+
+        step_begin();
+        step_end("Crc_6131", Crc_6131(CRC_6131_INIT, check, 4) == 0xA12B);
+    }
+}
+
+
+// Rate group schedule: bus time per minor frame, auto phases in the least
+// loaded frames, frame timer instruction list and message blocks in RAM
+static void check_schedule(void) {
+
+    static const BC_SCHED_MSG msgs[5] = {
+        { RTRYENA|MEMASK|USEBUSA,  3<<11 | TX | 30<<5 | 0, 0, 0x5308, 1, 0 },
+        { MEMASK|MSKBCR|USEBUSA,   3<<11 | RX | 30<<5 | 0, 0, 0x5328, 1, 0 },
+        { RTRYENA|MEMASK|USEBUSB,  3<<11 | TX | 30<<5 | 0, 0, 0x5308, 2, BC_SCHED_AUTO },
+        { MEMASK|MCODE|USEBUSB,    3<<11 | TX | 31<<5 | 2, 0, 0x0000, 4, BC_SCHED_AUTO },
+        { MEMASK|RT_RT|USEBUSA,    4<<11 | RX | 30<<5 | 2, 3<<11 | TX | 1<<5 | 2, 0x5388, 4, BC_SCHED_AUTO }};
+    static const unsigned short frame_us[4] = { 2106, 1466, 2106, 1558 };
+    BC_SCHED sched;
+    unsigned short i, w, ones, a;
+    unsigned char ok;
+
+    sched.msgs = msgs;
+    sched.num_msgs = 5;
+    sched.minor_frames = 4;
+    sched.minor_us = 20000;
+    sched.ilist_addr = BC_SCHED_ILIST_ADDR;
+    sched.msg_addr = BC_SCHED_MSG_ADDR;
+
+    step_begin();
+    ok = (Build_BC_Schedule(&sched) == 'P');
+    for(i = 0; i < 4; i++) if(sched.frame_us[i] != frame_us[i]) ok = 0;
+    ok = ok && (sched.peak_us == 2106) && (sched.phase[2] == 0) && (sched.phase[3] == 1)
+            && (sched.phase[4] == 3) && (sched.msg_words == 48) && (sched.ilist_words == 44);
+    // LFT 20ms, op code words with odd parity, loop to the first SFT
+    a = BC_SCHED_ILIST_ADDR;
+    ok = ok && (sim_6131_peek(BC_INST_LIST_BASE_ADDR_REG) == a) && (sim_6131_peek(a + 1) == 200)
+            && (sim_6131_peek(a + 2) == BC_OPWORD(SFT, ALWAYS)) && (sim_6131_peek(a + 43) == a + 2);
+    for(i = 0; i < 44; i += 2) {
+        w = sim_6131_peek(a + i);
+        for(ones = 0; w; w >>= 1) ones += w & 1;
+        if(!(ones & 1)) ok = 0;
+    }
+    // minor frame 1: SFT at 12, messages 0, 1 and the mode code, WFT
+    ok = ok && (sim_6131_peek(a + 12) == BC_OPWORD(SFT, ALWAYS)) && (sim_6131_peek(a + 15) == BC_SCHED_MSG_ADDR)
+            && (sim_6131_peek(a + 17) == BC_SCHED_MSG_ADDR + 8) && (sim_6131_peek(a + 19) == BC_SCHED_MSG_ADDR + 24)
+            && (sim_6131_peek(a + 20) == BC_OPWORD(WFT, ALWAYS));
+    // blocks: Time to Next Message, RT-RT block on 16-word boundary
+    a = BC_SCHED_MSG_ADDR;
+    ok = ok && (sim_6131_peek(a + 3) == 702) && (sim_6131_peek(a + 27) == 62)
+            && (sim_6131_peek(a + 32) == msgs[4].control) && (sim_6131_peek(a + 35) == 154)
+            && (sim_6131_peek(a + 40) == msgs[4].tx_command);
+    step_end("Build_BC_Schedule", ok);
+
+    // 2ms minor frames are overbooked, a period of 3 does not divide 4 frames
+    step_begin();
+    sim_6131_poke(BC_SCHED_MSG_ADDR + 3, 0);
+    sched.minor_us = 2000;
+    ok = (Build_BC_Schedule(&sched) == 'F') && (sched.peak_us == 2106) && (sim_6131_peek(BC_SCHED_MSG_ADDR + 3) == 0);
+    sched.minor_us = 20000;
+    sched.msgs = &msgs[2];
+    sched.num_msgs = 1;
+    sched.minor_frames = 3;
+    ok = ok && (Build_BC_Schedule(&sched) == 'F');
+    step_end("Build_BC_Schedule bad", ok);
+
+    step_begin();
+    step_end("initialize_bc_schedule", initialize_bc_schedule() == 'P');
+}
+
+
+// Double-buffered BC data: burst to the inactive buffer, then flip Data Addr,
+// held off while the BC is in process on the message
+static void check_dbuf(void) {
+
+    BC_DBUF dbuf;
+    unsigned short data[4] = { 0x1111, 0x2222, 0x3333, 0x4444 };
+    unsigned short msg = BC_SCHED_MSG_ADDR + 8;     // schedule's receive message, data at 0x5328
+    unsigned short status = sim_6131_peek(STATUS_AND_RESET_REG);
+    unsigned char ok;
+
+    step_begin();
+    sim_6131_poke(0x5328, 0xAAAA);
+    ok = (Init_BC_Data_Buffer(&dbuf, msg, 0x5340, 4) == 'P') && (dbuf.buffer[0] == 0x5328)
+            && (sim_6131_peek(0x5340) == 0xAAAA);
+    ok = ok && (Update_BC_Data_Buffer(&dbuf, data) == 'P') && (dbuf.active == 1)
+            && (sim_6131_peek(msg + 2) == 0x5340) && (sim_6131_peek(0x5343) == 0x4444)
+            && (sim_6131_peek(0x5328) == 0xAAAA);
+    // another message in process does not hold off the update
+    sim_6131_poke(STATUS_AND_RESET_REG, status | BCMIP);
+    sim_6131_poke(BC_LAST_MSG_BLOCK_ADDR_REG, BC_SCHED_MSG_ADDR);
+    data[0] = 0x5555;
+    ok = ok && (Update_BC_Data_Buffer(&dbuf, data) == 'P') && (sim_6131_peek(msg + 2) == 0x5328)
+            && (sim_6131_peek(0x5328) == 0x5555);
+    // this message in process does, and nothing is written
+    sim_6131_poke(BC_LAST_MSG_BLOCK_ADDR_REG, msg);
+    data[0] = 0x6666;
+    ok = ok && (Update_BC_Data_Buffer(&dbuf, data) == 'F') && (dbuf.active == 0)
+            && (sim_6131_peek(msg + 2) == 0x5328) && (sim_6131_peek(0x5340) == 0x1111);
+    sim_6131_poke(STATUS_AND_RESET_REG, status);
+    ok = ok && (Init_BC_Data_Buffer(&dbuf, msg, 0x532A, 4) == 'F');
+    step_end("BC data double buffer", ok);
+}
+
+
+// BC result harvest: end of message log entries mark blocks, the frame end
+// IRQ op code reads them into MCU RAM
+static void check_harvest(void) {
+
+    unsigned short blocks[2] = { BC_SCHED_MSG_ADDR, BC_SCHED_MSG_ADDR + 8 };
+    const BC_RESULT *tx, *rx;
+    unsigned short i;
+    unsigned char ok;
+
+    // schedule's loopback transmit message, 32 words to 0x5308, and receive message
+    for(i = 0; i < 32; i++) sim_6131_poke(0x5308 + i, 0x7000 + i);
+    sim_6131_poke(blocks[0] + 4, 0x1234);
+    sim_6131_poke(blocks[0] + 5, 0x8000);
+    sim_6131_poke(blocks[0] + 7, 3 << 11);
+
+    step_begin();
+    ok = (Start_BC_Harvest(blocks, 2, 1 << 5) == 'P') && (Start_BC_Harvest(blocks, 2, 1) == 'F');
+    ok = ok && (Start_BC_Harvest(blocks, 2, 1 << 5) == 'P');
+    tx = Get_BC_Result(blocks[0]);
+    rx = Get_BC_Result(blocks[1]);
+    sim_6131_log_interrupt((BCIP) | (BCEOM), blocks[0]);
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    ok = ok && tx && rx && (tx->count == 0);
+    // frame end: only the logged message is read
+    sim_6131_log_interrupt((BCIP) | (1 << 5), BC_SCHED_ILIST_ADDR);
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    ok = ok && (tx->count == 1) && (rx->count == 0) && (tx->time_tag == 0x1234) && (tx->block_status == 0x8000)
+            && (tx->rt_status == (3 << 11)) && (tx->words == 32) && (tx->data[0] == 0x7000) && (tx->data[31] == 0x701F);
+    ok = ok && (Harvest_BC_Results(1) == 2) && (rx->count == 1) && (rx->words == 0);
+    Stop_BC_Harvest();
+    ok = ok && (Get_BC_Result(blocks[1]) == rx) && (Get_BC_Result(0x1234) == 0);
+    step_end("BC result harvest", ok);
+}
+
+
+// BC General Purpose Queue: words pushed across the queue wrap are read in
+// two bursts and decoded by the push pattern into time-tagged records. A
+// rollover drains a full queue; more than 64 words are counted as lost
+static void check_gpq(void) {
+
+    static const unsigned short pattern[3] = { PTT, PBS, PSI };
+    static const unsigned short pushed[7] = { 0x0100, 0x8000, 0x0001, 0x0200, 0xA000, 0x0002, 0x0300 };
+    BC_GPQ_RECORD rec;
+    unsigned short i;
+    unsigned char ok;
+
+    step_begin();
+    sim_6131_poke(BC_GP_QUEUE_POINTER, 0x00FC);
+    ok = (Start_BC_GPQ(pattern, 3) == 'P') && (Drain_BC_GPQ() == 0);
+    // 0x00FC-0x00FF then 0x00C0-0x00C2
+    for(i = 0; i < 7; i++) sim_6131_poke(0x00C0 + ((0x3C + i) & 0x3F), pushed[i]);
+    sim_6131_poke(BC_GP_QUEUE_POINTER, 0x00C3);
+    ok = ok && (Drain_BC_GPQ() == 7);
+    ok = ok && (Read_BC_GPQ_Record(&rec) == 'P') && (rec.op == PBS) && (rec.data == 0x8000) && (rec.time_tag == 0x0100);
+    ok = ok && (Read_BC_GPQ_Record(&rec) == 'P') && (rec.op == PSI) && (rec.data == 0x0001) && (rec.time_tag == 0x0100);
+    ok = ok && (Read_BC_GPQ_Record(&rec) == 'P') && (rec.op == PBS) && (rec.data == 0xA000) && (rec.time_tag == 0x0200);
+    ok = ok && (Read_BC_GPQ_Record(&rec) == 'P') && (rec.op == PSI) && (rec.data == 0x0002);
+    // the last PTT starts the next pattern
+    ok = ok && (Read_BC_GPQ_Record(&rec) == 'F') && (Get_BC_GPQ_Lost() == 0);
+    sim_6131_poke(0x00C3, 0xC000);
+    sim_6131_poke(BC_GP_QUEUE_POINTER, 0x00C4);
+    ok = ok && (Drain_BC_GPQ() == 1) && (Read_BC_GPQ_Record(&rec) == 'P') && (rec.time_tag == 0x0300);
+    // rollover entry of the wrap drained above
+    sim_6131_log_interrupt((BCIP) | (BCGPQ), 0);
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    // exactly 64 words, the pointer back where it was: the rollover drains all
+    // of them. Next in the pattern is PSI
+    for(i = 0; i < 64; i++) sim_6131_poke(0x00C0 + ((4 + i) & 0x3F), 0x5000 + i);
+    sim_6131_log_interrupt((BCIP) | (BCGPQ), 0);
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    ok = ok && (Read_BC_GPQ_Record(&rec) == 'P') && (rec.op == PSI) && (rec.data == 0x5000);
+    ok = ok && (Read_BC_GPQ_Record(&rec) == 'P') && (rec.op == PBS) && (rec.data == 0x5002) && (rec.time_tag == 0x5001);
+    for(i = 2; Read_BC_GPQ_Record(&rec) == 'P'; i++);
+    ok = ok && (i == 43) && (rec.data == 0x503F) && (Get_BC_GPQ_Lost() == 0);
+    // 70 words before the rollover is handled: the 6 oldest are lost and
+    // skipped in the pattern, decoding resumes in step at the PTT word 0x6006
+    for(i = 0; i < 70; i++) sim_6131_poke(0x00C0 + ((4 + i) & 0x3F), 0x6000 + i);
+    sim_6131_poke(BC_GP_QUEUE_POINTER, 0x00CA);
+    sim_6131_log_interrupt((BCIP) | (BCGPQ), 0);
+    Service_6131_IRQ();
+    Poll_6131_IRQ();
+    ok = ok && (Get_BC_GPQ_Lost() == 6);
+    ok = ok && (Read_BC_GPQ_Record(&rec) == 'P') && (rec.op == PBS) && (rec.data == 0x6007) && (rec.time_tag == 0x6006);
+    ok = ok && (Drain_BC_GPQ() == 0) && (Start_BC_GPQ(pattern, 0) == 'F');
+    sim_6131_poke(BC_GP_QUEUE_POINTER, 0x00C0);
+    step_end("BC GP queue consumer", ok);
+}
+
+
+static void run_init_routines(void) {
+
+    step_begin();
+    Fill_6131RAM_Offset();
+    step_end("Fill_6131RAM_Offset", sim_6131_peek(0x7FFF) == 0x7FFF);
+
+    // RAM tables written from here on are recorded for Verify_6131_Images( )
+    Reset_6131_Verify();
+
+    step_begin();
+    initialize_613x_shared();
+    step_end("initialize_613x_shared", 1);
+
+#if (BC_ena)
+    step_begin();
+    initialize_613x_BC();
+    step_end("initialize_613x_BC", 1);
+
+    step_begin();
+    initialize_bc_msg_blocks();
+    initialize_bc_instruction_list();
+    // op code words have the validation field and odd parity, the list loops to its top
+    {
+        unsigned short i, w, ones;
+        unsigned char ok = 1;
+
+        for(i = 0; i < 46; i += 2) {
+            w = sim_6131_peek(BC_ILIST_BASE_ADDR + i);
+            for(ones = 0; w; w >>= 1) ones += w & 1;
+            if(((sim_6131_peek(BC_ILIST_BASE_ADDR + i) & VP0) != VP0) || !(ones & 1)) ok = 0;
+        }
+        ok = ok && (sim_6131_peek(BC_ILIST_BASE_ADDR + 45) == BC_ILIST_BASE_ADDR);
+        step_end("initialize_bc_msg_blocks/ilist", ok);
+    }
+#endif
+
+#if (RT1_ena)
+    step_begin();
+    initialize_613x_RT1();
+    // test data fill leaves interrupts to the init code: none are re-enabled
+    host_irq_after = 1000000;
+    {
+        unsigned char ok = (write_dummy_tx_data_RT1() == 'P') && (host_irq_after == 1000000)
+                && (sim_6131_peek(0x1E00 + 8191) == 8191) && (sim_6131_peek(0x1A58 + 2) == 0xDEAD);
+
+        host_irq_after = 0;
+        step_end("initialize_613x_RT1", ok);
+    }
+#endif
+
+#if (RT2_ena)
+    step_begin();
+    initialize_613x_RT2();
+#if (RT1_ena)
+    // RT2 setup keeps the RT1 interrupt enables read back through a MAP
+    step_end("initialize_613x_RT2",
+             ((sim_6131_peek(RT_INT_ENABLE_REG) & ((RT1_IWA) | (RT2_IWA))) == ((RT1_IWA) | (RT2_IWA))) &&
+             ((sim_6131_peek(HDW_INT_OUTPUT_ENABLE_REG) & ((RT1APF) | (RT2APF))) == ((RT1APF) | (RT2APF))));
+#else
+    step_end("initialize_613x_RT2", 1);
+#endif
+#endif
+
+#if (SMT_ena || IMT_ena)
+    step_begin();
+    initialize_613x_MT();
+    step_end("initialize_613x_MT", 1);
+#endif
+
+    check_verify();
+}
+
+
+//------------------------------------------------------------------------------
+//         Functions
+//------------------------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+
+    Configure_ARM_MCU_SPI();
+    sim_6131_reset();
+
+    if((argc > 1) && (strcmp(argv[1], "bench") == 0)) {
+        Bench_6131();
+        return 0;
+    }
+    if((argc > 1) && (strcmp(argv[1], "stress") == 0)) {
+        // exit status is non-zero if any word read back wrong
+        return Stress_6131((argc > 2) ? strtoul(argv[2], 0, 0) : 16) != 0;
+    }
+
+    printf("HI-6131 host model, SPI_16BIT_FRAMES = %s\n", (SPI_16BIT_FRAMES == YES) ? "YES" : "NO");
+    printf("%-30s %4s %10s %8s %8s %8s %8s %8s %12s\n", "step", "", "host us",
+           "selects", "frames8", "frames16", "rd words", "wr words", "SPI bus us");
+
+    check_primitives();
+    check_trace();
+    check_tune();
+    check_batch();
+    check_irq();
+    run_init_routines();
+    check_schedule();
+    check_dbuf();
+    check_harvest();
+    check_gpq();
+
+    printf("%d failure(s)\n", failures);
+    return failures;
+}
+
+// end of file
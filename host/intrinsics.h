@@ -0,0 +1,23 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/intrinsics.h
+ *    brief     Host build replacement for the Atmel at91lib intrinsics.h. IAR intrinsic
+ *              functions used by the project. Interrupts are modelled only as far as
+ *              needed to test preemption: host_irq_handler, if set, is called from
+ *              the host_irq_after'th __enable_interrupt( ), as a pending IRQ would be
+ *              recognized there. Functions are defined in host/at91lib_host.c.
+ */
+
+#ifndef HOST_INTRINSICS_H
+#define HOST_INTRINSICS_H
+
+extern void (*host_irq_handler)(void);
+extern unsigned long host_irq_after;
+void host_enable_interrupt(void);
+
+#define __disable_interrupt()   ((void)0)
+#define __enable_interrupt()    host_enable_interrupt()
+
+#endif // HOST_INTRINSICS_H
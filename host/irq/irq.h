@@ -0,0 +1,18 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/irq/irq.h
+ *    brief     Host build replacement for the Atmel at91lib irq/irq.h. The NVIC
+ *              is not modelled.
+ *              Functions are defined in host/at91lib_host.c.
+ */
+
+#ifndef HOST_IRQ_H
+#define HOST_IRQ_H
+
+void IRQ_ConfigureIT(unsigned int source, unsigned int priority);
+void IRQ_EnableIT(unsigned int source);
+void IRQ_DisableIT(unsigned int source);
+
+#endif // HOST_IRQ_H
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/pio/pio.h
+ *    brief     Host build replacement for the Atmel at91lib pio/pio.h. Pin
+ *              configuration reads and writes the register blocks in host/board.h.
+ *              Functions are defined in host/at91lib_host.c.
+ */
+
+#ifndef HOST_PIO_H
+#define HOST_PIO_H
+
+#include <board.h>
+
+typedef struct {
+    unsigned int mask;
+    AT91S_PIO *pio;
+    unsigned char id;
+    unsigned char type;
+    unsigned char attribute;
+} Pin;
+
+#define PIO_PERIPH_A        0
+#define PIO_PERIPH_B        1
+#define PIO_INPUT           2
+#define PIO_OUTPUT_0        3
+#define PIO_OUTPUT_1        4
+
+#define PIO_DEFAULT         (0 << 0)
+#define PIO_PULLUP          (1 << 0)
+#define PIO_DEGLITCH        (1 << 1)
+#define PIO_OPENDRAIN       (1 << 2)
+#define PIO_IT_RISE_EDGE    (1 << 4)
+#define PIO_IT_FALL_EDGE    (1 << 5)
+#define PIO_IT_LOW_LEVEL    (1 << 6)
+#define PIO_IT_HIGH_LEVEL   (1 << 7)
+#define PIO_IT_EDGE         (1 << 8)
+
+#define PIO_LISTSIZE(pPins)    (sizeof(pPins) / sizeof(Pin))
+
+unsigned char PIO_Configure(const Pin *list, unsigned int size);
+void PIO_Set(const Pin *pin);
+void PIO_Clear(const Pin *pin);
+unsigned char PIO_Get(const Pin *pin);
+
+#endif // HOST_PIO_H
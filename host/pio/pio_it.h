@@ -0,0 +1,21 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/pio/pio_it.h
+ *    brief     Host build replacement for the Atmel at91lib pio/pio_it.h. Pin interrupts
+ *              are accepted and never raised.
+ *              Functions are defined in host/at91lib_host.c.
+ */
+
+#ifndef HOST_PIO_IT_H
+#define HOST_PIO_IT_H
+
+#include <pio/pio.h>
+
+void PIO_InitializeInterrupts(unsigned int priority);
+void PIO_ConfigureIt(const Pin *pPin, void (*handler)(const Pin *));
+void PIO_EnableIt(const Pin *pPin);
+void PIO_DisableIt(const Pin *pPin);
+
+#endif // HOST_PIO_IT_H
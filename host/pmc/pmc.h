@@ -0,0 +1,16 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/pmc/pmc.h
+ *    brief     Host build replacement for the Atmel at91lib pmc/pmc.h. Peripheral
+ *              clocks are always on.
+ *              Functions are defined in host/at91lib_host.c.
+ */
+
+#ifndef HOST_PMC_H
+#define HOST_PMC_H
+
+void PMC_EnablePeripheral(unsigned int id);
+
+#endif // HOST_PMC_H
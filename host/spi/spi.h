@@ -0,0 +1,20 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/spi/spi.h
+ *    brief     Host build replacement for the Atmel at91lib spi/spi.h. SPI setup
+ *              stores the mode and chip select registers the simulator times from.
+ *              Functions are defined in host/at91lib_host.c.
+ */
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <board.h>
+
+void SPI_Configure(AT91S_SPI *spi, unsigned int id, unsigned int configuration);
+void SPI_ConfigureNPCS(AT91S_SPI *spi, unsigned int npcs, unsigned int configuration);
+void SPI_Enable(AT91S_SPI *spi);
+
+#endif // HOST_SPI_H
@@ -0,0 +1,20 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/tc/tc.h
+ *    brief     Host build replacement for the Atmel at91lib tc/tc.h. Timer compare
+ *              status reads as expired so delay loops return at once.
+ *              Functions are defined in host/at91lib_host.c.
+ */
+
+#ifndef HOST_TC_H
+#define HOST_TC_H
+
+#include <board.h>
+
+void TC_Configure(AT91S_TC *pTc, unsigned int mode);
+void TC_Start(AT91S_TC *pTc);
+void TC_Stop(AT91S_TC *pTc);
+
+#endif // HOST_TC_H
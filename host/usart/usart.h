@@ -0,0 +1,30 @@
+/* ----------------------------------------------------------------------------
+ *                            HOLT Integrated Circuits
+ * ----------------------------------------------------------------------------
+ *
+ *    file	host/usart/usart.h
+ *    brief     Host build replacement for the Atmel at91lib usart/usart.h. Console
+ *              output goes to stdout, console input reads stdin.
+ *              Functions are defined in host/at91lib_host.c.
+ */
+
+#ifndef HOST_USART_H
+#define HOST_USART_H
+
+#include <board.h>
+
+#define AT91C_US_USMODE_NORMAL  0
+#define AT91C_US_CLKS_CLOCK     0
+#define AT91C_US_CHRL_8_BITS    (3 << 6)
+#define AT91C_US_PAR_NONE       (4 << 9)
+#define AT91C_US_NBSTOP_1_BIT   0
+#define AT91C_US_CHMODE_NORMAL  0
+
+void USART_Configure(void *usart, unsigned int mode, unsigned int baudrate, unsigned int masterClock);
+void USART_SetTransmitterEnabled(void *usart, unsigned char enabled);
+void USART_SetReceiverEnabled(void *usart, unsigned char enabled);
+void USART_Write(void *usart, unsigned short data, volatile unsigned int timeOut);
+unsigned char USART_IsRxReady(void *usart);
+unsigned char USART_GetChar(void *usart);
+
+#endif // HOST_USART_H
@@ -77,6 +77,7 @@
                  
 #include "board_6131.h"
 #include "device_6131.h"
+#include "613x_irq.h"
 
 
 #if(CONSOLE_IO)
@@ -129,6 +130,7 @@ void main(void) {
     // Initialize processor for selected interface to HI-613X device,
 
     Configure_ARM_MCU_SPI();        
+    Start_6131_Trace();
 
 
     #if (CONSOLE_IO)
@@ -199,6 +201,20 @@ void main(void) {
     // comes back here only after the HI-613x READY output goes high...
     reset_613x();
 
+    #if (SPI_AUTOTUNE == YES)
+    // Fastest reliable SPI clock and delays for this board, less a safety
+    // margin. Runs before terminals start; calibration RAM is restored.
+    if(Tune_6131_SPI_Timing() != 'P') Flash_Red_LED();
+    #endif
+    #if (CONSOLE_IO)
+    {
+        unsigned char scbr, dlybs, dlybct;
+
+        Get_6131_SPI_Timing(&scbr, &dlybs, &dlybct);
+        printf("\r       SPI timing: SCBR = %u, DLYBS = %u, DLYBCT = %u \n\n\r", scbr, dlybs, dlybct);
+    }
+    #endif
+
     // If error-free auto-init occurred after master reset, next function call 
     // returns "0". if auto-initialize occurred with errors, the function call 
     // does NOT return (local error trap). If auto-initialize was not enabled,
@@ -225,6 +241,9 @@ void main(void) {
 
         // modify runbits to just contain "start execution" bits, to be written last
         runbits &= ~(BCENA|RT1ENA|RT2ENA);
+
+        // RAM tables written from here on are recorded for the read-back check
+        Reset_6131_Verify();
             
         // Select common configuration options that apply to all BC, MT, RT1, RT2. 
         initialize_613x_shared();
@@ -246,7 +265,11 @@ void main(void) {
 
 	    initialize_613x_BC();
             initialize_bc_msg_blocks();
-	    initialize_bc_instruction_list();
+            #if (BC_RATE_SCHEDULE == YES)
+                if(initialize_bc_schedule() != 'P') Flash_Red_LED();
+            #else
+	        initialize_bc_instruction_list();
+            #endif
 
             // select BC time tag resolution, either 16-bit or 32-bit (BTTAG16 or BTTAG32)
             
@@ -275,7 +298,7 @@ void main(void) {
                 initialize_613x_RT1();				
                 
 	        // write test data to assigned transmit buffers
-	        write_dummy_tx_data_RT1();
+	        if(write_dummy_tx_data_RT1() != 'P') Flash_Red_LED();
                 
 	        // RT1 and RT2 always use 16-bit time tag resolution.
                 // if not already selected above for BC, (i.e. if BC is not used), 
@@ -299,7 +322,7 @@ void main(void) {
                 initialize_613x_RT2();				
 
 	        // write test data to assigned transmit buffers
-	        write_dummy_tx_data_RT2();
+	        if(write_dummy_tx_data_RT2() != 'P') Flash_Red_LED();
 				
 	        // RT1 and RT2 always use 16-bit time tag resolution.
 	        // if not already selected above for BC or RT1, (i.e. if BC & RT1 not used), 
@@ -342,8 +365,8 @@ void main(void) {
                 #endif
 
                 // read-modify-write the MT Configuration Register
-                j |= Read_6131LowReg(MT_CONFIG_REG, 1);
-                Write_6131LowReg(MT_CONFIG_REG, j , 1);              
+                j |= READ_6131_REG(MT_CONFIG_REG, 1);
+                WRITE_6131_REG(MT_CONFIG_REG, j, 1);              
                                         
             #endif
 						
@@ -354,6 +377,21 @@ void main(void) {
         // write the Time Tag Configuration Register
         Write_6131LowReg(TTAG_CONFIG_REG, ttconfig, 0);
 
+        #if (RAM_VERIFY == YES)
+        // read back every RAM table written above, compare with the CRCs 
+        // recorded when it was written
+        {
+            unsigned short bad;
+
+            if(Verify_6131_Images(&bad) != 'P') {
+                Flash_Red_LED();
+                #if (CONSOLE_IO)
+                printf("\r       RAM table verify failed at 0x%04X \n\n\r", bad);
+                #endif
+            }
+        }
+        #endif
+
 	if (PIO_Get(&pinCOPYREQ)) {
             // "COPY REQUEST" DIP switch is high. Write serial EEPROM using parameter 0 
 	    // so the various start bits in the Master Configuraton Register are 
@@ -371,6 +409,13 @@ void main(void) {
     AT91C_BASE_PIOC->PIO_CODR = nLEDA|nLEDB;  // LEDs ON
     Delay_x100ms(3);
     AT91C_BASE_PIOC->PIO_SODR = nLEDA|nLEDB;  // LEDs OFF
+
+    #if (IRQ_HANDLING == YES)
+        // HI-6131 interrupt enables are initialized, service nIRQ from here on
+        Configure_6131_IRQ();
+        // per-message or batch servicing, chosen by bus load
+        Configure_6131_Coalescing(IRQ_COALESCE_AUTO, IRQ_COALESCE_TICK_US);
+    #endif
         
     // we disabled interrupts during initialization, 
     // now enable them before starting terminal execution
@@ -381,7 +426,7 @@ void main(void) {
     // do not overwrite previously initialized common features     
 	spi_busy = 0;
 	spi_irq = 0;
-	j = runbits | Read_6131LowReg(MASTER_CONFIG_REG, 1);
+	j = runbits | Read_6131_MasterConfig(1);
 	Write_6131LowReg(MASTER_CONFIG_REG, j, 1);      
         
       #if (CONSOLE_IO)
@@ -390,6 +435,11 @@ void main(void) {
           while (1) {
               // poll USART1 to detect and act on console key input at computer keyboard...
               chk_key_input();
+
+              #if (IRQ_HANDLING == YES)
+                  // interrupt bottom half: queued events, deferred service
+                  Poll_6131_IRQ();
+              #endif
               
               #if(RT1_ena||RT2_ena)
                   // if MCU board SW1 button is pressed, update RT1 and RT2 status bits
@@ -406,6 +456,11 @@ void main(void) {
               #if(BC_ena)
                   bc_switch_tests();
               #endif // BC_ena
+
+              #if (IRQ_HANDLING == YES)
+                  // interrupt bottom half: queued events, deferred service
+                  Poll_6131_IRQ();
+              #endif
                   
               #if(RT1_ena||RT2_ena)
                   // if MCU board SW1 button is pressed, update RT1 and RT2 status bits